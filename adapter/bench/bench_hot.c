@@ -0,0 +1,556 @@
+/*
+ * RosettaPad - Hot Path Microbenchmarks
+ * ======================================
+ *
+ * Times the functions every input or output report goes through:
+ *
+ *   dualsense_process_input   nominal and factory motion calibration
+ *   dualsense_parse_dpad
+ *   ds3_build_input_report    generic and DualSense fast path
+ *   motion_interval           one 40ms Bluetooth report interval of motion
+ *                             history (10 pushes at 250Hz), then the
+ *                             aligned point sample or the interval mean
+ *   ds3_parse_output_report
+ *   dualsense_calc_crc32      one Bluetooth output report
+ *   crc32/<impl>              the same, per CRC32 implementation
+ *   controller_state_update   while reader threads copy the state
+ *   controller_state_copy     while other readers and a 1kHz writer run
+ *
+ * Each case is warmed up, sized so one sample takes BENCH_SAMPLE_MS, then
+ * sampled BENCH_SAMPLES times. The median is reported along with the
+ * spread (median absolute deviation, % of the median); cases whose spread
+ * exceeds BENCH_UNSTABLE_PCT are flagged so a noisy run isn't mistaken for
+ * a regression. Cycles come from the CPU cycle counter (perf_event_open)
+ * when the kernel allows it, and are reported as unavailable otherwise.
+ *
+ * --json=FILE writes the results for tracking across commits ("-" for
+ * stdout); `make bench-run` does this into build/bench/results.json.
+ *
+ * Build and run:
+ *   make bench
+ *   ./build/bench/bench_hot [--json=FILE] [--samples=N] [filter]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <linux/perf_event.h>
+
+#include "core/common.h"
+#include "core/crc32.h"
+#include "core/motion.h"
+#include "controllers/dualsense/dualsense.h"
+#include "console/ps3/ds3_emulation.h"
+
+#define BENCH_SAMPLES       21      /* Default sample count (odd: exact median) */
+#define BENCH_MAX_SAMPLES   101
+#define BENCH_WARMUP_MS     50
+#define BENCH_SAMPLE_MS     10
+#define BENCH_UNSTABLE_PCT  5.0
+
+#define NUM_FRAMES          64      /* Distinct inputs cycled through (power of 2) */
+#define MAX_READERS         3
+
+/* ============================================================================
+ * CYCLE COUNTER
+ * ============================================================================ */
+
+static int g_cycles_fd = -1;
+
+static void cycles_init(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    
+    g_cycles_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t cycles_read(void) {
+    uint64_t v = 0;
+    if (g_cycles_fd >= 0 && read(g_cycles_fd, &v, sizeof(v)) != sizeof(v)) v = 0;
+    return v;
+}
+
+/* ============================================================================
+ * CASES
+ * ============================================================================ */
+
+typedef struct {
+    const char* name;
+    void (*run)(uint64_t iterations);
+    void (*setup)(void);        /* Optional, before warmup */
+    void (*teardown)(void);     /* Optional */
+    int (*supported)(void);     /* Optional, skip the case if 0 */
+} bench_case_t;
+
+typedef struct {
+    double ns_per_op;           /* Median */
+    double ns_min;
+    double spread_pct;          /* MAD / median */
+    double cycles_per_op;       /* Median, < 0 if unavailable */
+    uint64_t iterations;        /* Per sample */
+} bench_result_t;
+
+static uint8_t g_ds_reports[NUM_FRAMES][DS_BT_INPUT_SIZE];
+static controller_state_t g_states[NUM_FRAMES];
+static uint8_t g_out_report[DS_BT_OUTPUT_SIZE];
+static volatile uint32_t g_sink;
+
+static uint32_t g_rng = 0x2545F491;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static void make_inputs(void) {
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        uint8_t* r = g_ds_reports[i];
+        for (int k = 0; k < DS_BT_INPUT_SIZE; k++) r[k] = rng_next();
+        r[DS_OFF_REPORT_ID] = DS_BT_REPORT_ID;
+        r[DS_OFF_BUTTONS1] = (r[DS_OFF_BUTTONS1] & 0xF0) | (rng_next() % 9);
+        r[DS_OFF_BUTTONS3] &= 0x07;
+        r[DS_OFF_BATTERY] = (rng_next() % 3) << 4 | (rng_next() % 11);
+        
+        /* Finger on the touchpad in a quarter of the frames */
+        r[DS_OFF_TOUCHPAD] = (i & 3) ? DS_TOUCH_INACTIVE : 0x01;
+        r[DS_OFF_TOUCHPAD + 4] = DS_TOUCH_INACTIVE;
+        
+        /* Valid CRC, or process_input drops the report */
+        static const uint8_t header = DS_BT_INPUT_CRC_HEADER;
+        uint32_t crc = crc32_extend(crc32_compute(&header, 1), r, DS_BT_INPUT_SIZE - DS_BT_CRC_SIZE);
+        for (int k = 0; k < DS_BT_CRC_SIZE; k++) {
+            r[DS_BT_INPUT_SIZE - DS_BT_CRC_SIZE + k] = crc >> (8 * k);
+        }
+    }
+    
+    const controller_driver_t* ds = dualsense_get_driver();
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        ds->process_input(g_ds_reports[i], DS_BT_INPUT_SIZE, &g_states[i]);
+    }
+    
+    for (int k = 0; k < DS_BT_OUTPUT_SIZE; k++) g_out_report[k] = rng_next();
+}
+
+/* --- dualsense_process_input --- */
+
+static void run_process_input(uint64_t n) {
+    const controller_driver_t* ds = dualsense_get_driver();
+    controller_state_t state;
+    for (uint64_t i = 0; i < n; i++) {
+        ds->process_input(g_ds_reports[i & (NUM_FRAMES - 1)], DS_BT_INPUT_SIZE, &state);
+        g_sink += state.gyro_x;
+    }
+}
+
+static void setup_calibrated(void) {
+    ds_calibration_t calib;
+    memset(&calib, 0, sizeof(calib));
+    
+    /* Typical factory values */
+    for (int i = 0; i < 3; i++) {
+        calib.gyro[i].bias = 3 - i;
+        calib.gyro[i].sens_numer = 2 * 540 * DS_GYRO_RES_PER_DEG_S;
+        calib.gyro[i].sens_denom = 17650 + i * 20;
+        calib.accel[i].bias = -40 + i * 30;
+        calib.accel[i].sens_numer = 2 * DS_ACC_RES_PER_G;
+        calib.accel[i].sens_denom = 16300 + i * 40;
+    }
+    calib.valid = 1;
+    dualsense_set_calibration(&calib);
+}
+
+static void teardown_calibrated(void) {
+    dualsense_set_calibration(NULL);
+}
+
+/* --- dualsense_parse_dpad --- */
+
+static void run_parse_dpad(uint64_t n) {
+    controller_state_t state = {0};
+    for (uint64_t i = 0; i < n; i++) {
+        dualsense_parse_dpad(g_ds_reports[i & (NUM_FRAMES - 1)][DS_OFF_BUTTONS1], &state);
+        g_sink += state.buttons;
+    }
+}
+
+/* --- ds3_build_input_report --- */
+
+static void build_reports(uint64_t n) {
+    uint8_t report[DS3_INPUT_REPORT_SIZE];
+    for (uint64_t i = 0; i < n; i++) {
+        ds3_build_input_report(&g_states[i & (NUM_FRAMES - 1)], report);
+        g_sink += report[DS3_OFF_BUTTONS1];
+    }
+}
+
+static void set_native_format(uint8_t format) {
+    for (int i = 0; i < NUM_FRAMES; i++) g_states[i].native_format = format;
+}
+
+static void setup_build_generic(void) { set_native_format(CONTROLLER_NATIVE_NONE); }
+static void setup_build_fast(void) { set_native_format(CONTROLLER_NATIVE_DUALSENSE); }
+
+/* --- motion_interval: push one report interval, then sample it --- */
+
+#define MOTION_BENCH_PUSHES     10
+#define MOTION_BENCH_PERIOD_NS  4000000ULL
+
+static motion_decimator_t g_bench_decimator;
+static uint64_t g_bench_motion_time;   /* Sensor time keeps moving forward across runs */
+
+static void setup_motion(void) {
+    motion_reset();
+    motion_decimator_reset(&g_bench_decimator);
+    g_bench_motion_time = 0;
+}
+
+static void run_motion(uint64_t n, int decimate) {
+    controller_state_t state;
+    uint64_t t = g_bench_motion_time;
+    
+    for (uint64_t i = 0; i < n; i++) {
+        for (int k = 0; k < MOTION_BENCH_PUSHES; k++) {
+            state = g_states[(i + k) & (NUM_FRAMES - 1)];
+            state.sample_time_ns = t += MOTION_BENCH_PERIOD_NS;
+            motion_push(&state);
+        }
+        /* The senders sample MOTION_ALIGN_DELAY_US behind "now" */
+        uint64_t now = t + TIME_US(MOTION_ALIGN_DELAY_US);
+        if (decimate) {
+            motion_decimate_state(&g_bench_decimator, &state, now);
+        } else {
+            motion_align_state(&state, now);
+        }
+        g_sink += state.gyro_z;
+    }
+    g_bench_motion_time = t;
+}
+
+static void run_motion_aligned(uint64_t n) { run_motion(n, 0); }
+static void run_motion_decimated(uint64_t n) { run_motion(n, 1); }
+
+/* --- ds3_parse_output_report --- */
+
+static void run_parse_output(uint64_t n) {
+    /* Steady state: the PS3 repeats the same rumble/LED report */
+    static const uint8_t report[] = {
+        0x01, 0x00, 0x96, 0x01, 0x96, 0x80, 0x00, 0x00, 0x00, 0x00,
+        0x02, 0xFF, 0x27, 0x10, 0x00, 0x32,
+    };
+    for (uint64_t i = 0; i < n; i++) {
+        ds3_parse_output_report(report, sizeof(report));
+    }
+}
+
+/* --- dualsense_calc_crc32 --- */
+
+static void run_crc32(uint64_t n) {
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        g_out_report[0] = (uint8_t)i;
+        acc += dualsense_calc_crc32(g_out_report, DS_BT_OUTPUT_SIZE - 4);
+    }
+    g_sink += acc;
+}
+
+/* --- crc32 per implementation --- */
+
+static crc32_impl_t g_crc32_default;
+
+static void select_crc32(crc32_impl_t impl) {
+    g_crc32_default = crc32_select(CRC32_IMPL_ARMV8) == 0 ? CRC32_IMPL_ARMV8 : CRC32_IMPL_SLICE8;
+    crc32_select(impl);
+}
+
+static void setup_crc32_table(void) { select_crc32(CRC32_IMPL_TABLE); }
+static void setup_crc32_slice8(void) { select_crc32(CRC32_IMPL_SLICE8); }
+static void setup_crc32_armv8(void) { select_crc32(CRC32_IMPL_ARMV8); }
+static void teardown_crc32(void) { crc32_select(g_crc32_default); }
+
+static int armv8_supported(void) {
+    select_crc32(CRC32_IMPL_ARMV8);
+    int ok = strcmp(crc32_impl_name(), "armv8") == 0;
+    teardown_crc32();
+    return ok;
+}
+
+/* --- controller_state_update / copy under contention --- */
+
+static volatile int g_contention_running;
+static pthread_t g_contention_threads[MAX_READERS + 1];
+static int g_contention_count;
+
+static void* reader_thread(void* arg) {
+    (void)arg;
+    controller_state_t state;
+    while (g_contention_running) {
+        controller_state_copy(&state);
+        g_sink += state.buttons;
+    }
+    return NULL;
+}
+
+static void* writer_thread(void* arg) {
+    (void)arg;
+    uint64_t i = 0;
+    while (g_contention_running) {
+        controller_state_update(&g_states[i++ & (NUM_FRAMES - 1)]);
+        struct timespec ts = { 0, 1000000 };
+        nanosleep(&ts, NULL);
+    }
+    return NULL;
+}
+
+static int contention_readers(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int readers = cpus > 1 ? (int)cpus - 1 : 1;
+    return readers > MAX_READERS ? MAX_READERS : readers;
+}
+
+static void contention_start(int readers, int writer) {
+    g_contention_running = 1;
+    g_contention_count = 0;
+    for (int i = 0; i < readers; i++) {
+        pthread_create(&g_contention_threads[g_contention_count++], NULL, reader_thread, NULL);
+    }
+    if (writer) {
+        pthread_create(&g_contention_threads[g_contention_count++], NULL, writer_thread, NULL);
+    }
+}
+
+static void contention_stop(void) {
+    g_contention_running = 0;
+    for (int i = 0; i < g_contention_count; i++) {
+        pthread_join(g_contention_threads[i], NULL);
+    }
+    g_contention_count = 0;
+}
+
+static void setup_update_contended(void) { contention_start(contention_readers(), 0); }
+static void setup_copy_contended(void) { contention_start(contention_readers() - 1, 1); }
+
+static void run_state_update(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        controller_state_update(&g_states[i & (NUM_FRAMES - 1)]);
+    }
+}
+
+static void run_state_copy(uint64_t n) {
+    controller_state_t state;
+    for (uint64_t i = 0; i < n; i++) {
+        controller_state_copy(&state);
+        g_sink += state.buttons;
+    }
+}
+
+static const bench_case_t g_cases[] = {
+    { "dualsense_process_input/nominal",    run_process_input, NULL, NULL, NULL },
+    { "dualsense_process_input/calibrated", run_process_input, setup_calibrated, teardown_calibrated, NULL },
+    { "dualsense_parse_dpad",               run_parse_dpad, NULL, NULL, NULL },
+    { "ds3_build_input_report/generic",     build_reports, setup_build_generic, NULL, NULL },
+    { "ds3_build_input_report/dualsense",   build_reports, setup_build_fast, NULL, NULL },
+    { "motion_interval/aligned",            run_motion_aligned, setup_motion, NULL, NULL },
+    { "motion_interval/decimated",          run_motion_decimated, setup_motion, NULL, NULL },
+    { "ds3_parse_output_report",            run_parse_output, NULL, NULL, NULL },
+    { "dualsense_calc_crc32/74B",           run_crc32, NULL, NULL, NULL },
+    { "crc32/table",                        run_crc32, setup_crc32_table, teardown_crc32, NULL },
+    { "crc32/slice8",                       run_crc32, setup_crc32_slice8, teardown_crc32, NULL },
+    { "crc32/armv8",                        run_crc32, setup_crc32_armv8, teardown_crc32, armv8_supported },
+    { "controller_state_update/contended",  run_state_update, setup_update_contended, contention_stop, NULL },
+    { "controller_state_copy/contended",    run_state_copy, setup_copy_contended, contention_stop, NULL },
+};
+
+#define NUM_CASES (int)(sizeof(g_cases) / sizeof(g_cases[0]))
+
+/* ============================================================================
+ * HARNESS
+ * ============================================================================ */
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double* v, int n) {
+    qsort(v, n, sizeof(double), cmp_double);
+    return v[n / 2];
+}
+
+static void bench_run(const bench_case_t* c, int samples, bench_result_t* out) {
+    double ns[BENCH_MAX_SAMPLES], cyc[BENCH_MAX_SAMPLES], dev[BENCH_MAX_SAMPLES];
+    
+    if (c->setup) c->setup();
+    
+    /* Warm up caches, branch predictors and the CPU clock; size the sample */
+    uint64_t n = 1, start = time_now_ns(), elapsed;
+    while ((elapsed = time_now_ns() - start) < TIME_MS(BENCH_WARMUP_MS) || n < 16) {
+        uint64_t t0 = time_now_ns();
+        c->run(n);
+        uint64_t dt = time_now_ns() - t0;
+        if (dt < TIME_MS(BENCH_SAMPLE_MS)) n *= 2;
+    }
+    uint64_t t0 = time_now_ns();
+    c->run(n);
+    double per_op = (double)(time_now_ns() - t0) / n;
+    uint64_t iterations = (uint64_t)(TIME_MS(BENCH_SAMPLE_MS) / (per_op > 0.1 ? per_op : 0.1));
+    if (iterations < 1) iterations = 1;
+    
+    for (int s = 0; s < samples; s++) {
+        uint64_t c0 = cycles_read();
+        uint64_t t_start = time_now_ns();
+        c->run(iterations);
+        uint64_t t_end = time_now_ns();
+        uint64_t c1 = cycles_read();
+        
+        ns[s] = (double)(t_end - t_start) / iterations;
+        cyc[s] = (double)(c1 - c0) / iterations;
+    }
+    
+    if (c->teardown) c->teardown();
+    
+    out->iterations = iterations;
+    out->ns_min = ns[0];
+    for (int s = 1; s < samples; s++) {
+        if (ns[s] < out->ns_min) out->ns_min = ns[s];
+    }
+    out->ns_per_op = median(ns, samples);
+    for (int s = 0; s < samples; s++) {
+        dev[s] = ns[s] > out->ns_per_op ? ns[s] - out->ns_per_op : out->ns_per_op - ns[s];
+    }
+    out->spread_pct = out->ns_per_op > 0 ? 100.0 * median(dev, samples) / out->ns_per_op : 0;
+    out->cycles_per_op = g_cycles_fd >= 0 ? median(cyc, samples) : -1;
+}
+
+/* ============================================================================
+ * OUTPUT
+ * ============================================================================ */
+
+static void write_json(FILE* f, const bench_result_t* results, const int* ran, int samples) {
+    struct utsname u;
+    uname(&u);
+    
+    fprintf(f, "{\n");
+    fprintf(f, "  \"benchmark\": \"bench_hot\",\n");
+    fprintf(f, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(f, "  \"machine\": \"%s\",\n", u.machine);
+    fprintf(f, "  \"kernel\": \"%s\",\n", u.release);
+    fprintf(f, "  \"cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(f, "  \"samples\": %d,\n", samples);
+    fprintf(f, "  \"results\": [");
+    
+    int first = 1;
+    for (int i = 0; i < NUM_CASES; i++) {
+        if (!ran[i]) continue;
+        const bench_result_t* r = &results[i];
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"ns_min\": %.3f, "
+                "\"spread_pct\": %.2f, \"stable\": %s, \"cycles_per_op\": ",
+                first ? "" : ",", g_cases[i].name, r->ns_per_op, r->ns_min,
+                r->spread_pct, r->spread_pct <= BENCH_UNSTABLE_PCT ? "true" : "false");
+        if (r->cycles_per_op >= 0) {
+            fprintf(f, "%.1f", r->cycles_per_op);
+        } else {
+            fprintf(f, "null");
+        }
+        fprintf(f, ", \"iterations\": %llu}", (unsigned long long)r->iterations);
+        first = 0;
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [options] [filter]\n", prog);
+    printf("  --json=FILE   Also write results as JSON (- for stdout)\n");
+    printf("  --samples=N   Samples per case (default %d, max %d)\n",
+           BENCH_SAMPLES, BENCH_MAX_SAMPLES);
+    printf("  filter        Only run cases whose name contains this\n");
+}
+
+int main(int argc, char* argv[]) {
+    static const struct option long_opts[] = {
+        {"json",    required_argument, NULL, 'j'},
+        {"samples", required_argument, NULL, 's'},
+        {"help",    no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    const char* json_path = NULL;
+    const char* filter = NULL;
+    int samples = BENCH_SAMPLES, opt;
+    
+    while ((opt = getopt_long(argc, argv, "h", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'j': json_path = optarg; break;
+            case 's': samples = atoi(optarg); break;
+            case 'h': print_usage(argv[0]); return 0;
+            default:  print_usage(argv[0]); return 1;
+        }
+    }
+    if (optind < argc) filter = argv[optind];
+    if (samples < 1 || samples > BENCH_MAX_SAMPLES) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    dualsense_get_driver()->init();
+    ds3_init();
+    
+    cycles_init();
+    make_inputs();
+    
+    /* JSON on stdout replaces the table */
+    FILE* table = (json_path && strcmp(json_path, "-") == 0) ? stderr : stdout;
+    
+    fprintf(table, "Hot path microbenchmarks (%d samples x %dms, cycles %s)\n",
+            samples, BENCH_SAMPLE_MS, g_cycles_fd >= 0 ? "from perf" : "unavailable");
+    fprintf(table, "  %-38s %10s %10s %8s %10s\n", "case", "ns/op", "min", "spread", "cycles/op");
+    
+    bench_result_t results[NUM_CASES];
+    int ran[NUM_CASES] = {0};
+    
+    for (int i = 0; i < NUM_CASES; i++) {
+        if (filter && !strstr(g_cases[i].name, filter)) continue;
+        if (g_cases[i].supported && !g_cases[i].supported()) {
+            fprintf(table, "  %-38s %10s\n", g_cases[i].name, "unsupported");
+            continue;
+        }
+        
+        bench_run(&g_cases[i], samples, &results[i]);
+        ran[i] = 1;
+        
+        const bench_result_t* r = &results[i];
+        char cycles[32] = "-";
+        if (r->cycles_per_op >= 0) snprintf(cycles, sizeof(cycles), "%.1f", r->cycles_per_op);
+        fprintf(table, "  %-38s %10.2f %10.2f %7.1f%% %10s%s\n", g_cases[i].name,
+                r->ns_per_op, r->ns_min, r->spread_pct, cycles,
+                r->spread_pct > BENCH_UNSTABLE_PCT ? "  (unstable)" : "");
+    }
+    
+    if (json_path) {
+        FILE* f = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!f) {
+            perror("[Bench] json");
+            return 1;
+        }
+        write_json(f, results, ran, samples);
+        if (f != stdout) {
+            fclose(f);
+            fprintf(table, "Results written to %s\n", json_path);
+        }
+    }
+    
+    return 0;
+}
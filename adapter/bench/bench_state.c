@@ -0,0 +1,156 @@
+/*
+ * RosettaPad - Controller State Contention Benchmark
+ * ===================================================
+ *
+ * Measures what the hidraw reader pays to publish a controller_state_t
+ * while console threads are copying it as fast as they can.
+ *
+ * Compares the seqlock-backed controller_state_update()/copy() against
+ * the previous mutex-protected copy (reimplemented here as a baseline).
+ *
+ * Build and run:
+ *   make bench
+ *   ./build/bench/bench_state [updates] [max_readers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "core/common.h"
+
+/* ============================================================================
+ * MUTEX BASELINE
+ * ============================================================================ */
+
+static controller_state_t g_mutex_state;
+static pthread_mutex_t g_mutex_state_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void mutex_state_update(const controller_state_t* state) {
+    pthread_mutex_lock(&g_mutex_state_lock);
+    memcpy(&g_mutex_state, state, sizeof(controller_state_t));
+    pthread_mutex_unlock(&g_mutex_state_lock);
+}
+
+static void mutex_state_copy(controller_state_t* out_state) {
+    pthread_mutex_lock(&g_mutex_state_lock);
+    memcpy(out_state, &g_mutex_state, sizeof(controller_state_t));
+    pthread_mutex_unlock(&g_mutex_state_lock);
+}
+
+/* ============================================================================
+ * BENCHMARK HARNESS
+ * ============================================================================ */
+
+typedef struct {
+    const char* name;
+    void (*update)(const controller_state_t*);
+    void (*copy)(controller_state_t*);
+} state_impl_t;
+
+static const state_impl_t g_impls[] = {
+    { "mutex",   mutex_state_update, mutex_state_copy },
+    { "seqlock", controller_state_update, controller_state_copy },
+};
+
+static volatile int g_readers_running = 0;
+static const state_impl_t* g_current_impl = NULL;
+
+typedef struct {
+    uint64_t copies;
+    uint64_t torn;      /* Copies whose fields disagree (must stay 0) */
+} reader_result_t;
+
+static void* reader_thread(void* arg) {
+    reader_result_t* result = arg;
+    controller_state_t state;
+    
+    while (__atomic_load_n(&g_readers_running, __ATOMIC_RELAXED)) {
+        g_current_impl->copy(&state);
+        /* Writer keeps buttons and timestamp in lockstep */
+        if (state.buttons != (uint32_t)state.timestamp_ns) result->torn++;
+        result->copies++;
+    }
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void run_case(const state_impl_t* impl, int num_readers, int updates) {
+    pthread_t readers[16];
+    reader_result_t results[16];
+    uint64_t* samples = malloc(sizeof(uint64_t) * updates);
+    if (!samples) return;
+    
+    memset(results, 0, sizeof(results));
+    g_current_impl = impl;
+    g_readers_running = 1;
+    
+    for (int i = 0; i < num_readers; i++) {
+        pthread_create(&readers[i], NULL, reader_thread, &results[i]);
+    }
+    usleep(10000);  /* Let readers spin up */
+    
+    controller_state_t state;
+    memset(&state, 0, sizeof(state));
+    
+    uint64_t start = time_now_ns();
+    for (int i = 0; i < updates; i++) {
+        state.buttons = (uint32_t)i;
+        state.timestamp_ns = (uint32_t)i;
+        state.left_stick_x = (uint8_t)i;
+        
+        uint64_t t0 = time_now_ns();
+        impl->update(&state);
+        samples[i] = time_now_ns() - t0;
+    }
+    uint64_t elapsed = time_now_ns() - start;
+    
+    g_readers_running = 0;
+    uint64_t copies = 0, torn = 0;
+    for (int i = 0; i < num_readers; i++) {
+        pthread_join(readers[i], NULL);
+        copies += results[i].copies;
+        torn += results[i].torn;
+    }
+    
+    qsort(samples, updates, sizeof(uint64_t), compare_u64);
+    
+    printf("  %-8s readers=%d  update: mean=%6.1fns p50=%5lluns p99=%6lluns "
+           "p99.9=%7lluns max=%8lluns  reads=%6.2fM/s torn=%llu\n",
+           impl->name, num_readers,
+           (double)elapsed / updates,
+           (unsigned long long)samples[updates / 2],
+           (unsigned long long)samples[(uint64_t)updates * 99 / 100],
+           (unsigned long long)samples[(uint64_t)updates * 999 / 1000],
+           (unsigned long long)samples[updates - 1],
+           copies / ((double)elapsed / 1e9) / 1e6,
+           (unsigned long long)torn);
+    
+    free(samples);
+}
+
+int main(int argc, char* argv[]) {
+    int updates = (argc > 1) ? atoi(argv[1]) : 200000;
+    int max_readers = (argc > 2) ? atoi(argv[2]) : 3;
+    
+    if (updates <= 0) updates = 200000;
+    if (max_readers < 0) max_readers = 0;
+    if (max_readers > 16) max_readers = 16;
+    
+    printf("Controller state contention: %d updates, %ld CPUs online\n",
+           updates, sysconf(_SC_NPROCESSORS_ONLN));
+    
+    for (int readers = 0; readers <= max_readers; readers++) {
+        for (size_t i = 0; i < sizeof(g_impls) / sizeof(g_impls[0]); i++) {
+            run_case(&g_impls[i], readers, updates);
+        }
+    }
+    
+    return 0;
+}
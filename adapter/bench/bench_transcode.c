@@ -0,0 +1,211 @@
+/*
+ * RosettaPad - DualSense to DS3 Transcoder Benchmark
+ * ===================================================
+ *
+ * Checks that the table-driven DualSense -> DS3 fast path produces
+ * exactly the same report as the generic path for every button byte
+ * combination, then times both.
+ *
+ * The button decode is also timed against the previous branchy
+ * DualSense decoder (reimplemented here as a baseline).
+ *
+ * Build and run:
+ *   make bench
+ *   ./build/bench/bench_transcode [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/common.h"
+#include "controllers/dualsense/dualsense.h"
+#include "console/ps3/ds3_emulation.h"
+
+#define NUM_FRAMES 1024     /* Distinct pseudo-random frames to cycle through */
+
+/* ============================================================================
+ * BRANCHY BASELINE
+ * ============================================================================ */
+
+static uint32_t branchy_map_buttons(const uint8_t* b) {
+    controller_state_t s;
+    s.buttons = 0;
+    
+    switch (b[0] & 0x0F) {
+        case 0: CONTROLLER_BTN_SET(&s, BTN_DPAD_UP); break;
+        case 1: CONTROLLER_BTN_SET(&s, BTN_DPAD_UP); CONTROLLER_BTN_SET(&s, BTN_DPAD_RIGHT); break;
+        case 2: CONTROLLER_BTN_SET(&s, BTN_DPAD_RIGHT); break;
+        case 3: CONTROLLER_BTN_SET(&s, BTN_DPAD_DOWN); CONTROLLER_BTN_SET(&s, BTN_DPAD_RIGHT); break;
+        case 4: CONTROLLER_BTN_SET(&s, BTN_DPAD_DOWN); break;
+        case 5: CONTROLLER_BTN_SET(&s, BTN_DPAD_DOWN); CONTROLLER_BTN_SET(&s, BTN_DPAD_LEFT); break;
+        case 6: CONTROLLER_BTN_SET(&s, BTN_DPAD_LEFT); break;
+        case 7: CONTROLLER_BTN_SET(&s, BTN_DPAD_UP); CONTROLLER_BTN_SET(&s, BTN_DPAD_LEFT); break;
+    }
+    
+    if (b[0] & DS_BTN1_CROSS)    CONTROLLER_BTN_SET(&s, BTN_SOUTH);
+    if (b[0] & DS_BTN1_CIRCLE)   CONTROLLER_BTN_SET(&s, BTN_EAST);
+    if (b[0] & DS_BTN1_SQUARE)   CONTROLLER_BTN_SET(&s, BTN_WEST);
+    if (b[0] & DS_BTN1_TRIANGLE) CONTROLLER_BTN_SET(&s, BTN_NORTH);
+    if (b[1] & DS_BTN2_L1)       CONTROLLER_BTN_SET(&s, BTN_L1);
+    if (b[1] & DS_BTN2_R1)       CONTROLLER_BTN_SET(&s, BTN_R1);
+    if (b[1] & DS_BTN2_L2)       CONTROLLER_BTN_SET(&s, BTN_L2);
+    if (b[1] & DS_BTN2_R2)       CONTROLLER_BTN_SET(&s, BTN_R2);
+    if (b[1] & DS_BTN2_L3)       CONTROLLER_BTN_SET(&s, BTN_L3);
+    if (b[1] & DS_BTN2_R3)       CONTROLLER_BTN_SET(&s, BTN_R3);
+    if (b[1] & DS_BTN2_CREATE)   CONTROLLER_BTN_SET(&s, BTN_SELECT);
+    if (b[1] & DS_BTN2_OPTIONS)  CONTROLLER_BTN_SET(&s, BTN_START);
+    if (b[2] & DS_BTN3_PS)       CONTROLLER_BTN_SET(&s, BTN_HOME);
+    if (b[2] & DS_BTN3_TOUCHPAD) CONTROLLER_BTN_SET(&s, BTN_TOUCHPAD);
+    if (b[2] & DS_BTN3_MUTE)     CONTROLLER_BTN_SET(&s, BTN_MUTE);
+    
+    return s.buttons;
+}
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+static uint32_t g_rng = 0x12345678;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static void random_state(controller_state_t* s, const uint8_t* native) {
+    memset(s, 0, sizeof(*s));
+    s->native_format = CONTROLLER_NATIVE_DUALSENSE;
+    memcpy(s->native_buttons, native, 3);
+    s->buttons = dualsense_map_buttons(native);
+    
+    uint32_t r = rng_next();
+    s->left_stick_x = r;
+    s->left_stick_y = r >> 8;
+    s->right_stick_x = r >> 16;
+    s->right_stick_y = r >> 24;
+    r = rng_next();
+    s->left_trigger = r;
+    s->right_trigger = r >> 8;
+    s->battery_level = (r >> 16) % 101;
+    s->battery_charging = (r >> 24) & 1;
+    s->battery_full = ((r >> 25) & 3) == 0;
+    s->accel_x = rng_next();
+    s->accel_y = rng_next();
+    s->accel_z = rng_next();
+    s->gyro_z = rng_next();
+}
+
+/* ============================================================================
+ * CHECK
+ * ============================================================================ */
+
+static uint64_t check_case(const uint8_t* native) {
+    controller_state_t state, generic;
+    uint8_t fast_report[DS3_INPUT_REPORT_SIZE];
+    uint8_t generic_report[DS3_INPUT_REPORT_SIZE];
+    
+    random_state(&state, native);
+    generic = state;
+    generic.native_format = CONTROLLER_NATIVE_NONE;
+    
+    ds3_build_input_report(&state, fast_report);
+    ds3_build_input_report(&generic, generic_report);
+    
+    uint64_t bad = 0;
+    if (memcmp(fast_report, generic_report, DS3_INPUT_REPORT_SIZE) != 0) bad++;
+    if (branchy_map_buttons(native) != state.buttons) bad++;
+    return bad;
+}
+
+static int check_all(void) {
+    uint64_t cases = 0, mismatches = 0;
+    uint8_t native[3];
+    
+    /* Every buttons1 x buttons2 x meaningful buttons3 bit */
+    for (int b1 = 0; b1 < 256; b1++) {
+        for (int b2 = 0; b2 < 256; b2++) {
+            for (int b3 = 0; b3 < 8; b3++) {
+                native[0] = b1; native[1] = b2; native[2] = b3;
+                mismatches += check_case(native);
+                cases++;
+            }
+        }
+    }
+    
+    /* Unused buttons3 bits must be ignored */
+    for (int b3 = 0; b3 < 256; b3++) {
+        native[0] = rng_next(); native[1] = rng_next(); native[2] = b3;
+        mismatches += check_case(native);
+        cases++;
+    }
+    
+    printf("  bit-identity: %llu cases, %llu mismatches\n",
+           (unsigned long long)cases, (unsigned long long)mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/* ============================================================================
+ * TIMING
+ * ============================================================================ */
+
+static controller_state_t g_frames[NUM_FRAMES];
+static volatile uint32_t g_sink;
+
+static double time_build(int native_format, int iterations) {
+    uint8_t report[DS3_INPUT_REPORT_SIZE];
+    
+    for (int i = 0; i < NUM_FRAMES; i++) g_frames[i].native_format = native_format;
+    
+    uint64_t start = time_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        ds3_build_input_report(&g_frames[i & (NUM_FRAMES - 1)], report);
+        g_sink += report[DS3_OFF_BUTTONS1];
+    }
+    return (double)(time_now_ns() - start) / iterations;
+}
+
+static double time_decode(uint32_t (*map)(const uint8_t*), int iterations) {
+    uint32_t acc = 0;
+    
+    uint64_t start = time_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        acc += map(g_frames[i & (NUM_FRAMES - 1)].native_buttons);
+    }
+    g_sink += acc;
+    return (double)(time_now_ns() - start) / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000000;
+    if (iterations <= 0) iterations = 2000000;
+    
+    ds3_init();
+    
+    printf("DualSense -> DS3 transcode\n");
+    if (check_all() < 0) {
+        printf("FAIL: fast path differs from generic path\n");
+        return 1;
+    }
+    
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        uint8_t native[3] = {rng_next(), rng_next(), rng_next()};
+        random_state(&g_frames[i], native);
+    }
+    
+    double decode_branchy = time_decode(branchy_map_buttons, iterations);
+    double decode_table = time_decode(dualsense_map_buttons, iterations);
+    double build_generic = time_build(CONTROLLER_NATIVE_NONE, iterations);
+    double build_fast = time_build(CONTROLLER_NATIVE_DUALSENSE, iterations);
+    
+    printf("  decode  branchy=%6.1fns  table=%6.1fns  (%.2fx)\n",
+           decode_branchy, decode_table, decode_branchy / decode_table);
+    printf("  build   generic=%6.1fns  fused=%6.1fns  (%.2fx)\n",
+           build_generic, build_fast, build_generic / build_fast);
+    printf("  total   before=%6.1fns  after=%6.1fns  per frame\n",
+           decode_branchy + build_generic, decode_table + build_fast);
+    
+    return 0;
+}
@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <bluetooth/bluetooth.h>
 
+#include "core/reactor.h"
+
 /* ============================================================================
  * CONFIGURATION
  * ============================================================================ */
@@ -31,6 +33,9 @@
 #define DS3_BT_INPUT_REPORT_SIZE    50
 #define DS3_BT_OUTPUT_REPORT_SIZE   49
 
+/* Input report pacing over Bluetooth (PS3 polls in SNIFF mode):
+ * CONFIG_BT_INPUT_INTERVAL_MS in core/config.h, 25Hz by default */
+
 /* PS3 MAC file path */
 #define PS3_MAC_FILE    "/tmp/rosettapad/ps3_mac"
 
@@ -63,8 +68,8 @@ typedef struct {
     bdaddr_t ps3_addr;
     int ps3_addr_valid;
     
-    uint64_t connect_time;
-    uint64_t last_send_time;
+    uint64_t connect_time;      /* Monotonic ns */
+    uint64_t last_send_time;    /* Monotonic ns */
     
     uint32_t packets_sent;
     uint32_t packets_dropped;
@@ -83,13 +88,6 @@ extern ps3_bt_ctx_t g_ps3_bt_ctx;
  */
 int ps3_bt_init(void);
 
-/**
- * Scan for PS3 console.
- * @param timeout_sec Scan duration in seconds
- * @return 0 if PS3 found, -1 if not
- */
-int ps3_bt_scan(int timeout_sec);
-
 /**
  * Set PS3 address manually.
  * @param mac MAC address string "XX:XX:XX:XX:XX:XX"
@@ -120,13 +118,7 @@ int ps3_bt_save_addr(void);
 int ps3_bt_load_addr(void);
 
 /**
- * Connect to PS3 via Bluetooth.
- * @return 0 on success, -1 on failure
- */
-int ps3_bt_connect(void);
-
-/**
- * Disconnect from PS3.
+ * Disconnect from PS3. Control loop (connecting is started from there too).
  */
 void ps3_bt_disconnect(void);
 
@@ -146,8 +138,9 @@ bt_state_t ps3_bt_get_state(void);
 const char* ps3_bt_state_str(bt_state_t state);
 
 /**
- * Attempt to wake PS3 from standby.
- * @return 0 on success, -1 on failure
+ * Attempt to wake PS3 from standby. Only queues the wake: connecting and
+ * the PS press run on the control loop. Any thread.
+ * @return 0 if queued, -1 if not attached to a loop yet
  */
 int ps3_bt_wake(void);
 
@@ -159,19 +152,15 @@ int ps3_bt_wake(void);
 int ps3_bt_get_local_addr(uint8_t* out_mac);
 
 /* ============================================================================
- * THREAD FUNCTIONS
+ * EVENT LOOP
  * ============================================================================ */
 
 /**
- * Bluetooth management thread.
- * Handles scanning, connection, and control channel.
- */
-void* ps3_bt_thread(void* arg);
-
-/**
- * Motion data sending thread.
- * Sends input reports when Bluetooth is enabled.
+ * Register Bluetooth connection management, input pacing and the L2CAP
+ * sockets (while connected) on an event loop.
+ * @param r Event loop (see core/reactor.h)
+ * @return 0 on success, -1 on failure
  */
-void* ps3_bt_motion_thread(void* arg);
+int ps3_bt_attach(reactor_t* r);
 
-#endif /* ROSETTAPAD_PS3_BT_HID_H */
\ No newline at end of file
+#endif /* ROSETTAPAD_PS3_BT_HID_H */
@@ -17,6 +17,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <pthread.h>
 
 #include "controllers/controller_interface.h"
 
@@ -53,6 +54,13 @@
 #define DS3_CONN_BT             0x16
 #define DS3_CONN_BT_RUMBLE      0x14
 
+/* Motion: 10-bit little-endian counts around a rest value (from captures) */
+#define DS3_MOTION_MAX              1023
+#define DS3_ACCEL_CENTER            512
+#define DS3_GYRO_CENTER             498
+#define DS3_ACCEL_COUNTS_PER_G      113
+#define DS3_GYRO_COUNTS_PER_10_DEG_S 85     /* 8.5 per deg/s */
+
 /* ============================================================================
  * DS3 BUTTON MASKS
  * ============================================================================ */
@@ -143,6 +151,27 @@ void ds3_handle_set_report(uint8_t report_id, const uint8_t* data, size_t len);
  */
 void ds3_build_input_report(const controller_state_t* state, uint8_t* out_report);
 
+/**
+ * Encode generic buttons into DS3 bytes 2-4 and pressure bytes 10-13, 20-25.
+ * Writes only those bytes.
+ * @param buttons Generic BTN_* bitmask
+ * @param out_report 49-byte report
+ */
+void ds3_encode_buttons(uint32_t buttons, uint8_t* out_report);
+
+/**
+ * Get the DS3 charge byte (byte 30) for a controller's battery state.
+ */
+uint8_t ds3_encode_battery(const controller_state_t* state);
+
+/**
+ * Encode calibrated motion into DS3 bytes 40-47.
+ */
+void ds3_encode_motion(const controller_state_t* state, uint8_t* out_report);
+
+/* Guards the cached DS3 report (shared by the hot path and ep0/BT) */
+extern pthread_mutex_t g_ds3_report_mutex;
+
 /**
  * Copy current DS3 report (thread-safe).
  * @param out_buf 49-byte output buffer
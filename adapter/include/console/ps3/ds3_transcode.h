@@ -0,0 +1,38 @@
+/*
+ * RosettaPad - DualSense to DS3 Transcoder
+ * =========================================
+ * 
+ * Fast path for the DualSense -> DS3 pair. Instead of testing each
+ * generic button bit, the DualSense button bytes (carried in
+ * controller_state_t.native_buttons) index byte-level tables that hold
+ * the finished DS3 button bytes (2-5) and pressure bytes (10-25), and
+ * the rest of the report starts from a prebuilt template.
+ * 
+ * The tables are generated at init from the generic encoders, so the
+ * output is bit-identical to ds3_build_input_report()'s generic path
+ * (bench/bench_transcode checks every button combination).
+ */
+
+#ifndef ROSETTAPAD_PS3_DS3_TRANSCODE_H
+#define ROSETTAPAD_PS3_DS3_TRANSCODE_H
+
+#include <stdint.h>
+
+#include "controllers/controller_interface.h"
+
+/**
+ * Build the lookup tables. Called from ds3_init().
+ */
+void ds3_transcode_init(void);
+
+/**
+ * Build a DS3 input report from a DualSense state.
+ * Requires state->native_format == CONTROLLER_NATIVE_DUALSENSE.
+ * 
+ * @param state Controller state with native DualSense button bytes
+ * @param out_report Output buffer (49 bytes)
+ * @return 0 on success, -1 if the tables aren't built yet
+ */
+int ds3_transcode_dualsense(const controller_state_t* state, uint8_t* out_report);
+
+#endif /* ROSETTAPAD_PS3_DS3_TRANSCODE_H */
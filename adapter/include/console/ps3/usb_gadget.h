@@ -11,6 +11,9 @@
 
 #include <stdint.h>
 
+#include "controllers/controller_interface.h"
+#include "core/reactor.h"
+
 /* ============================================================================
  * CONFIGURATION
  * ============================================================================ */
@@ -30,6 +33,14 @@
 #define EP_MAX_PACKET       64
 #define EP_INTERVAL         1       /* 1ms polling */
 
+/* Input report pacing */
+#define USB_INPUT_INTERVAL_MS   4   /* Decoupled mode: ~250Hz sampling */
+#define USB_KEEPALIVE_MS        4   /* Run-to-completion: resend if input is quiet */
+
+/* Decoupled mode, once the host poll cadence is locked (core/cadence.h),
+ * ep1 samples a lead time (CONFIG_USB_SAMPLE_LEAD_US, core/config.h)
+ * before each predicted poll instead of on the 4ms grid */
+
 /* ============================================================================
  * GLOBAL STATE
  * ============================================================================ */
@@ -85,24 +96,88 @@ int ps3_usb_open_endpoint(int endpoint_num);
 void ps3_usb_cleanup(void);
 
 /* ============================================================================
- * THREAD FUNCTIONS
+ * ENDPOINT I/O BACKEND
+ * 
+ * AIO:   ep1/ep2 transfers are submitted with Linux native AIO and
+ *        complete on the ep1 loop. One ep1 transfer is always queued and
+ *        is replaced if a newer report is built before the host polls.
+ * SYNC:  Blocking write() on ep1 and a dedicated ep2 reader thread.
+ *        Used when AIO isn't available or requested with --usb-io=sync.
  * ============================================================================ */
 
+typedef enum {
+    USB_IO_AIO = 0,
+    USB_IO_SYNC
+} usb_io_mode_t;
+
+extern usb_io_mode_t g_usb_io_mode;
+
+/**
+ * Get I/O backend name for logging.
+ */
+const char* usb_io_mode_str(usb_io_mode_t mode);
+
 /**
- * USB control endpoint (ep0) handler thread.
- * Handles SETUP packets, feature reports, etc.
+ * Set up the AIO context and completion eventfd.
+ * Call before starting the ep1 thread; on failure use USB_IO_SYNC.
+ * @return 0 on success, -1 if AIO is unavailable
+ */
+int ps3_usb_aio_init(void);
+
+/**
+ * Build a DS3 report from the given state and send it on ep1.
+ * Used by the input thread in run-to-completion mode, so the report
+ * goes out in the same wakeup that read the controller. With the AIO
+ * backend this never blocks: it replaces the queued transfer. A sync
+ * write() blocks until the host polls, so run-to-completion is only
+ * used with AIO (main.c falls back to the decoupled path).
+ * 
+ * @param state Controller state to translate
+ * @return 0 on success, -1 if USB is not enabled or the write failed
+ */
+int ps3_usb_send_input(const controller_state_t* state);
+
+/**
+ * Print the measured host poll rate, jitter and lock state for ep1.
+ */
+void ps3_usb_cadence_dump(void);
+
+/**
+ * Publish time (at or after t) that makes the next host poll just in time.
+ * Used to land replayed frames on the learned poll cadence.
+ * @param t Earliest publish time (time_now_ns() timebase)
+ * @return Publish time >= t, or 0 if the poll cadence is not locked
+ */
+uint64_t ps3_usb_publish_slot(uint64_t t);
+
+/* ============================================================================
+ * EVENT LOOP / THREAD FUNCTIONS
+ * 
+ * ep0 supports poll() and is handled on the control loop. FunctionFS
+ * data endpoints don't, so ep1 gets its own loop (AIO completions or
+ * blocking writes) and, with the sync backend, ep2 reads block in their
+ * own thread.
+ * ============================================================================ */
+
+/**
+ * Register the control endpoint (ep0) on an event loop.
+ * Handles SETUP packets, feature reports, enable/suspend events.
+ * @param r Event loop (see core/reactor.h)
+ * @return 0 on success, -1 on failure
  */
-void* ps3_usb_control_thread(void* arg);
+int ps3_usb_attach(reactor_t* r);
 
 /**
  * USB input endpoint (ep1) thread.
- * Sends DS3 input reports to PS3.
+ * Runs its own loop on a pacing timerfd.
+ * Decoupled mode: samples controller state and sends DS3 reports at ~250Hz.
+ * Run-to-completion mode: only resends when no input arrived recently.
  */
 void* ps3_usb_input_thread(void* arg);
 
 /**
- * USB output endpoint (ep2) thread.
- * Receives LED/rumble commands from PS3.
+ * USB output endpoint (ep2) thread (sync backend only).
+ * Blocks reading LED/rumble commands from PS3.
  */
 void* ps3_usb_output_thread(void* arg);
 
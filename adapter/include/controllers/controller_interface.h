@@ -32,7 +32,8 @@
  * 
  * 1. controller_info_t - Static metadata about your controller
  * 2. init() / shutdown() - Lifecycle management
- * 3. find_device() - Locate the controller (hidraw, evdev, etc.)
+ * 3. open_device() - Open a hidraw node the registry matched to your
+ *    VID/PID (or find_device() for controllers that aren't hidraw)
  * 4. poll_input() - Read and parse input, populate controller_state_t
  * 5. send_output() - Handle rumble, LEDs, etc.
  * 
@@ -63,6 +64,22 @@
 #define CONTROLLER_CAP_BATTERY      (1 << 8)   /* Battery level reporting */
 #define CONTROLLER_CAP_AUDIO        (1 << 9)   /* Built-in speaker/mic */
 
+/* Per-report timing information (controller_state_t.timing_flags) */
+#define CONTROLLER_TIMING_SENSOR_CLOCK (1 << 0) /* sensor_time_ns is valid */
+#define CONTROLLER_TIMING_SEQUENCE     (1 << 1) /* sequence is valid */
+#define CONTROLLER_TIMING_REPLAYED     (1 << 2) /* From a TAS log, not a device */
+
+/* Calibrated motion units (controller_state_t accel_* / gyro_*) */
+#define CONTROLLER_ACCEL_RES_PER_G     8192     /* +-4 g */
+#define CONTROLLER_GYRO_RES_PER_DEG_S  16       /* +-2048 deg/s */
+
+/* Interval of the optional maintain() driver hook */
+#define CONTROLLER_MAINTAIN_MS         500
+
+/* Native button byte formats (controller_state_t.native_format) */
+#define CONTROLLER_NATIVE_NONE         0
+#define CONTROLLER_NATIVE_DUALSENSE    1        /* DualSense bytes 9-11 */
+
 /* ============================================================================
  * GENERIC BUTTON DEFINITIONS
  * 
@@ -125,8 +142,9 @@ typedef struct {
     uint8_t right_trigger;
     
     /* Motion sensors (if CONTROLLER_CAP_MOTION) */
-    /* Raw sensor values - controller-specific scaling */
-    /* Console layer handles conversion to target format */
+    /* Calibrated (controllers/motion_calib.h), in CONTROLLER_ACCEL_RES_PER_G */
+    /* and CONTROLLER_GYRO_RES_PER_DEG_S units, SIXAXIS axes: lying flat, */
+    /* accel_z reads -1 g; gyro_z is yaw (turning while flat) */
     int16_t accel_x;
     int16_t accel_y;
     int16_t accel_z;
@@ -146,8 +164,25 @@ typedef struct {
     uint8_t battery_charging; /* 1 if charging, 0 if not */
     uint8_t battery_full;   /* 1 if fully charged, 0 if not */
     
-    /* Timestamp for input freshness */
-    uint64_t timestamp_ms;
+    /* Timestamp for input freshness (monotonic ns, see core/timebase.h) */
+    uint64_t timestamp_ns;
+    
+    /* Device timing (optional, see CONTROLLER_TIMING_* flags) */
+    uint8_t timing_flags;
+    uint8_t sequence;           /* Report sequence number, wraps at 256 */
+    uint64_t sensor_time_ns;    /* Device sample clock, extended to 64 bits */
+    
+    /* Raw button bytes (optional). Lets a console layer use a transcoder
+     * specialized for this controller instead of re-deriving its bytes
+     * from `buttons`. Both must describe the same buttons: anything that
+     * modifies `buttons` after the driver must reset native_format. */
+    uint8_t native_format;      /* CONTROLLER_NATIVE_* */
+    uint8_t native_buttons[3];
+    
+    /* Pipeline timestamps (monotonic ns) - set by the framework, not drivers */
+    uint64_t rx_time_ns;        /* Raw report read from the device */
+    uint64_t sample_time_ns;    /* Motion sample time on the host timebase */
+    uint64_t publish_time_ns;   /* State handed to console layers */
     
 } controller_state_t;
 
@@ -180,12 +215,19 @@ typedef struct {
  * capability reporting.
  * ============================================================================ */
 
+/* Additional VID/PID a driver handles (e.g. revisions of the same pad) */
+typedef struct {
+    uint16_t vendor_id;
+    uint16_t product_id;
+} controller_device_id_t;
+
 typedef struct {
     /* Identification */
     const char* name;           /* Human-readable name, e.g. "DualSense" */
     const char* manufacturer;   /* e.g. "Sony" */
     uint16_t vendor_id;         /* USB VID */
     uint16_t product_id;        /* USB PID */
+    const controller_device_id_t* extra_ids;   /* Optional, ends with {0, 0} */
     
     /* Capabilities bitmask */
     uint32_t capabilities;
@@ -202,6 +244,8 @@ typedef struct {
  * Function pointers that each controller driver must implement.
  * ============================================================================ */
 
+struct motion_calib;   /* controllers/motion_calib.h */
+
 typedef struct controller_driver {
     /* Static info about this controller */
     const controller_info_t* info;
@@ -221,16 +265,29 @@ typedef struct controller_driver {
     void (*shutdown)(void);
     
     /**
-     * Find and open the controller device.
-     * Scan for the controller (hidraw, evdev, etc.) and open it.
+     * Optional: Find and open a device that isn't a hidraw node.
+     * hidraw controllers implement open_device() instead; the registry
+     * enumerates hidraw once for every driver.
      * 
      * @return File descriptor on success, -1 if not found
      */
     int (*find_device)(void);
     
     /**
-     * Check if a given VID/PID matches this controller.
-     * Used by the device scanner to identify controllers.
+     * Open a hidraw device the framework already identified.
+     * The registry looks up each node's VID/PID (from sysfs, at startup or
+     * from a hotplug event) in its index of info->vendor_id/product_id and
+     * extra_ids, and hands matching nodes here.
+     * 
+     * @param devnode Device node, e.g. "/dev/hidraw3"
+     * @return File descriptor on success, -1 on failure
+     */
+    int (*open_device)(const char* devnode);
+    
+    /**
+     * Optional: Check if a given VID/PID matches this controller, for
+     * drivers whose IDs can't be listed in controller_info_t. Only asked
+     * when the VID/PID index has no entry.
      * 
      * @param vid USB Vendor ID
      * @param pid USB Product ID
@@ -251,6 +308,8 @@ typedef struct controller_driver {
     
     /**
      * Send output (rumble, LEDs) to the controller.
+     * Only the rumble write belongs here: queue anything slower (sysfs
+     * LEDs) and apply it from flush_deferred(), so it never delays rumble.
      * 
      * @param fd Device file descriptor
      * @param output Output state to apply
@@ -258,6 +317,15 @@ typedef struct controller_driver {
      */
     int (*send_output)(int fd, const controller_output_t* output);
     
+    /**
+     * Optional: Apply the output send_output() queued.
+     * Runs on the output loop from its own event, after the driver asked
+     * for it with controller_output_defer().
+     * 
+     * @param fd Device file descriptor
+     */
+    void (*flush_deferred)(int fd);
+    
     /**
      * Handle controller disconnect.
      * Clean up any state. The fd will be closed by the framework.
@@ -272,6 +340,34 @@ typedef struct controller_driver {
      */
     void (*enter_low_power)(int fd);
     
+    /**
+     * Optional: Periodic housekeeping while connected.
+     * Runs on the output loop every CONTROLLER_MAINTAIN_MS, e.g. to check
+     * that the kernel driver hasn't overridden LEDs.
+     * 
+     * @param fd Device file descriptor
+     */
+    void (*maintain)(int fd);
+    
+    /**
+     * Optional: The motion calibration behind process_input(), for tools
+     * that check its accuracy (tools/replay --motion).
+     * 
+     * @return Calibration state, or NULL
+     */
+    const struct motion_calib* (*motion_calib)(void);
+    
+    /**
+     * Optional: Load calibration data the driver recorded in a raw capture
+     * (capture_calibration), for tools that replay one (tools/replay).
+     * Applies to the process_input() calls that follow.
+     * 
+     * @param buf Calibration data, as recorded
+     * @param len Length of the data
+     * @return 0 on success, -1 if the data isn't valid for this driver
+     */
+    int (*load_calibration)(const uint8_t* buf, size_t len);
+    
 } controller_driver_t;
 
 /* ============================================================================
@@ -0,0 +1,68 @@
+/*
+ * RosettaPad - Controller Device Cache
+ * =====================================
+ *
+ * Persists what a driver learned about one physical controller (motion
+ * calibration, resolved sysfs paths, ...) so a reconnect can start from
+ * it instead of asking the controller again. Drivers use the cached data
+ * right away and revalidate it off the input path.
+ *
+ * Entries are keyed by VID/PID plus the HID "uniq" string, which the
+ * kernel fills with the controller's Bluetooth address (or USB serial).
+ * Each entry is one small file in DEVICE_CACHE_DIR:
+ *
+ *   device_cache_file_t header, then `size` bytes of driver data
+ *
+ * `format` is the driver's own layout version; a mismatch, a short file
+ * or a bad CRC is a miss. Stores replace the file atomically (rename).
+ */
+
+#ifndef ROSETTAPAD_CONTROLLERS_DEVICE_CACHE_H
+#define ROSETTAPAD_CONTROLLERS_DEVICE_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEVICE_CACHE_DIR        "/var/lib/rosettapad"
+#define DEVICE_CACHE_MAGIC      "RPDEVC\0\1"
+#define DEVICE_CACHE_UNIQ_MAX   64
+#define DEVICE_CACHE_DATA_MAX   4096
+
+typedef struct {
+    uint16_t vendor_id;
+    uint16_t product_id;
+    char uniq[DEVICE_CACHE_UNIQ_MAX];   /* "a0:b1:c2:d3:e4:f5" */
+} device_cache_key_t;
+
+typedef struct {
+    char magic[8];              /* DEVICE_CACHE_MAGIC */
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint32_t format;            /* Driver-defined layout version */
+    uint32_t size;              /* Bytes of data that follow */
+    uint32_t crc;               /* CRC-32 of the data */
+} device_cache_file_t;
+
+/**
+ * Build a cache key for an open hidraw device (HIDIOCGRAWUNIQ).
+ * @return 0 on success, -1 if the device has no unique ID (don't cache)
+ */
+int device_cache_key(int fd, uint16_t vid, uint16_t pid, device_cache_key_t* key);
+
+/**
+ * Load a cache entry.
+ * @param format Driver layout version the data must have
+ * @param data Filled on success
+ * @param size Exact size of data
+ * @return 0 on a hit, -1 on a miss
+ */
+int device_cache_load(const device_cache_key_t* key, uint32_t format, void* data, size_t size);
+
+/**
+ * Write a cache entry, replacing any previous one.
+ * Does file I/O; call it off the input path.
+ * @return 0 on success, -1 on error
+ */
+int device_cache_store(const device_cache_key_t* key, uint32_t format, const void* data, size_t size);
+
+#endif /* ROSETTAPAD_CONTROLLERS_DEVICE_CACHE_H */
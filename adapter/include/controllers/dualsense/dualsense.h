@@ -38,6 +38,9 @@
 #define DS_BT_REPORT_ID       0x31
 #define DS_BT_INPUT_SIZE      78
 #define DS_BT_OUTPUT_SIZE     78
+#define DS_BT_CRC_SIZE        4     /* le32 CRC at the end of BT reports */
+#define DS_BT_INPUT_CRC_HEADER  0xA1  /* HID DATA | INPUT, covered by the CRC */
+#define DS_BT_OUTPUT_CRC_HEADER 0xA2  /* HID DATA | OUTPUT, covered by the CRC */
 
 /* Input report byte offsets */
 #define DS_OFF_REPORT_ID      0
@@ -48,16 +51,17 @@
 #define DS_OFF_RY             5
 #define DS_OFF_L2             6
 #define DS_OFF_R2             7
-#define DS_OFF_STATUS         8
+#define DS_OFF_SEQUENCE       8    /* Report sequence number */
 #define DS_OFF_BUTTONS1       9    /* D-pad (low nibble) + face buttons */
 #define DS_OFF_BUTTONS2       10   /* Shoulders, sticks, options/create */
 #define DS_OFF_BUTTONS3       11   /* PS, touchpad, mute */
-#define DS_OFF_GYRO_X         16
-#define DS_OFF_GYRO_Y         18
-#define DS_OFF_GYRO_Z         20
-#define DS_OFF_ACCEL_X        22
-#define DS_OFF_ACCEL_Y        24
-#define DS_OFF_ACCEL_Z        26
+#define DS_OFF_GYRO_X         17   /* le16 pitch, after 4 reserved bytes */
+#define DS_OFF_GYRO_Y         19   /* yaw */
+#define DS_OFF_GYRO_Z         21   /* roll */
+#define DS_OFF_ACCEL_X        23
+#define DS_OFF_ACCEL_Y        25
+#define DS_OFF_ACCEL_Z        27
+#define DS_OFF_SENSOR_TIMESTAMP 29 /* le32, units of 1/3 us */
 #define DS_OFF_TOUCHPAD       34
 #define DS_OFF_BATTERY        54
 
@@ -87,6 +91,9 @@
 #define DS_TOUCHPAD_HEIGHT    1080
 #define DS_TOUCH_INACTIVE     0x80
 
+/* Sensor timestamp tick: 0.333us, so ns = ticks * 1000 / 3 */
+#define DS_SENSOR_TICKS_PER_US 3
+
 /* ============================================================================
  * CALIBRATION DATA
  * 
@@ -103,7 +110,12 @@
 #define DS_GYRO_RES_PER_DEG_S  1024   /* Gyroscope resolution per degree/s */
 #define DS_GYRO_RANGE          (2048 * DS_GYRO_RES_PER_DEG_S)  /* ±2048 deg/s */
 
-/* Per-axis calibration data */
+/* Nominal sensitivity, used when the calibration report is unusable */
+#define DS_ACC_RAW_PER_G       8192   /* +-4 g full scale */
+#define DS_GYRO_RAW_PER_DEG_S  16     /* ~16.4 (+-2000 deg/s full scale) */
+
+/* Per-axis factory calibration: calibrated = (raw - bias) * numer / denom,
+ * in DS_GYRO_RES_PER_DEG_S / DS_ACC_RES_PER_G units like the kernel driver */
 typedef struct {
     int16_t bias;       /* Zero offset */
     int sens_numer;     /* Sensitivity numerator */
@@ -114,7 +126,7 @@ typedef struct {
 typedef struct {
     ds_axis_calib_t gyro[3];   /* Pitch, Yaw, Roll */
     ds_axis_calib_t accel[3];  /* X, Y, Z */
-    int valid;                  /* 1 if calibration loaded successfully */
+    int valid;                  /* 0: use nominal sensitivity */
 } ds_calibration_t;
 
 /* ============================================================================
@@ -142,6 +154,32 @@ void dualsense_register(void);
  */
 uint32_t dualsense_calc_crc32(const uint8_t* data, size_t len);
 
+/**
+ * Verify the CRC of a full Bluetooth input report (0x31).
+ * @param report DS_BT_INPUT_SIZE bytes, starting with the report ID
+ * @return 1 if the CRC matches, 0 if not
+ */
+int dualsense_check_input_crc(const uint8_t* report);
+
+/**
+ * @return Input reports dropped for a bad CRC since startup
+ */
+uint64_t dualsense_get_crc_errors(void);
+
+/**
+ * Replace the motion calibration (normally read from the controller).
+ * Implausible axes fall back to nominal (controllers/motion_calib.h).
+ * @param calib Calibration to use, or NULL for nominal sensitivity
+ */
+void dualsense_set_calibration(const ds_calibration_t* calib);
+
+/**
+ * Map raw button bytes to generic BTN_* bits (table lookups).
+ * @param buttons Report bytes DS_OFF_BUTTONS1..DS_OFF_BUTTONS3
+ * @return Generic button bitmask
+ */
+uint32_t dualsense_map_buttons(const uint8_t* buttons);
+
 /**
  * Parse D-pad value from buttons1 byte.
  * @param buttons1 Raw buttons1 byte from input report
@@ -0,0 +1,56 @@
+/*
+ * RosettaPad - Controller Hotplug
+ * ================================
+ *
+ * Listens for hidraw add/remove on the kernel's uevent netlink socket, so
+ * a controller is picked up the moment its hidraw node appears instead of
+ * on the next periodic scan.
+ *
+ * hidraw uevents don't carry the VID/PID themselves; the parent HID
+ * device's HID_ID ("0005:0000054C:00000CE6") is read from sysfs, so
+ * nothing has to open the device node to find out what it is.
+ */
+
+#ifndef ROSETTAPAD_CONTROLLERS_HOTPLUG_H
+#define ROSETTAPAD_CONTROLLERS_HOTPLUG_H
+
+#include <stdint.h>
+
+#define HOTPLUG_SYSFS_HIDRAW    "/sys/class/hidraw"
+
+typedef enum {
+    HOTPLUG_ADD = 1,
+    HOTPLUG_REMOVE,
+} hotplug_action_t;
+
+typedef struct {
+    hotplug_action_t action;
+    char devname[32];           /* "hidraw3" */
+    char devnode[48];           /* "/dev/hidraw3" */
+    uint16_t bus;               /* BUS_* from linux/input.h, add only */
+    uint16_t vendor_id;         /* add only, 0 if unknown */
+    uint16_t product_id;
+    uint64_t event_time_ns;     /* When the event was read */
+} hotplug_event_t;
+
+/**
+ * Open a non-blocking uevent netlink socket.
+ * @return fd, or -1 if unavailable (callers fall back to scanning)
+ */
+int hotplug_open(void);
+
+/**
+ * Read the next hidraw event (other uevents are skipped).
+ * @return 1 with *ev filled, 0 once the socket is drained, -1 if events
+ *         were lost (socket buffer overrun) - rescan, then keep reading
+ */
+int hotplug_next(int fd, hotplug_event_t* ev);
+
+/**
+ * Read a hidraw node's IDs from sysfs without opening the device.
+ * @param devname "hidraw3"
+ * @return 0 on success, -1 if the node or its HID_ID is missing
+ */
+int hotplug_hidraw_ids(const char* devname, uint16_t* bus, uint16_t* vid, uint16_t* pid);
+
+#endif /* ROSETTAPAD_CONTROLLERS_HOTPLUG_H */
@@ -0,0 +1,84 @@
+/*
+ * RosettaPad - sysfs LED Engine
+ * ==============================
+ * 
+ * Drives LEDs exposed by a kernel driver under /sys/class/leds (e.g. the
+ * DualSense lightbar and player LEDs from hid-playstation) without the
+ * cost of reopening attribute files on every update:
+ * 
+ * - brightness (and multi_intensity for multicolor LEDs) are opened once
+ *   and written with pwrite()
+ * - Writes are skipped when the value is already what we last wrote
+ * - led_sysfs_check() reads the attributes back, so values the kernel
+ *   driver changed behind our back are detected and can be restored,
+ *   instead of rewriting everything periodically
+ * 
+ * Writing a sysfs LED takes a kernel round trip (and for Bluetooth
+ * controllers, an output report), so callers should keep this off
+ * latency-sensitive paths such as rumble.
+ */
+
+#ifndef ROSETTAPAD_LED_SYSFS_H
+#define ROSETTAPAD_LED_SYSFS_H
+
+#include <stdint.h>
+
+#define LED_SYSFS_PATH_MAX  256
+
+typedef struct {
+    int brightness_fd;
+    int intensity_fd;           /* multi_intensity, -1 for single-color LEDs */
+    uint8_t max_brightness;
+    
+    /* Last values written; only meaningful while `known` */
+    int known;
+    uint8_t brightness;
+    uint8_t rgb[3];
+    
+    /* Stats */
+    uint32_t writes;
+    uint32_t overrides;         /* Kernel changes found by led_sysfs_check() */
+    
+    char dir[LED_SYSFS_PATH_MAX];
+} led_sysfs_t;
+
+#define LED_SYSFS_INIT { .brightness_fd = -1, .intensity_fd = -1 }
+
+/**
+ * Open an LED's attributes.
+ * @param led LED to set up (LED_SYSFS_INIT or closed)
+ * @param dir LED directory, e.g. /sys/class/leds/input5:rgb:indicator
+ * @return 0 on success, -1 if the LED can't be opened
+ */
+int led_sysfs_open(led_sysfs_t* led, const char* dir);
+
+/**
+ * Close an LED's attributes. Safe on a closed LED.
+ */
+void led_sysfs_close(led_sysfs_t* led);
+
+static inline int led_sysfs_is_open(const led_sysfs_t* led) {
+    return led->brightness_fd >= 0;
+}
+
+/**
+ * Set brightness (clamped to max_brightness), writing only if it changed.
+ * @return 1 if written, 0 if unchanged, -1 on error (LED gone)
+ */
+int led_sysfs_set(led_sysfs_t* led, uint8_t brightness);
+
+/**
+ * Set a multicolor LED to full brightness with the given color, writing
+ * only what changed.
+ * @return 1 if written, 0 if unchanged, -1 on error (LED gone)
+ */
+int led_sysfs_set_rgb(led_sysfs_t* led, uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * Read the LED back and compare with what we last wrote. On a mismatch
+ * the cache is invalidated, so the next set call rewrites the LED.
+ * @return 1 if something else changed the LED, 0 if not, -1 on error
+ */
+int led_sysfs_check(led_sysfs_t* led);
+
+#endif /* ROSETTAPAD_LED_SYSFS_H */
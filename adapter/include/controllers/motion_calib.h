@@ -0,0 +1,150 @@
+/*
+ * RosettaPad - Motion Calibration Engine
+ * =======================================
+ *
+ * Turns raw accelerometer / gyroscope counts into the calibrated,
+ * console-independent motion of controller_state_t:
+ *
+ *   accel   CONTROLLER_ACCEL_RES_PER_G units per g
+ *   gyro    CONTROLLER_GYRO_RES_PER_DEG_S units per deg/s
+ *   axes    SIXAXIS frame (see controller_state_t)
+ *
+ * FIXED POINT:
+ *
+ * Factory calibration (bias, sensitivity as a fraction) is turned into a
+ * Q16 multiplier once, when it's loaded. Per sample each axis costs a
+ * subtract, a 32x32->64 multiply and a shift - no divides.
+ *
+ * SANITY CHECKS:
+ *
+ * A factory scale more than MOTION_SCALE_TOLERANCE_PCT away from the
+ * sensor's nominal one, or a bias beyond the driver's limit, is treated as
+ * garbage (e.g. a feature report that read back zeros): that axis falls
+ * back to the nominal scale and no bias.
+ *
+ * ONLINE GYRO BIAS:
+ *
+ * Gyro zero offsets drift with temperature, so the factory bias alone
+ * leaves a slow spin. While the controller lies still - every gyro and
+ * accel axis within the driver's noise band of its short average, and no
+ * axis turning faster than the drift limit - for MOTION_REST_SAMPLES in a
+ * row, the residual gyro rate is folded into a per-axis bias estimate
+ * (1/2^MOTION_BIAS_SHIFT per sample). Any movement stops the tracking.
+ *
+ * AXIS MAPPING:
+ *
+ * Drivers describe, per output axis, which raw axis feeds it and with
+ * which sign, so every controller reports in the same frame.
+ */
+
+#ifndef ROSETTAPAD_CONTROLLERS_MOTION_CALIB_H
+#define ROSETTAPAD_CONTROLLERS_MOTION_CALIB_H
+
+#include <stdint.h>
+
+#include "controllers/controller_interface.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define MOTION_CALIB_SHIFT          16      /* Scales are Q16 */
+#define MOTION_BIAS_FRAC            8       /* Online bias in 1/256 raw counts */
+#define MOTION_AVG_SHIFT            3       /* Rest detection: 1/8 per sample average */
+#define MOTION_REST_SAMPLES         256     /* ~1s still at 250Hz before tracking bias */
+#define MOTION_BIAS_SHIFT           6       /* Bias tracking speed while at rest */
+#define MOTION_SCALE_TOLERANCE_PCT  30      /* Factory scale vs nominal */
+
+typedef enum {
+    MOTION_ACCEL = 0,
+    MOTION_GYRO,
+    MOTION_SENSOR_COUNT
+} motion_sensor_t;
+
+/* Output axis <- raw axis */
+typedef struct {
+    uint8_t source;             /* Raw axis, 0-2 */
+    int8_t sign;                /* +1 or -1 */
+} motion_axis_map_t;
+
+/* What a driver knows about its sensors, for any unit it talks to */
+typedef struct {
+    int32_t nominal_scale[MOTION_SENSOR_COUNT];     /* Q16 output units per raw count */
+    int32_t max_bias[MOTION_SENSOR_COUNT];          /* Largest believable factory bias, raw */
+    motion_axis_map_t map[MOTION_SENSOR_COUNT][3];  /* By output axis X, Y, Z */
+    int32_t rest_noise[MOTION_SENSOR_COUNT];        /* Raw noise band that still counts as still */
+    int32_t max_drift;          /* Raw gyro rate the online bias may absorb */
+} motion_calib_spec_t;
+
+typedef struct {
+    int32_t bias;               /* Raw counts */
+    int32_t scale;              /* Q16 output units per raw count */
+    double exact_scale;         /* Unrounded, for motion_calib_reference() */
+} motion_axis_calib_t;
+
+/* Output axis, resolved from the map and the raw axis calibration */
+typedef struct {
+    int32_t scale;              /* Q16, sign folded in */
+    uint32_t source;            /* Raw axis, 0-2 */
+} motion_output_t;
+
+typedef struct motion_calib {
+    const motion_calib_spec_t* spec;
+    motion_axis_calib_t axis[MOTION_SENSOR_COUNT][3];   /* By raw axis */
+    motion_output_t output[MOTION_SENSOR_COUNT][3];     /* By output axis */
+    int fallback_axes;          /* Axes whose factory data was rejected */
+    
+    /* Online gyro bias, raw counts << MOTION_BIAS_FRAC */
+    int32_t gyro_bias[3];
+    
+    /* Rest detection: short averages (raw << MOTION_BIAS_FRAC, less factory bias) */
+    int32_t avg[MOTION_SENSOR_COUNT][3];
+    int primed;
+    uint32_t rest_count;
+    uint64_t rest_samples;      /* Samples that updated the bias */
+    
+    /* Last raw sample, for accuracy checks */
+    int16_t raw[MOTION_SENSOR_COUNT][3];
+} motion_calib_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Reset to nominal calibration (no factory data) and forget the online
+ * bias.
+ * @param spec Driver's sensor description; must outlive the calibration
+ */
+void motion_calib_init(motion_calib_t* c, const motion_calib_spec_t* spec);
+
+/**
+ * Load one axis of factory calibration:
+ *   output = (raw - bias) * numer / denom
+ * Rejected (nominal scale, no bias) if implausible for the spec.
+ * @param axis Raw axis, 0-2
+ * @return 0 if accepted, -1 if the axis fell back to nominal
+ */
+int motion_calib_set_axis(motion_calib_t* c, motion_sensor_t sensor, int axis,
+                          int32_t bias, int64_t numer, int64_t denom);
+
+/**
+ * Calibrate one sample into out's accel_* / gyro_* fields.
+ * Also updates the online gyro bias; one caller (thread) per calibration.
+ */
+void motion_calib_apply(motion_calib_t* c, const int16_t raw_accel[3], const int16_t raw_gyro[3],
+                        controller_state_t* out);
+
+/**
+ * Exact (double precision) result for the last sample passed to
+ * motion_calib_apply(), using the same biases. Accuracy checks only.
+ * @param out [sensor][output axis], in output units
+ */
+void motion_calib_reference(const motion_calib_t* c, double out[MOTION_SENSOR_COUNT][3]);
+
+/**
+ * @return Current online gyro bias of a raw axis, in output units
+ */
+double motion_calib_gyro_bias(const motion_calib_t* c, int axis);
+
+#endif /* ROSETTAPAD_CONTROLLERS_MOTION_CALIB_H */
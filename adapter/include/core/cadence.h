@@ -0,0 +1,86 @@
+/*
+ * RosettaPad - Host Poll Cadence Detector
+ * ========================================
+ * 
+ * Learns when the console actually polls an interrupt IN endpoint from
+ * transfer completion times. With a transfer always queued, each
+ * completion marks one host poll, so the completion stream gives both
+ * the real poll period (whatever bInterval says) and its phase.
+ * 
+ * The period is the median of recent intervals. The phase is a simple
+ * phase-locked predictor: each completion is compared with the predicted
+ * poll time and the prediction is nudged towards it. Once enough
+ * completions land close to their prediction the detector is "locked"
+ * and cadence_next_poll() can be used to schedule work just before the
+ * next poll.
+ */
+
+#ifndef ROSETTAPAD_CORE_CADENCE_H
+#define ROSETTAPAD_CORE_CADENCE_H
+
+#include <stdint.h>
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define CADENCE_HISTORY         16      /* Intervals used for the period median */
+#define CADENCE_LOCK_COUNT      8       /* In-phase completions needed to lock */
+#define CADENCE_PHASE_GAIN      4       /* Phase correction = error / GAIN */
+
+/* ============================================================================
+ * TYPES
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t polls;             /* Completions observed */
+    uint64_t missed;            /* Polls skipped between completions */
+    uint64_t relocks;           /* Phase lost and reacquired */
+    uint64_t period_ns;         /* Estimated poll period */
+    uint64_t jitter_ns;         /* Mean absolute prediction error */
+    int locked;
+} cadence_stats_t;
+
+typedef struct {
+    uint64_t intervals[CADENCE_HISTORY];
+    uint32_t interval_count;
+    uint64_t period_ns;
+    
+    uint64_t last_ns;           /* Last completion */
+    uint64_t predicted_ns;      /* Phase estimate: time of last poll */
+    uint32_t in_phase;          /* Consecutive completions near prediction */
+    
+    uint64_t abs_error_sum;
+    uint64_t error_samples;
+    
+    cadence_stats_t stats;
+} cadence_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Reset a detector.
+ * @param nominal_period_ns Period reported until enough intervals are seen
+ */
+void cadence_init(cadence_t* c, uint64_t nominal_period_ns);
+
+/**
+ * Feed one transfer completion.
+ * @param completion_ns Monotonic time the completion was seen
+ */
+void cadence_observe(cadence_t* c, uint64_t completion_ns);
+
+/**
+ * Predict the first host poll at or after a given time.
+ * @return Predicted poll time, or 0 if not locked
+ */
+uint64_t cadence_next_poll(const cadence_t* c, uint64_t after_ns);
+
+/**
+ * Snapshot statistics.
+ */
+void cadence_get_stats(const cadence_t* c, cadence_stats_t* out);
+
+#endif /* ROSETTAPAD_CORE_CADENCE_H */
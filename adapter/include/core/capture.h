@@ -0,0 +1,112 @@
+/*
+ * RosettaPad - Raw Input Capture
+ * ===============================
+ *
+ * Writes every raw hidraw report, with its receive timestamp, to a file so
+ * the input pipeline can be replayed offline (tools/replay.c) without a
+ * controller or a console.
+ *
+ * FILE FORMAT (little-endian):
+ *
+ *   capture_header_t
+ *   capture_record_t + report bytes, repeated
+ *
+ * Each record carries the VID/PID of the device it came from, so a
+ * capture spanning a controller swap replays through the right driver.
+ * Besides input reports, drivers record the calibration they load
+ * (CAPTURE_RECORD_CALIBRATION), ahead of the first report it applies to;
+ * replay hands those to the driver's load_calibration() hook.
+ *
+ * THREADING:
+ *
+ * capture_report() runs on the input thread and only copies into a
+ * pre-faulted ring. The file is written by a timer on the control loop
+ * (capture_attach), so the input path never blocks on the disk. Reports
+ * that don't fit because the drain fell behind are dropped and counted.
+ */
+
+#ifndef ROSETTAPAD_CORE_CAPTURE_H
+#define ROSETTAPAD_CORE_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "core/reactor.h"
+
+/* ============================================================================
+ * FORMAT
+ * ============================================================================ */
+
+#define CAPTURE_MAGIC           "RPCAP\0\0\1"
+#define CAPTURE_VERSION         2
+#define CAPTURE_MAX_REPORT      128         /* Largest report read from hidraw */
+#define CAPTURE_RING_SIZE       (1 << 20)   /* Power of 2 */
+#define CAPTURE_DRAIN_INTERVAL_MS 100
+
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved0;
+    uint64_t start_time_ns;     /* Monotonic time the capture was opened */
+    uint8_t reserved[8];
+} capture_header_t;
+
+/* capture_record_t.type */
+#define CAPTURE_RECORD_INPUT        0   /* Input report, as read from hidraw */
+#define CAPTURE_RECORD_CALIBRATION  1   /* Calibration data, driver-specific */
+
+typedef struct __attribute__((packed)) {
+    uint64_t rx_time_ns;        /* Monotonic receive time */
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint16_t len;               /* Report bytes that follow */
+    uint8_t type;               /* CAPTURE_RECORD_* */
+    uint8_t reserved;
+} capture_record_t;
+
+/* ============================================================================
+ * API
+ * ============================================================================ */
+
+/**
+ * Create a capture file. Call before the input thread starts.
+ * @param path Output file (truncated)
+ * @return 0 on success, -1 on error
+ */
+int capture_open(const char* path);
+
+/**
+ * Append one raw report (input thread). No-op unless a capture is open.
+ * @param buf Report as read from hidraw
+ * @param len Report length (truncated to CAPTURE_MAX_REPORT)
+ * @param rx_time_ns Receive time
+ * @param vid Vendor ID of the device it came from
+ * @param pid Product ID of the device it came from
+ */
+void capture_report(const uint8_t* buf, size_t len, uint64_t rx_time_ns,
+                    uint16_t vid, uint16_t pid);
+
+/**
+ * Append the calibration a driver just loaded (input thread), so replay
+ * loads it at the same point. No-op unless a capture is open.
+ * @param buf Calibration data, as the driver's load_calibration() takes it
+ * @param len Data length (truncated to CAPTURE_MAX_REPORT)
+ * @param time_ns Time it was loaded
+ * @param vid Vendor ID of the device it came from
+ * @param pid Product ID of the device it came from
+ */
+void capture_calibration(const uint8_t* buf, size_t len, uint64_t time_ns,
+                         uint16_t vid, uint16_t pid);
+
+/**
+ * Start the drain timer on the control loop. No-op without a capture.
+ * @return 0 on success, -1 on error
+ */
+int capture_attach(reactor_t* r);
+
+/**
+ * Flush and close the capture. Call after the input thread has exited.
+ */
+void capture_close(void);
+
+#endif /* ROSETTAPAD_CORE_CAPTURE_H */
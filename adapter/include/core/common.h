@@ -14,6 +14,9 @@
 #include <pthread.h>
 
 #include "controllers/controller_interface.h"
+#include "core/seqlock.h"
+#include "core/timebase.h"
+#include "core/reactor.h"
 
 /* ============================================================================
  * GLOBAL STATE
@@ -45,21 +48,25 @@ void system_exit_standby(void);
  * 
  * The bridge between controller drivers and console emulation.
  * Controllers write to this; console layers read from it.
+ * 
+ * The state is published through a sequence lock: the input thread never
+ * waits for readers, and readers never take a lock. The mutex only
+ * serializes writers and is never touched by readers.
  * ============================================================================ */
 
-/* Global controller state - updated by active controller driver */
-extern controller_state_t g_controller_state;
+/* Serializes writers of the global controller state (readers are lock-free) */
 extern pthread_mutex_t g_controller_state_mutex;
 
 /**
  * Update controller state (thread-safe).
  * Called by controller drivers after processing input.
+ * Never blocks on readers.
  */
 void controller_state_update(const controller_state_t* state);
 
 /**
- * Copy current controller state (thread-safe).
- * Called by console emulation layers.
+ * Copy current controller state (thread-safe, lock-free).
+ * Called by console emulation layers. Retries if it races a writer.
  */
 void controller_state_copy(controller_state_t* out_state);
 
@@ -91,37 +98,68 @@ void controller_output_copy(controller_output_t* out_output);
 int controller_output_changed(void);
 
 /* ============================================================================
- * CONTROLLER OUTPUT THREAD
+ * CONTROLLER OUTPUT FORWARDING
  * 
- * Generic output thread that reads from g_controller_output and calls
- * the active controller's send_output() function.
+ * Runs on an event loop: output changes are signalled through an eventfd
+ * and forwarded to the active controller's send_output() function.
+ * Failed sends are retried on a timer.
  * ============================================================================ */
 
 /**
- * Controller output thread function.
- * Monitors output state and forwards to active controller.
+ * Register output forwarding and the lightbar IPC watch on a loop.
+ * @param r Event loop (see core/reactor.h)
+ * @return 0 on success, -1 on failure
+ */
+int controller_output_attach(reactor_t* r);
+
+/**
+ * Run the active driver's flush_deferred() on the output loop, as its own
+ * event (so not inside the send_output() call that asked for it).
  */
-void* controller_output_thread(void* arg);
+void controller_output_defer(void);
 
 /* ============================================================================
  * LIGHTBAR IPC
  * 
- * Web interface can control lightbar via file-based IPC.
+ * Web interface can control lightbar via file-based IPC. The output loop
+ * watches the directory with inotify and re-reads the file when it is
+ * closed after writing or renamed into place, so writers should either
+ * write it in one go or write a temp file and rename it over.
  * ============================================================================ */
 
-#define LIGHTBAR_IPC_PATH "/tmp/rosettapad/lightbar_state.json"
+#define LIGHTBAR_IPC_DIR  "/tmp/rosettapad"
+#define LIGHTBAR_IPC_FILE "lightbar_state.json"
+#define LIGHTBAR_IPC_PATH LIGHTBAR_IPC_DIR "/" LIGHTBAR_IPC_FILE
 
 /**
  * Read lightbar state from IPC file.
- * Called periodically by output thread.
+ * Called from the output loop when the file changes.
  */
 void lightbar_read_ipc(controller_output_t* output);
 
+/* Touchpad-as-stick, deadzone and pacing options live in core/config.h */
+
 /* ============================================================================
- * TOUCHPAD-AS-STICK CONFIGURATION
+ * INPUT PATH CONFIGURATION
+ * 
+ * DECOUPLED:            The input thread only publishes controller state.
+ *                       Console threads sample it on their own schedule.
+ * RUN_TO_COMPLETION:    The input thread builds and sends the console report
+ *                       in the same wakeup that read the controller report.
+ *                       Console threads only resend when input goes quiet.
  * ============================================================================ */
 
-extern volatile int g_touchpad_as_right_stick;  /* 0=disabled, 1=enabled */
+typedef enum {
+    INPUT_PATH_DECOUPLED = 0,
+    INPUT_PATH_RUN_TO_COMPLETION
+} input_path_mode_t;
+
+extern volatile input_path_mode_t g_input_path_mode;
+
+/**
+ * Get input path mode name for logging.
+ */
+const char* input_path_mode_str(input_path_mode_t mode);
 
 /* ============================================================================
  * DEBUG UTILITIES
@@ -132,9 +170,4 @@ extern volatile int g_touchpad_as_right_stick;  /* 0=disabled, 1=enabled */
  */
 void debug_print_hex(const char* label, const uint8_t* data, size_t len);
 
-/**
- * Get current time in milliseconds.
- */
-uint64_t time_get_ms(void);
-
 #endif /* ROSETTAPAD_CORE_COMMON_H */
\ No newline at end of file
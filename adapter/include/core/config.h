@@ -0,0 +1,88 @@
+/*
+ * RosettaPad - Runtime Configuration
+ * ===================================
+ *
+ * Options that can change while the adapter runs (control socket, see
+ * core/control_socket.h). The whole set is one small struct behind a
+ * seqlock, so readers on the input and console paths always see a
+ * consistent set of values without taking a lock, and a batch of
+ * changes lands in one step.
+ *
+ * Options are addressed by a stable numeric ID (protocol) or by name
+ * (command line tools). Values are validated against per-option limits
+ * before anything is applied.
+ */
+
+#ifndef ROSETTAPAD_CORE_CONFIG_H
+#define ROSETTAPAD_CORE_CONFIG_H
+
+#include <stdint.h>
+
+/* ============================================================================
+ * OPTIONS
+ * ============================================================================ */
+
+typedef enum {
+    CONFIG_TOUCHPAD_STICK = 1,  /* Touchpad swipe drives the right stick (0/1) */
+    CONFIG_STICK_DEADZONE,      /* Stick deadzone around center, in counts */
+    CONFIG_TOUCHPAD_RANGE,      /* Touchpad pixels for full stick deflection */
+    CONFIG_BT_INPUT_INTERVAL_MS,/* PS3 Bluetooth input report interval */
+    CONFIG_USB_SAMPLE_LEAD_US,  /* Sample this long before the predicted USB poll */
+    CONFIG_MOTION_FILTER,       /* Bluetooth motion: 1 = mean over each interval, 0 = point sample */
+    CONFIG_OPTION_COUNT
+} config_option_t;
+
+/* Defaults */
+#define CONFIG_DEFAULT_STICK_DEADZONE       6
+#define CONFIG_DEFAULT_TOUCHPAD_RANGE       400
+#define CONFIG_DEFAULT_BT_INPUT_INTERVAL_MS 40      /* 25Hz, like a real DS3 */
+#define CONFIG_DEFAULT_USB_SAMPLE_LEAD_US   250
+
+typedef struct {
+    uint8_t touchpad_stick;
+    uint8_t stick_deadzone;
+    uint16_t touchpad_range;
+    uint16_t bt_input_interval_ms;
+    uint16_t usb_sample_lead_us;
+    uint8_t motion_filter;
+} adapter_config_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Copy the current configuration (any thread, lock-free).
+ */
+void config_get(adapter_config_t* out);
+
+/**
+ * Replace the configuration. Values must already be valid
+ * (config_set_option() on a copy checks them).
+ */
+void config_commit(const adapter_config_t* config);
+
+/**
+ * Read one option from a configuration.
+ * @return 0 on success, -1 if the option is unknown
+ */
+int config_get_option(const adapter_config_t* config, int option, int32_t* value);
+
+/**
+ * Set one option in a configuration (not the live one - commit it after).
+ * @return 0 on success, -1 if the option is unknown or the value out of range
+ */
+int config_set_option(adapter_config_t* config, int option, int32_t value);
+
+/**
+ * Look up an option by name ("deadzone", "touchpad_stick", ...).
+ * @return config_option_t, or -1 if unknown
+ */
+int config_option_by_name(const char* name);
+
+/**
+ * @return Option name, or NULL if unknown
+ */
+const char* config_option_name(int option);
+
+#endif /* ROSETTAPAD_CORE_CONFIG_H */
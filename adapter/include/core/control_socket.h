@@ -0,0 +1,147 @@
+/*
+ * RosettaPad - Control Socket
+ * ============================
+ *
+ * Unix-domain control channel for the web panel and tools: set runtime
+ * options (core/config.h), load remap profiles, inject controller output
+ * and query stats, without files or restarts.
+ *
+ * TRANSPORT:
+ *
+ * SOCK_SEQPACKET at CTL_SOCKET_PATH. Each packet is one batch of commands
+ * and gets exactly one reply packet with one reply per command, in order.
+ * Clients may pipeline: send several batches without waiting, and match
+ * replies by tag.
+ *
+ * WIRE FORMAT (packed, native endianness):
+ *
+ *   request:  ctl_batch_t, then count x (ctl_cmd_t + len payload bytes)
+ *   reply:    ctl_batch_t (same tag), then count x (ctl_reply_t + payload)
+ *
+ *   op                  arg          request payload    reply payload
+ *   CTL_OP_PING         -            any                same bytes
+ *   CTL_OP_GET_OPTION   option ID    -                  int32_t
+ *   CTL_OP_SET_OPTION   option ID    int32_t            -
+ *   CTL_OP_LOAD_REMAP   -            absolute path      -   (empty: no remapping)
+ *   CTL_OP_SET_OUTPUT   CTL_OUT_*    ctl_output_t       -
+ *   CTL_OP_GET_STATS    -            -                  ctl_stats_t
+ *   CTL_OP_GET_LATENCY  stage        -                  ctl_latency_t
+ *
+ * ATOMICITY:
+ *
+ * A batch is applied all-or-nothing. Every command is checked first (a
+ * remap profile is compiled at this point); only if all of them pass are
+ * the option changes committed in one step, the profile installed and the
+ * output sent. Otherwise nothing changes: the bad command reports why and
+ * the other changing commands report CTL_EABORTED. GET_OPTION sees the
+ * batch's own earlier SET_OPTIONs.
+ *
+ * THREADING:
+ *
+ * Everything runs on the control loop. The input thread only ever sees
+ * the results (one config seqlock write, one remap table swap).
+ */
+
+#ifndef ROSETTAPAD_CORE_CONTROL_SOCKET_H
+#define ROSETTAPAD_CORE_CONTROL_SOCKET_H
+
+#include <stdint.h>
+
+#include "core/common.h"
+#include "core/live.h"
+#include "core/reactor.h"
+
+/* ============================================================================
+ * PROTOCOL
+ * ============================================================================ */
+
+#define CTL_SOCKET_PATH     LIGHTBAR_IPC_DIR "/control.sock"
+#define CTL_VERSION         1
+#define CTL_MAX_PACKET      4096
+#define CTL_MAX_CLIENTS     8
+
+typedef enum {
+    CTL_OP_PING = 1,
+    CTL_OP_GET_OPTION,
+    CTL_OP_SET_OPTION,
+    CTL_OP_LOAD_REMAP,
+    CTL_OP_SET_OUTPUT,
+    CTL_OP_GET_STATS,
+    CTL_OP_GET_LATENCY,
+} ctl_op_t;
+
+typedef enum {
+    CTL_OK = 0,
+    CTL_EBADOP = -1,        /* Unknown op or malformed command */
+    CTL_EINVAL = -2,        /* Unknown option / stage, or value out of range */
+    CTL_ELOAD = -3,         /* Remap profile failed to load (see adapter log) */
+    CTL_EABORTED = -4,      /* Valid, but not applied: another command failed */
+} ctl_status_t;
+
+/* CTL_OP_SET_OUTPUT fields (arg) */
+#define CTL_OUT_RUMBLE      (1 << 0)
+#define CTL_OUT_LIGHTBAR    (1 << 1)
+#define CTL_OUT_PLAYER_LEDS (1 << 2)
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;        /* CTL_VERSION */
+    uint8_t count;          /* Commands / replies that follow */
+    uint16_t reserved;
+    uint32_t tag;           /* Echoed in the reply */
+} ctl_batch_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t op;
+    uint8_t len;            /* Payload bytes that follow */
+    uint16_t arg;
+} ctl_cmd_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t op;
+    int8_t status;          /* ctl_status_t */
+    uint16_t len;           /* Payload bytes that follow */
+} ctl_reply_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t rumble_left;
+    uint8_t rumble_right;
+    uint8_t led_r;
+    uint8_t led_g;
+    uint8_t led_b;
+    uint8_t player_leds;
+    uint8_t player_brightness;
+} ctl_output_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t system_state;  /* system_state_t */
+    uint32_t controller_connected;
+    live_console_t console;
+    uint64_t batches;       /* Control socket: batches handled */
+    uint64_t commands;
+    uint64_t rejected;      /* Batches not applied */
+} ctl_stats_t;
+
+typedef struct __attribute__((packed)) {
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+} ctl_latency_t;
+
+/* ============================================================================
+ * SERVER
+ * ============================================================================ */
+
+/**
+ * Create the socket and register it on the control loop.
+ * @param path Socket path, normally CTL_SOCKET_PATH (replaced if it exists)
+ * @param hooks Console-side stats for CTL_OP_GET_STATS (see core/live.h)
+ * @return 0 on success, -1 on error
+ */
+int ctl_attach(reactor_t* r, const char* path, const live_export_hooks_t* hooks);
+
+/**
+ * Close the socket and every client connection.
+ */
+void ctl_close(void);
+
+#endif /* ROSETTAPAD_CORE_CONTROL_SOCKET_H */
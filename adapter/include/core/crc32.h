@@ -0,0 +1,71 @@
+/*
+ * RosettaPad - CRC32
+ * ===================
+ * 
+ * CRC-32 (IEEE 802.3 / zlib polynomial, reflected 0xEDB88320), as used by
+ * DualSense Bluetooth reports.
+ * 
+ * The implementation is picked at runtime:
+ * 
+ *   armv8    AArch64 CRC32 instructions, 8 bytes per instruction
+ *            (Cortex-A53 on the Pi Zero 2W has them)
+ *   slice8   Slicing-by-8 tables, 8 bytes per step
+ *   table    Classic bytewise table loop
+ * 
+ * crc32_extend() continues a CRC, so a constant prefix (e.g. the 0xA1 /
+ * 0xA2 Bluetooth HID header) can be folded into a precomputed seed once
+ * instead of being copied in front of every report.
+ */
+
+#ifndef ROSETTAPAD_CORE_CRC32_H
+#define ROSETTAPAD_CORE_CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    CRC32_IMPL_TABLE = 0,
+    CRC32_IMPL_SLICE8,
+    CRC32_IMPL_ARMV8,
+    CRC32_IMPL_COUNT
+} crc32_impl_t;
+
+/**
+ * Build the tables and select the fastest implementation the CPU
+ * supports. Idempotent; called lazily by the first CRC if needed.
+ */
+void crc32_init(void);
+
+/**
+ * Force an implementation (benchmarks and self-checks).
+ * @return 0 on success, -1 if the CPU doesn't support it
+ */
+int crc32_select(crc32_impl_t impl);
+
+/**
+ * @return Implementation in use, e.g. "armv8"
+ */
+const char* crc32_impl_name(void);
+
+/**
+ * @return Name of an implementation
+ */
+const char* crc32_impl_str(crc32_impl_t impl);
+
+/**
+ * Continue a CRC over more data (zlib crc32() semantics).
+ * @param crc CRC of the preceding bytes (0 to start)
+ * @param data Bytes to add
+ * @param len Number of bytes
+ * @return CRC of the preceding bytes followed by data
+ */
+uint32_t crc32_extend(uint32_t crc, const void* data, size_t len);
+
+/**
+ * CRC of a buffer.
+ */
+static inline uint32_t crc32_compute(const void* data, size_t len) {
+    return crc32_extend(0, data, len);
+}
+
+#endif /* ROSETTAPAD_CORE_CRC32_H */
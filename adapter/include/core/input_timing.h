@@ -0,0 +1,66 @@
+/*
+ * RosettaPad - Controller Input Timing
+ * =====================================
+ * 
+ * Uses the controller's own sample clock and sequence counter (when the
+ * driver provides them) to measure what actually happens on the link:
+ * 
+ * - True inter-report interval, from device sensor timestamps
+ * - Delivery jitter: how late each report arrived compared to the
+ *   least-delayed report seen so far (Bluetooth scheduling, retries)
+ * - Dropped frames, from gaps in the sequence counter
+ * 
+ * It also maps the device clock onto the host monotonic timebase, so
+ * motion samples can be placed at the time they were taken rather than
+ * the time they happened to arrive.
+ */
+
+#ifndef ROSETTAPAD_CORE_INPUT_TIMING_H
+#define ROSETTAPAD_CORE_INPUT_TIMING_H
+
+#include <stdint.h>
+
+#include "controllers/controller_interface.h"
+
+/* ============================================================================
+ * STATISTICS
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t reports;           /* Reports seen since last reset */
+    uint64_t timed_reports;     /* Reports that carried a sensor timestamp */
+    uint64_t dropped_frames;    /* Missing sequence numbers */
+    uint64_t clock_resyncs;     /* Device clock jumped, mapping restarted */
+    int64_t  clock_offset_ns;   /* Host time - device time (min-delay estimate) */
+    uint64_t last_interval_ns;  /* Most recent device-timed report interval */
+} input_timing_stats_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Forget all history (call on controller connect/disconnect).
+ */
+void input_timing_reset(void);
+
+/**
+ * Account for a freshly parsed report and fill in state->sample_time_ns.
+ * Must be called from the input thread after rx_time_ns is set.
+ * 
+ * If the driver didn't provide a sensor clock, sample_time_ns is the
+ * host receive time.
+ */
+void input_timing_update(controller_state_t* state);
+
+/**
+ * Snapshot the current statistics.
+ */
+void input_timing_get_stats(input_timing_stats_t* out);
+
+/**
+ * Print statistics to stdout.
+ */
+void input_timing_dump(void);
+
+#endif /* ROSETTAPAD_CORE_INPUT_TIMING_H */
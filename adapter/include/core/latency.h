@@ -0,0 +1,107 @@
+/*
+ * RosettaPad - Input Latency Instrumentation
+ * ===========================================
+ * 
+ * Per-stage latency histograms for the controller -> console input path.
+ * 
+ * Timestamps are taken at:
+ *   T0  hidraw read() returned            (controller input thread)
+ *   T1  process_input() finished
+ *   T2  controller_state_update()
+ *   T3  ds3_build_input_report() finished  (USB or Bluetooth sender)
+ *   T4  ep1 write() / L2CAP send() completed
+ * 
+ * All timestamps come from time_now_ns() (core/timebase.h).
+ * Each stage feeds a log-linear histogram (16 sub-buckets per power of
+ * two, ~6% resolution). Recording is a handful of relaxed atomic adds,
+ * cheap enough to leave enabled in production. Send SIGUSR1 to dump.
+ */
+
+#ifndef ROSETTAPAD_CORE_LATENCY_H
+#define ROSETTAPAD_CORE_LATENCY_H
+
+#include <stdint.h>
+
+#include "core/timebase.h"
+
+/* ============================================================================
+ * STAGES
+ * ============================================================================ */
+
+typedef enum {
+    LAT_PARSE = 0,      /* T0 -> T1: driver process_input() */
+    LAT_PUBLISH,        /* T1 -> T2: state published to console layers */
+    LAT_USB_BUILD,      /* T2 -> T3: waiting to be sampled + DS3 translation (USB) */
+    LAT_USB_SEND,       /* T3 -> T4: ep1 write */
+    LAT_USB_AGE,        /* T0 -> T4: input age when the USB report left the Pi */
+    LAT_BT_BUILD,       /* T2 -> T3: waiting to be sampled + DS3 translation (BT) */
+    LAT_BT_SEND,        /* T3 -> T4: L2CAP interrupt send */
+    LAT_BT_AGE,         /* T0 -> T4: input age when the BT report left the Pi */
+    LAT_SENSOR_INTERVAL,/* Device sensor clock between consecutive reports */
+    LAT_DELIVERY_JITTER,/* T0 lateness vs. best-case delivery (core/input_timing.h) */
+    LAT_HOST_POLL_INTERVAL, /* Time between ep1 completions (core/cadence.h) */
+    LAT_HOST_POLL_JITTER,   /* ep1 completion vs. predicted host poll */
+    LAT_MACRO_STEP,     /* Macro step published vs. scheduled (core/macro.h) */
+    LAT_TAS_FRAME,      /* TAS frame published vs. scheduled (core/tas.h) */
+    LAT_STAGE_COUNT
+} latency_stage_t;
+
+/* ============================================================================
+ * HISTOGRAM
+ * ============================================================================ */
+
+#define LAT_SUB_BITS    4
+#define LAT_SUB_COUNT   (1 << LAT_SUB_BITS)
+#define LAT_GROUPS      37      /* Top group is msb 39: up to ~2^40 ns (18 min) */
+#define LAT_BUCKETS     (LAT_GROUPS * LAT_SUB_COUNT)
+
+typedef struct {
+    uint64_t counts[LAT_BUCKETS];
+    uint64_t total;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} latency_histogram_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Record one sample for a stage. Thread-safe, lock-free.
+ * @param stage Stage to record
+ * @param ns Duration in nanoseconds
+ */
+void latency_record(latency_stage_t stage, uint64_t ns);
+
+/**
+ * Record the time elapsed between two timestamps.
+ * Ignored if the start timestamp was never set (0) or is in the future.
+ */
+static inline void latency_record_span(latency_stage_t stage, uint64_t start_ns, uint64_t end_ns) {
+    if (start_ns != 0 && end_ns >= start_ns) {
+        latency_record(stage, end_ns - start_ns);
+    }
+}
+
+/**
+ * Get a stage's value at the given percentile (0-100).
+ * @return Upper bound of the matching bucket in nanoseconds, 0 if empty
+ */
+uint64_t latency_percentile(latency_stage_t stage, double percentile);
+
+/**
+ * Print all stage histograms (p50/p99/p99.9/max) to stdout.
+ */
+void latency_dump(void);
+
+/**
+ * Clear all histograms.
+ */
+void latency_reset(void);
+
+/**
+ * Get stage name for logging.
+ */
+const char* latency_stage_str(latency_stage_t stage);
+
+#endif /* ROSETTAPAD_CORE_LATENCY_H */
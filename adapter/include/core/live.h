@@ -0,0 +1,138 @@
+/*
+ * RosettaPad - Live State Export
+ * ===============================
+ *
+ * Publishes a snapshot of the adapter's live state - the current
+ * controller_state_t, the last report sent to the console, console link
+ * counters and the system state - in a shared-memory segment, so the web
+ * panel, input displays and diagnostics can sample it at any rate without
+ * syscalls and without touching the adapter's locks.
+ *
+ * SEGMENT LAYOUT (native endianness, LIVE_EXPORT_PATH):
+ *
+ *   live_shm_t
+ *     header   magic, version, sizes - validate before reading anything
+ *     seq      seqlock (see core/seqlock.h), on its own cache line
+ *     snap     live_snapshot_t, valid when read under seq
+ *
+ * Reading (any process, mapping the file read-only is enough):
+ *
+ *   live_snapshot_t snap;
+ *   if (live_snapshot_read(shm, &snap, NULL) == 0) ...
+ *
+ * seq only advances when something changed, so a reader polling faster
+ * than the adapter updates can compare it to skip duplicates. The writer
+ * clears header.version when the adapter exits.
+ *
+ * THREADING:
+ *
+ * A timer on the control loop samples the state every
+ * LIVE_EXPORT_INTERVAL_MS and is the segment's only writer. The input and
+ * console paths don't do any extra work for the export.
+ */
+
+#ifndef ROSETTAPAD_CORE_LIVE_H
+#define ROSETTAPAD_CORE_LIVE_H
+
+#include <stdint.h>
+
+#include "core/common.h"
+#include "core/reactor.h"
+#include "core/seqlock.h"
+
+/* ============================================================================
+ * FORMAT
+ * ============================================================================ */
+
+#define LIVE_EXPORT_PATH        "/dev/shm/rosettapad"
+#define LIVE_MAGIC              "RPLIVE\0\1"
+#define LIVE_VERSION            1
+#define LIVE_REPORT_MAX         64      /* Largest console report exported */
+#define LIVE_EXPORT_INTERVAL_MS 4       /* 250Hz, several samples per 60Hz frame */
+
+/* Console link, filled in by the console layer (see live_export_hooks_t) */
+typedef struct {
+    uint32_t state;             /* bt_state_t for the PS3 */
+    uint32_t usb_enabled;
+    uint32_t packets_sent;
+    uint32_t packets_dropped;
+    uint32_t reconnect_count;
+    uint32_t reserved;
+    uint64_t connect_time_ns;   /* Monotonic */
+    uint64_t last_send_time_ns; /* Monotonic */
+} live_console_t;
+
+typedef struct {
+    uint64_t update_time_ns;    /* Monotonic time of this snapshot */
+    uint32_t system_state;      /* system_state_t */
+    uint32_t controller_connected;
+    
+    controller_state_t controller;
+    
+    live_console_t console;
+    uint32_t report_len;        /* Valid bytes in report */
+    uint8_t report[LIVE_REPORT_MAX];   /* Last input report built for the console */
+} live_snapshot_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;           /* 0 once the adapter has exited */
+    uint32_t size;              /* sizeof(live_shm_t) */
+    uint32_t snapshot_size;     /* sizeof(live_snapshot_t) */
+    uint32_t controller_size;   /* sizeof(controller_state_t) */
+    uint32_t writer_pid;
+    uint32_t interval_ms;       /* Sampling interval of the writer */
+} live_header_t;
+
+typedef struct {
+    live_header_t header;
+    seqlock_t seq CACHE_ALIGNED;
+    live_snapshot_t snap CACHE_ALIGNED;
+} live_shm_t;
+
+/* ============================================================================
+ * WRITER
+ * ============================================================================ */
+
+/* Fills the fields core/ can't see - called on the control loop */
+typedef struct {
+    void (*sample_console)(live_console_t* out);
+    uint32_t (*sample_report)(uint8_t* out, uint32_t max);  /* @return length */
+} live_export_hooks_t;
+
+/**
+ * Create (or take over) the shared-memory segment.
+ * @param path Segment file, normally LIVE_EXPORT_PATH
+ * @return 0 on success, -1 on error
+ */
+int live_export_open(const char* path);
+
+/**
+ * Start sampling on the control loop. No-op if the segment isn't open.
+ * @return 0 on success, -1 on error
+ */
+int live_export_attach(reactor_t* r, const live_export_hooks_t* hooks);
+
+/**
+ * Mark the segment stale, unmap and remove it.
+ */
+void live_export_close(void);
+
+/* ============================================================================
+ * READER
+ * ============================================================================ */
+
+/**
+ * Check a mapped segment's header against this build's layout.
+ * @return 0 if compatible, -1 if not (or the adapter has exited)
+ */
+int live_check_header(const live_shm_t* shm);
+
+/**
+ * Copy a consistent snapshot out of a mapped segment.
+ * @param seq_out Sequence number of the snapshot (may be NULL)
+ * @return 0 on success, -1 if the header doesn't match
+ */
+int live_snapshot_read(const live_shm_t* shm, live_snapshot_t* out, uint32_t* seq_out);
+
+#endif /* ROSETTAPAD_CORE_LIVE_H */
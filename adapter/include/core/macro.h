@@ -0,0 +1,108 @@
+/*
+ * RosettaPad - Macros
+ * ====================
+ * 
+ * A macro is a button combo that, when pressed, plays a sequence of
+ * button/axis states with fixed per-step durations. Playback runs on the
+ * input loop: each step boundary is an absolute CLOCK_MONOTONIC timerfd
+ * deadline, and the step is published to the console layers right away
+ * instead of waiting for the next controller report.
+ * 
+ * Macro file ('#' starts a comment, durations in ms or us):
+ * 
+ *   macro hadouken l3+r3        Name, then the trigger combo
+ *       down         16.7ms     Buttons held for this step ("none" = nothing)
+ *       down+right   16.7ms
+ *       right+square 16.7ms
+ *       none lx=0 ly=128 500us  Axes can be set too (lx ly rx ry lt rt)
+ *   end
+ * 
+ * Button and axis names are the ones used by remap profiles
+ * (core/remap.h). During a step the step's buttons replace the live
+ * buttons; axes the step doesn't set stay live.
+ * 
+ * Steps are scheduled from the macro start, so lateness never
+ * accumulates, and no step is ever skipped. How late each step was
+ * published goes into the "macro step" latency histogram.
+ */
+
+#ifndef ROSETTAPAD_CORE_MACRO_H
+#define ROSETTAPAD_CORE_MACRO_H
+
+#include <stdint.h>
+
+#include "core/reactor.h"
+#include "core/remap.h"
+#include "controllers/controller_interface.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define MACRO_MAX           16
+#define MACRO_MAX_STEPS     64
+#define MACRO_MAX_NAME      32
+
+/* ============================================================================
+ * TYPES
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t buttons;
+    uint8_t axis_mask;                  /* Bit per remap_axis_t set by the step */
+    uint8_t axes[REMAP_AXIS_COUNT];
+    uint64_t duration_ns;
+} macro_step_t;
+
+typedef struct {
+    char name[MACRO_MAX_NAME];
+    uint32_t trigger;                   /* All of these pressed starts it */
+    macro_step_t steps[MACRO_MAX_STEPS];
+    int num_steps;
+    
+    /* Playback statistics */
+    uint64_t plays;
+    uint64_t steps_played;
+    uint64_t max_late_ns;
+} macro_t;
+
+/* Publishes a state to the console layers (main.c) */
+typedef void (*macro_publish_t)(controller_state_t* state);
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Load macros from a file. Call before macro_attach().
+ * @return 0 on success, -1 on error (logged with line number)
+ */
+int macro_load(const char* path);
+
+/**
+ * Register the step timer on the input loop.
+ * Does nothing if no macros are loaded.
+ * @param r Input event loop
+ * @param publish Called with the overlaid state at each step boundary
+ * @return 0 on success, -1 on failure
+ */
+int macro_attach(reactor_t* r, macro_publish_t publish);
+
+/**
+ * Feed a controller report (input thread, before publishing).
+ * Starts a macro on its trigger's rising edge and overlays the current
+ * step onto the state.
+ */
+void macro_process(controller_state_t* state);
+
+/**
+ * Stop playback (controller disconnected).
+ */
+void macro_cancel(void);
+
+/**
+ * Print per-macro play counts and step timing.
+ */
+void macro_dump(void);
+
+#endif /* ROSETTAPAD_CORE_MACRO_H */
@@ -0,0 +1,114 @@
+/*
+ * RosettaPad - Motion Sample Alignment
+ * =====================================
+ * 
+ * The console layers sample controller state on their own schedule
+ * (4ms USB poll, ~40ms Bluetooth), which has nothing to do with when the
+ * controller's sensors were actually read. Copying "whatever arrived
+ * last" turns Bluetooth delivery jitter into motion jitter.
+ * 
+ * This module keeps a short history of motion samples stamped with the
+ * sensor time (mapped onto the host timebase by core/input_timing). The
+ * senders ask for the motion at a fixed delay behind "now" and get a
+ * value interpolated between the two sensor samples around that instant,
+ * so consecutive DS3 reports are evenly spaced in sensor time.
+ * 
+ * DECIMATION:
+ * 
+ * Bluetooth reports go out every CONFIG_BT_INPUT_INTERVAL_MS (40ms) while
+ * the controller samples at 250Hz or more, so even a well-aligned point
+ * sample aliases everything above half the report rate into the output.
+ * A sender can instead ask for the mean of every sample since its
+ * previous report - a boxcar over exactly one output interval, i.e. a
+ * first-order CIC decimator. The writer keeps a running (wrapping) sum
+ * per axis, the integrator; each sender differences two of them, the
+ * comb. The cost doesn't depend on how many samples an interval holds,
+ * and the window follows the report interval when it is changed.
+ */
+
+#ifndef ROSETTAPAD_CORE_MOTION_H
+#define ROSETTAPAD_CORE_MOTION_H
+
+#include <stdint.h>
+
+#include "controllers/controller_interface.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+/* Number of samples kept (power of two). 128 covers the longest
+ * Bluetooth report interval (100ms) at 1000Hz. */
+#define MOTION_HISTORY_SIZE     128
+
+/*
+ * How far behind "now" the senders sample. Must exceed typical delivery
+ * jitter so the sample after the requested instant has usually arrived;
+ * if it hasn't, the newest sample is used as-is.
+ */
+#define MOTION_ALIGN_DELAY_US   4000
+
+typedef struct {
+    uint64_t time_ns;       /* Sensor sample time, host timebase */
+    int16_t accel[3];
+    int16_t gyro[3];
+} motion_sample_t;
+
+/* One sender's position in the history (decimation) */
+typedef struct {
+    uint32_t epoch;         /* History generation `next` belongs to */
+    uint32_t next;          /* First sample of the next interval */
+} motion_decimator_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Drop all history (call on controller connect/disconnect).
+ */
+void motion_reset(void);
+
+/**
+ * Append the motion part of a parsed report.
+ * Input thread only; state->sample_time_ns must be set.
+ */
+void motion_push(const controller_state_t* state);
+
+/**
+ * Get the motion at a point in time, interpolating between samples.
+ * Times outside the history are clamped to the oldest/newest sample.
+ * @param time_ns Host monotonic time
+ * @param out Filled with the sample
+ * @return 0 on success, -1 if no history
+ */
+int motion_sample_at(uint64_t time_ns, motion_sample_t* out);
+
+/**
+ * Replace the accel/gyro fields of a state snapshot with the motion
+ * MOTION_ALIGN_DELAY_US before now. Leaves state untouched if no history.
+ */
+void motion_align_state(controller_state_t* state, uint64_t now_ns);
+
+/**
+ * Start a decimator over (call when its sender starts streaming).
+ * The first interval then falls back to a point sample.
+ */
+void motion_decimator_reset(motion_decimator_t* d);
+
+/**
+ * Get the mean of all samples after the previous call up to time_ns.
+ * Falls back to motion_sample_at() if there is no such sample (first
+ * call, controller stalled). Intervals longer than the history are
+ * shortened to it. One caller (thread) per decimator.
+ * @return 0 on success, -1 if no history
+ */
+int motion_decimate(motion_decimator_t* d, uint64_t time_ns, motion_sample_t* out);
+
+/**
+ * motion_align_state(), but with the mean over the decimator's interval
+ * ending MOTION_ALIGN_DELAY_US before now.
+ */
+void motion_decimate_state(motion_decimator_t* d, controller_state_t* state, uint64_t now_ns);
+
+#endif /* ROSETTAPAD_CORE_MOTION_H */
@@ -0,0 +1,158 @@
+/*
+ * RosettaPad - Event Loop
+ * ========================
+ * 
+ * Small epoll-based reactor. Each loop owns a set of file descriptors
+ * (hidraw, ep0, L2CAP sockets, timerfds, eventfds) and calls a handler
+ * when one becomes ready, so threads sleep until there is real work
+ * instead of waking on a usleep() schedule.
+ * 
+ * Loops in use:
+ *   input    Controller input thread: hidraw + device scan timer
+ *   ep1      USB input report pacing / keep-alive timer
+ *   control  Main thread: ep0, L2CAP control/interrupt, BT pacing and
+ *            management timers, controller output, signals
+ * 
+ * Every loop also watches a shared shutdown eventfd, so a single
+ * reactor_request_shutdown() wakes and stops all of them.
+ * 
+ * Handlers may add/remove descriptors from any thread. Removing a
+ * descriptor guarantees its handler won't be called for events that
+ * were already collected but not yet dispatched.
+ */
+
+#ifndef ROSETTAPAD_CORE_REACTOR_H
+#define ROSETTAPAD_CORE_REACTOR_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define REACTOR_MAX_SLOTS   16      /* Descriptors per loop */
+#define REACTOR_MAX_EVENTS  8       /* Events collected per epoll_wait() */
+
+/* ============================================================================
+ * TYPES
+ * ============================================================================ */
+
+/**
+ * Event handler.
+ * @param fd Ready descriptor
+ * @param events EPOLL* event mask
+ * @param ctx Pointer passed to reactor_add()
+ */
+typedef void (*reactor_handler_t)(int fd, uint32_t events, void* ctx);
+
+typedef struct {
+    int fd;                     /* -1 if free */
+    uint32_t gen;               /* Bumped on every reuse */
+    reactor_handler_t handler;
+    void* ctx;
+} reactor_slot_t;
+
+typedef struct {
+    const char* name;
+    int epfd;
+    pthread_mutex_t lock;       /* Protects slots */
+    reactor_slot_t slots[REACTOR_MAX_SLOTS];
+    uint64_t wakeups;           /* epoll_wait() returns with events */
+} reactor_t;
+
+/* ============================================================================
+ * LOOP
+ * ============================================================================ */
+
+/**
+ * Create a loop. Registers the shared shutdown eventfd.
+ * @param name Name for logging
+ * @return 0 on success, -1 on failure
+ */
+int reactor_init(reactor_t* r, const char* name);
+
+/**
+ * Close the loop. Registered descriptors are not closed.
+ */
+void reactor_close(reactor_t* r);
+
+/**
+ * Watch a descriptor.
+ * @param events EPOLLIN / EPOLLOUT / ...
+ * @return 0 on success, -1 on failure
+ */
+int reactor_add(reactor_t* r, int fd, uint32_t events, reactor_handler_t handler, void* ctx);
+
+/**
+ * Change the events watched for a descriptor.
+ * @return 0 on success, -1 if not registered
+ */
+int reactor_mod(reactor_t* r, int fd, uint32_t events);
+
+/**
+ * Stop watching a descriptor (call before closing it).
+ * @return 0 on success, -1 if not registered
+ */
+int reactor_del(reactor_t* r, int fd);
+
+/**
+ * Dispatch events until shutdown is requested.
+ */
+void reactor_run(reactor_t* r);
+
+/* ============================================================================
+ * SHUTDOWN
+ * ============================================================================ */
+
+/**
+ * Clear g_running and wake every loop. Async-signal-safe.
+ */
+void reactor_request_shutdown(void);
+
+/* ============================================================================
+ * TIMERS AND EVENTS
+ * 
+ * Timers run on CLOCK_MONOTONIC, the same clock as time_now_ns(), and
+ * take absolute deadlines so periodic timers don't drift.
+ * ============================================================================ */
+
+/**
+ * Create a non-blocking timerfd.
+ * @return fd, or -1 on failure
+ */
+int reactor_timer_create(void);
+
+/**
+ * Arm or disarm a timer.
+ * @param first_ns Absolute monotonic time of first expiry (0 disarms)
+ * @param period_ns Period after the first expiry (0 for one-shot)
+ * @return 0 on success, -1 on failure
+ */
+int reactor_timer_set(int tfd, uint64_t first_ns, uint64_t period_ns);
+
+/**
+ * Acknowledge a timer.
+ * @return Expirations since last read (0 if none)
+ */
+uint64_t reactor_timer_read(int tfd);
+
+/**
+ * Create a non-blocking eventfd.
+ * @return fd, or -1 on failure
+ */
+int reactor_event_create(void);
+
+/**
+ * Signal an eventfd. Async-signal-safe.
+ */
+void reactor_event_signal(int efd);
+
+/**
+ * Consume an eventfd.
+ * @return Accumulated count (0 if not signalled)
+ */
+uint64_t reactor_event_read(int efd);
+
+#endif /* ROSETTAPAD_CORE_REACTOR_H */
@@ -0,0 +1,120 @@
+/*
+ * RosettaPad - Button / Axis Remapping
+ * =====================================
+ * 
+ * Applied in the input thread between the driver's process_input() and
+ * controller_state_update(), so every console layer sees remapped state.
+ * 
+ * A profile is a text file, one rule per line ('#' starts a comment):
+ * 
+ *   cross = circle        Button to button (a button may have several
+ *   cross = triangle      targets; the first rule drops its identity map)
+ *   ps = none             Disable a button
+ *   l1 = ly-              Button to full stick deflection (lx ly rx ry, +/-)
+ *   r1 = rt               Button to full analog trigger (lt rt)
+ *   axis lx = rx          Feed an output axis from another input axis
+ *   invert ly             Invert an axis
+ *   threshold lt = 64     Digital L2 from the analog trigger (0-255)
+ * 
+ * Button names: cross circle square triangle l1 r1 l2 r2 l3 r3 select
+ * start ps touchpad mute up down left right (or south/east/west/north/home).
+ * 
+ * Profiles are compiled into flat tables, so applying one costs a few
+ * lookups per report. Loading a new profile swaps the active table with
+ * one atomic store; the input thread never waits for it.
+ */
+
+#ifndef ROSETTAPAD_CORE_REMAP_H
+#define ROSETTAPAD_CORE_REMAP_H
+
+#include <stdint.h>
+
+#include "controllers/controller_interface.h"
+
+/* ============================================================================
+ * COMPILED TABLE
+ * ============================================================================ */
+
+/* Axes, in controller_state_t field order (left_stick_x .. right_trigger) */
+typedef enum {
+    REMAP_AXIS_LX = 0,
+    REMAP_AXIS_LY,
+    REMAP_AXIS_RX,
+    REMAP_AXIS_RY,
+    REMAP_AXIS_LT,
+    REMAP_AXIS_RT,
+    REMAP_AXIS_COUNT
+} remap_axis_t;
+
+#define REMAP_MAX_BUTTON_AXES   BTN_COUNT   /* Button -> axis bindings */
+#define REMAP_MAX_LINE          128
+
+typedef struct {
+    uint32_t mask;              /* Source buttons (after thresholds) */
+    uint8_t axis;               /* remap_axis_t */
+    uint8_t value;              /* Axis value while held */
+} remap_button_axis_t;
+
+typedef struct {
+    /* Source button byte -> target buttons, one table per byte of the mask */
+    uint32_t buttons[3][256];
+    int buttons_identity;       /* Buttons pass through unchanged */
+    
+    /* Output axis = input axis[axis_source] ^ axis_invert */
+    uint8_t axis_source[REMAP_AXIS_COUNT];
+    uint8_t axis_invert[REMAP_AXIS_COUNT];
+    
+    /* Digital L2/R2 from analog, 0 = keep the driver's bit */
+    uint8_t trigger_threshold[2];
+    
+    remap_button_axis_t button_axes[REMAP_MAX_BUTTON_AXES];
+    int num_button_axes;
+} remap_table_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Parse and compile a profile without installing it.
+ * @param path Profile file
+ * @return Newly allocated table, or NULL on error (logged with line number)
+ */
+remap_table_t* remap_compile_file(const char* path);
+
+/**
+ * Make a table active. Takes ownership; the previous table is freed once
+ * no report is using it. NULL disables remapping.
+ */
+void remap_install(remap_table_t* table);
+
+/**
+ * Compile and install a profile, remembering the path for remap_reload().
+ * @return 0 on success, -1 on error (the active table is kept)
+ */
+int remap_load(const char* path);
+
+/**
+ * Reload the last profile loaded with remap_load() (SIGHUP).
+ * @return 0 on success or if none was loaded, -1 on error
+ */
+int remap_reload(void);
+
+/**
+ * Look up a button by profile name ("cross", "l1", "up", ...).
+ * @return BTN_* id, or -1 if unknown
+ */
+int remap_button_by_name(const char* name);
+
+/**
+ * Look up an axis by profile name ("lx" ... "rt").
+ * @return remap_axis_t, or -1 if unknown
+ */
+int remap_axis_by_name(const char* name);
+
+/**
+ * Apply the active table to a freshly parsed state (input thread).
+ */
+void remap_apply(controller_state_t* state);
+
+#endif /* ROSETTAPAD_CORE_REMAP_H */
@@ -0,0 +1,75 @@
+/*
+ * RosettaPad - Real-Time Profile
+ * ===============================
+ * 
+ * Optional real-time setup for the latency-critical threads (controller
+ * input loop and ep1 sender):
+ * 
+ * - SCHED_FIFO priority, so background work can't preempt them
+ * - CPU affinity: hot threads on one core, everything else kept off it
+ * - mlockall() so the input path never takes a page fault
+ * - 1us timer slack (only matters if SCHED_FIFO was refused)
+ * - Priority-inheritance on the mutexes the hot path shares with
+ *   normal-priority threads
+ * 
+ * Each part is applied independently. Anything the process isn't allowed
+ * to do (no CAP_SYS_NICE / CAP_IPC_LOCK, RLIMIT_RTPRIO 0, ...) is logged
+ * and skipped; the adapter keeps running at normal priority.
+ */
+
+#ifndef ROSETTAPAD_CORE_RT_H
+#define ROSETTAPAD_CORE_RT_H
+
+#include <pthread.h>
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define RT_DEFAULT_PRIORITY     50      /* Input thread; ep1 runs one below */
+#define RT_CPU_AUTO             -2      /* Last online CPU */
+#define RT_CPU_NONE             -1      /* Don't pin */
+#define RT_TIMER_SLACK_NS       1000
+#define RT_STACK_PREFAULT       (64 * 1024)
+
+typedef enum {
+    RT_THREAD_INPUT = 0,        /* Controller input loop */
+    RT_THREAD_EP1,              /* USB ep1 sender */
+    RT_THREAD_COUNT
+} rt_thread_t;
+
+typedef struct {
+    int enabled;                /* --rt */
+    int priority;               /* SCHED_FIFO priority of the input thread */
+    int cpu;                    /* Core for hot threads, RT_CPU_AUTO or RT_CPU_NONE */
+    int lock_memory;            /* mlockall() */
+} rt_profile_t;
+
+extern rt_profile_t g_rt_profile;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Apply process-wide settings: mlockall, PI mutexes and keeping the main
+ * thread (and threads it spawns later) off the hot core.
+ * Must be called before any other thread is started. No-op unless enabled.
+ */
+void rt_init(void);
+
+/**
+ * Apply the profile to the calling thread and log what it actually got.
+ * No-op unless enabled.
+ * @param which Which hot thread this is
+ */
+void rt_thread_enter(rt_thread_t which);
+
+/**
+ * Re-initialize a statically initialized mutex with priority inheritance.
+ * Only safe while no other thread can be using it.
+ * @return 0 on success, -1 if not supported
+ */
+int rt_mutex_make_pi(pthread_mutex_t* mutex);
+
+#endif /* ROSETTAPAD_CORE_RT_H */
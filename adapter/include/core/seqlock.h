@@ -0,0 +1,88 @@
+/*
+ * RosettaPad - Sequence Lock
+ * ===========================
+ *
+ * Single-writer / multi-reader sequence lock for small, frequently
+ * updated snapshots (controller state, exported live state, etc.).
+ *
+ * The writer never waits for readers. Readers copy the protected data
+ * optimistically and retry if a write overlapped the copy. Writers must
+ * be serialized externally if more than one thread can write.
+ *
+ * Usage:
+ *
+ *   Writer:                          Reader:
+ *     seqlock_write_begin(&sl);        uint32_t seq;
+ *     ...store data...                 do {
+ *     seqlock_write_end(&sl);              seq = seqlock_read_begin(&sl);
+ *                                          ...copy data...
+ *                                      } while (seqlock_read_retry(&sl, seq));
+ */
+
+#ifndef ROSETTAPAD_CORE_SEQLOCK_H
+#define ROSETTAPAD_CORE_SEQLOCK_H
+
+#include <stdint.h>
+
+/* Cache line size on the Cortex-A53 (Pi Zero 2W) and most other targets */
+#define CACHE_LINE_SIZE 64
+
+/* Align a variable to its own cache line to avoid false sharing */
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+
+typedef struct {
+    uint32_t seq;   /* Odd while a write is in progress */
+} seqlock_t;
+
+#define SEQLOCK_INITIALIZER { .seq = 0 }
+
+/* Spin hint while a write is in progress */
+static inline void seqlock_cpu_relax(void) {
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("pause" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * Begin a write. Readers that started before this will retry.
+ */
+static inline void seqlock_write_begin(seqlock_t* sl) {
+    uint32_t seq = __atomic_load_n(&sl->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&sl->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * End a write, publishing the new data.
+ */
+static inline void seqlock_write_end(seqlock_t* sl) {
+    uint32_t seq = __atomic_load_n(&sl->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&sl->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Begin a read. Spins only while a write is in progress.
+ * @return Sequence value to pass to seqlock_read_retry()
+ */
+static inline uint32_t seqlock_read_begin(const seqlock_t* sl) {
+    uint32_t seq;
+    while ((seq = __atomic_load_n(&sl->seq, __ATOMIC_ACQUIRE)) & 1) {
+        seqlock_cpu_relax();
+    }
+    return seq;
+}
+
+/**
+ * Check whether the data copied since seqlock_read_begin() is consistent.
+ * @return Non-zero if the read must be retried
+ */
+static inline int seqlock_read_retry(const seqlock_t* sl, uint32_t start) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&sl->seq, __ATOMIC_RELAXED) != start;
+}
+
+#endif /* ROSETTAPAD_CORE_SEQLOCK_H */
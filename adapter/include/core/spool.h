@@ -0,0 +1,111 @@
+/*
+ * RosettaPad - File Spool
+ * ========================
+ *
+ * Lets a hot path append to a file without ever touching the disk: the
+ * producer copies into a pre-faulted ring, and a timer on the control
+ * loop writes whatever has accumulated. Used by the TAS recorder
+ * (core/tas.h) and the raw input capture (core/capture.h).
+ *
+ * THREADING:
+ *
+ * One producer thread (spool_room / spool_put / spool_commit) and one
+ * consumer (the drain timer, then spool_close). Head and tail are
+ * free-running byte counts. Data that doesn't fit because the drain fell
+ * behind is the producer's to drop; nothing is partially committed.
+ *
+ * Usage (producer):
+ *
+ *   if (!spool_room(&s, a_len + b_len)) { dropped++; return; }
+ *   spool_put(&s, 0, a, a_len);
+ *   spool_put(&s, a_len, b, b_len);
+ *   spool_commit(&s, a_len + b_len);
+ */
+
+#ifndef ROSETTAPAD_CORE_SPOOL_H
+#define ROSETTAPAD_CORE_SPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "core/reactor.h"
+
+/* ============================================================================
+ * TYPES
+ * ============================================================================ */
+
+typedef struct spool {
+    const char* tag;            /* Log prefix ("[TAS]") */
+    int fd;
+    int drain_timer_fd;
+    
+    uint8_t* ring;              /* mmapped, size bytes */
+    size_t size;                /* Power of 2 */
+    uint64_t head;              /* Written by producer */
+    uint64_t tail;              /* Written by consumer */
+    uint64_t bytes_written;     /* Consumer: ring bytes in the file so far */
+    
+    /* Called on the consumer after every drain (may be NULL) */
+    void (*on_drain)(void* ctx);
+    void* ctx;
+} spool_t;
+
+/* ============================================================================
+ * FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * Create the file, write its header and map the ring.
+ * Cleans up after itself on failure.
+ * @param size Ring size in bytes (power of 2)
+ * @param header Written at the start of the file (not through the ring)
+ * @return 0 on success, -1 on error
+ */
+int spool_open(spool_t* s, const char* path, size_t size,
+               const void* header, size_t header_len, const char* tag);
+
+/**
+ * Start the drain timer on a loop.
+ * @param on_drain Extra consumer work after each drain (may be NULL)
+ * @return 0 on success, -1 on error
+ */
+int spool_attach(spool_t* s, reactor_t* r, uint32_t interval_ms,
+                 void (*on_drain)(void* ctx), void* ctx);
+
+/**
+ * Write everything committed so far (consumer), then run on_drain.
+ */
+void spool_drain(spool_t* s);
+
+/**
+ * Drain, close the file and unmap the ring. Call after the producer has
+ * stopped.
+ */
+void spool_close(spool_t* s);
+
+/**
+ * @return Non-zero if len more bytes fit (producer)
+ */
+static inline int spool_room(const spool_t* s, size_t len) {
+    return s->size - (s->head - __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE)) >= len;
+}
+
+/**
+ * Copy data at offset `at` past the head, not yet visible (producer).
+ */
+static inline void spool_put(spool_t* s, size_t at, const void* data, size_t len) {
+    size_t off = (s->head + at) & (s->size - 1);
+    size_t first = len < s->size - off ? len : s->size - off;
+    memcpy(s->ring + off, data, first);
+    memcpy(s->ring, (const uint8_t*)data + first, len - first);
+}
+
+/**
+ * Publish len bytes put since the last commit (producer).
+ */
+static inline void spool_commit(spool_t* s, size_t len) {
+    __atomic_store_n(&s->head, s->head + len, __ATOMIC_RELEASE);
+}
+
+#endif /* ROSETTAPAD_CORE_SPOOL_H */
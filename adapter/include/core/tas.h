@@ -0,0 +1,209 @@
+/*
+ * RosettaPad - TAS Recording and Playback
+ * ========================================
+ * 
+ * Records every controller_state_t handed to the console layers and plays
+ * it back later at the recorded times.
+ * 
+ * LOG FORMAT
+ * ----------
+ * 
+ *   tas_header_t (64 bytes)
+ *   records ...
+ *   tas_index_entry_t[index_count]     (at index_offset, written on close)
+ * 
+ * Each record is delta-encoded against the previous one:
+ * 
+ *   varint  time delta (ns)
+ *   varint  field mask (TAS_FIELD_*)
+ *   varint  buttons                    if TAS_FIELD_BUTTONS
+ *   u8      axis                       per TAS_FIELD_AXIS(i)
+ *   zigzag  motion delta               per TAS_FIELD_MOTION(i)
+ *   u8 x3   battery level/charging/full if TAS_FIELD_BATTERY
+ * 
+ * Every TAS_KEYFRAME_INTERVAL-th record is a keyframe, encoded against
+ * an all-zero frame (so its time is absolute) and listed in the index,
+ * which makes seeking to any frame a binary search plus at most one
+ * keyframe interval of decoding. A log that wasn't closed cleanly has no
+ * index; the reader rebuilds it by scanning.
+ * 
+ * RECORDING
+ * ---------
+ * 
+ * The input thread encodes into a lock-free single-producer ring in
+ * mmapped memory and never blocks; the control loop drains the ring to
+ * the file. If the ring is full the frame is dropped and counted.
+ * 
+ * PLAYBACK
+ * --------
+ * 
+ * Runs on the input loop and replaces live input. Playback starts once a
+ * console is connected. Each frame is scheduled on an absolute timerfd
+ * at its recorded offset, then moved to the next host-poll publish slot
+ * (when the poll cadence is known) so every frame maps onto a definite
+ * host poll.
+ */
+
+#ifndef ROSETTAPAD_CORE_TAS_H
+#define ROSETTAPAD_CORE_TAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "core/reactor.h"
+#include "controllers/controller_interface.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define TAS_MAGIC               "RPTAS\0\0\1"
+#define TAS_VERSION             1
+#define TAS_KEYFRAME_INTERVAL   256
+#define TAS_RING_SIZE           (1 << 20)   /* Recording ring, power of 2 */
+#define TAS_INDEX_RING_SIZE     1024        /* Keyframes awaiting the drain */
+#define TAS_DRAIN_INTERVAL_MS   100
+#define TAS_MAX_RECORD          64          /* Worst-case encoded record */
+
+/* ============================================================================
+ * FORMAT
+ * ============================================================================ */
+
+#define TAS_FIELD_BUTTONS       (1u << 0)
+#define TAS_FIELD_AXIS(i)       (1u << (1 + (i)))   /* lx ly rx ry lt rt */
+#define TAS_FIELD_MOTION(i)     (1u << (7 + (i)))   /* accel xyz, gyro xyz */
+#define TAS_FIELD_BATTERY       (1u << 13)
+#define TAS_FIELD_ALL           ((1u << 14) - 1)
+
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint32_t version;
+    uint32_t keyframe_interval;
+    uint64_t start_time_ns;     /* Monotonic time of frame 0 */
+    uint64_t frame_count;       /* 0 if not closed cleanly */
+    uint64_t index_offset;      /* 0 if not closed cleanly */
+    uint64_t index_count;
+    uint8_t reserved[16];
+} tas_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint64_t frame;
+    uint64_t offset;            /* File offset of the keyframe record */
+    uint64_t time_ns;
+} tas_index_entry_t;
+
+/* One decoded frame */
+typedef struct {
+    uint64_t time_ns;           /* Since frame 0 */
+    uint32_t buttons;
+    uint8_t axes[6];            /* lx ly rx ry lt rt */
+    int16_t motion[6];          /* accel xyz, gyro xyz */
+    uint8_t battery[3];         /* level, charging, full */
+} tas_frame_t;
+
+/* Sequential / random access to a log (mmapped read-only) */
+typedef struct {
+    const uint8_t* map;
+    size_t map_size;
+    const uint8_t* data_end;    /* End of the records */
+    tas_header_t header;
+    tas_index_entry_t* index;
+    uint64_t index_count;
+    uint64_t frame_count;
+    
+    /* Cursor */
+    const uint8_t* pos;
+    uint64_t frame;             /* Index of the next frame */
+    tas_frame_t prev;
+} tas_reader_t;
+
+/* Playback hooks (main.c) */
+typedef struct {
+    void (*publish)(controller_state_t* state);
+    int (*console_ready)(void);             /* Start once non-zero */
+    uint64_t (*publish_slot)(uint64_t t);   /* First host-poll slot >= t, 0 if unknown */
+} tas_play_hooks_t;
+
+/* ============================================================================
+ * RECORDING
+ * ============================================================================ */
+
+/**
+ * Create a log and the recording ring. Call before the input thread starts.
+ * @return 0 on success, -1 on failure
+ */
+int tas_record_open(const char* path);
+
+/**
+ * Append a published state (input thread). Never blocks.
+ */
+void tas_record(const controller_state_t* state);
+
+/**
+ * Register the drain timer on an event loop (control loop).
+ * Does nothing if not recording.
+ */
+int tas_record_attach(reactor_t* r);
+
+/**
+ * Final drain, write the index and header, close the file.
+ * Call after the input thread has stopped.
+ */
+void tas_record_close(void);
+
+/* ============================================================================
+ * READING
+ * ============================================================================ */
+
+/**
+ * Open a log for reading.
+ * @return 0 on success, -1 on error
+ */
+int tas_reader_open(tas_reader_t* r, const char* path);
+
+void tas_reader_close(tas_reader_t* r);
+
+/**
+ * Position the cursor so the next tas_reader_next() returns `frame`.
+ * @return 0 on success, -1 if out of range
+ */
+int tas_reader_seek(tas_reader_t* r, uint64_t frame);
+
+/**
+ * Decode the next frame.
+ * @return 1 on success, 0 at end of log, -1 if the log is corrupt
+ */
+int tas_reader_next(tas_reader_t* r, tas_frame_t* out);
+
+/**
+ * Fill a controller state from a frame (marked CONTROLLER_TIMING_REPLAYED).
+ */
+void tas_frame_to_state(const tas_frame_t* f, controller_state_t* out);
+
+/* ============================================================================
+ * PLAYBACK
+ * ============================================================================ */
+
+/**
+ * Open a log for playback, starting at a frame index.
+ * @return 0 on success, -1 on error
+ */
+int tas_play_open(const char* path, uint64_t start_frame);
+
+/**
+ * Register the playback timer on the input loop.
+ * Does nothing if no log is open for playback.
+ */
+int tas_play_attach(reactor_t* r, const tas_play_hooks_t* hooks);
+
+/**
+ * Whether playback currently owns the console side (live input is ignored).
+ */
+int tas_playing(void);
+
+/**
+ * Print recording / playback statistics.
+ */
+void tas_dump(void);
+
+#endif /* ROSETTAPAD_CORE_TAS_H */
@@ -0,0 +1,117 @@
+/*
+ * RosettaPad - Timebase
+ * ======================
+ * 
+ * Monotonic nanosecond clock and absolute-deadline helpers.
+ * 
+ * All timing in the adapter (debounce, report pacing, latency
+ * measurement) runs on CLOCK_MONOTONIC so it never jumps when NTP or
+ * the user adjusts the wall clock.
+ * 
+ * - time_now_ns():         Precise, for pacing and latency measurement
+ * - time_now_coarse_ns():  Tick-granular (~1-10ms) but cheaper, for
+ *                          debounce and timeouts that don't need precision
+ * 
+ * Periodic loops should sleep to absolute deadlines (time_sleep_until)
+ * and advance them by a fixed period (time_deadline_advance) so that
+ * processing time and scheduling delays don't accumulate as drift.
+ */
+
+#ifndef ROSETTAPAD_CORE_TIMEBASE_H
+#define ROSETTAPAD_CORE_TIMEBASE_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* ============================================================================
+ * UNITS
+ * ============================================================================ */
+
+#define TIME_NS_PER_US      1000ULL
+#define TIME_NS_PER_MS      1000000ULL
+#define TIME_NS_PER_SEC     1000000000ULL
+
+#define TIME_US(us)         ((uint64_t)(us) * TIME_NS_PER_US)
+#define TIME_MS(ms)         ((uint64_t)(ms) * TIME_NS_PER_MS)
+#define TIME_SEC(s)         ((uint64_t)(s) * TIME_NS_PER_SEC)
+
+/* ============================================================================
+ * CLOCKS
+ * ============================================================================ */
+
+static inline uint64_t time_timespec_to_ns(const struct timespec* ts) {
+    return (uint64_t)ts->tv_sec * TIME_NS_PER_SEC + (uint64_t)ts->tv_nsec;
+}
+
+static inline struct timespec time_ns_to_timespec(uint64_t ns) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(ns / TIME_NS_PER_SEC),
+        .tv_nsec = (long)(ns % TIME_NS_PER_SEC)
+    };
+    return ts;
+}
+
+/**
+ * Precise monotonic time in nanoseconds.
+ */
+static inline uint64_t time_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return time_timespec_to_ns(&ts);
+}
+
+/**
+ * Coarse monotonic time in nanoseconds (resolution of the kernel tick).
+ * Same timebase as time_now_ns(), just cheaper and less precise.
+ */
+static inline uint64_t time_now_coarse_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return time_timespec_to_ns(&ts);
+}
+
+/**
+ * Precise monotonic time in milliseconds (for logging).
+ */
+static inline uint64_t time_now_ms(void) {
+    return time_now_ns() / TIME_NS_PER_MS;
+}
+
+/* ============================================================================
+ * DEADLINES
+ * ============================================================================ */
+
+/**
+ * Absolute deadline the given number of nanoseconds from now.
+ */
+static inline uint64_t time_deadline_in(uint64_t ns) {
+    return time_now_ns() + ns;
+}
+
+/**
+ * Check whether an absolute deadline has been reached.
+ */
+static inline int time_deadline_passed(uint64_t deadline_ns) {
+    return time_now_ns() >= deadline_ns;
+}
+
+/**
+ * Sleep until an absolute monotonic deadline.
+ * Returns immediately if the deadline is already in the past.
+ * Restarts after signals, so the deadline is always honoured.
+ */
+void time_sleep_until(uint64_t deadline_ns);
+
+/**
+ * Advance a periodic deadline by one period.
+ * 
+ * If the caller has fallen more than a full period behind, missed
+ * periods are skipped (phase is kept) instead of firing back-to-back.
+ * 
+ * @param deadline_ns In/out: deadline to advance
+ * @param period_ns Period length
+ * @return Number of periods skipped (0 when on schedule)
+ */
+uint32_t time_deadline_advance(uint64_t* deadline_ns, uint64_t period_ns);
+
+#endif /* ROSETTAPAD_CORE_TIMEBASE_H */
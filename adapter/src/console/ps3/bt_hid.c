@@ -11,7 +11,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <poll.h>
+#include <pthread.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/ioctl.h>
@@ -21,6 +21,9 @@
 #include <bluetooth/hci_lib.h>
 
 #include "core/common.h"
+#include "core/config.h"
+#include "core/latency.h"
+#include "core/motion.h"
 #include "console/ps3/ds3_emulation.h"
 #include "console/ps3/bt_hid.h"
 #include "console/ps3/usb_gadget.h"
@@ -216,9 +219,9 @@ static int configure_adapter(void) {
  * SCANNING
  * ============================================================================ */
 
-int ps3_bt_scan(int timeout_sec) {
+/* Inquiry for a PS3. Blocks for timeout_sec. @return 0 with *out set, -1 if none found */
+static int bt_scan(int timeout_sec, bdaddr_t* out) {
     printf("[BT] Scanning for PS3 (%d seconds)...\n", timeout_sec);
-    g_ps3_bt_ctx.state = BT_STATE_SCANNING;
     
     int dev_id = hci_get_route(NULL);
     if (dev_id < 0) return -1;
@@ -242,20 +245,17 @@ int ps3_bt_scan(int timeout_sec) {
         
         if (strcasestr(name, "playstation") || strcasestr(name, "PS3") || 
             strcasestr(name, "sony") || is_sony_oui(&devices[i].bdaddr)) {
-            bacpy(&g_ps3_bt_ctx.ps3_addr, &devices[i].bdaddr);
-            g_ps3_bt_ctx.ps3_addr_valid = 1;
+            bacpy(out, &devices[i].bdaddr);
             found = 1;
             
             char addr[18];
             ba2str(&devices[i].bdaddr, addr);
             printf("[BT] Found PS3: %s\n", addr);
-            ps3_bt_save_addr();
         }
     }
     
     free(devices);
     hci_close_dev(sock);
-    g_ps3_bt_ctx.state = BT_STATE_DISCONNECTED;
     
     return found ? 0 : -1;
 }
@@ -313,6 +313,77 @@ static int create_l2cap_socket(uint16_t psm, const bdaddr_t* dest) {
     return sock;
 }
 
+/* ============================================================================
+ * EVENT LOOP
+ * 
+ * Everything except connecting runs on the control loop:
+ *   - L2CAP control/interrupt sockets (registered while connected)
+ *   - Pacing timer: periodic CONFIG_BT_INPUT_INTERVAL_MS while ENABLED
+ *   - Management timer: connection state machine at BT_MANAGE_INTERVAL_MS
+ *   - Wake: request event plus a timer stepping connect / press / release
+ * Connecting blocks (inquiry, connect(), initial reports) so it runs in
+ * a short-lived worker thread. g_bt_connecting lets only one run; the
+ * worker touches nothing but its job and hands the sockets back through
+ * an event, so g_ps3_bt_ctx is only ever changed on the loop.
+ * ============================================================================ */
+
+/* State machine tick */
+#define BT_MANAGE_INTERVAL_MS   100
+
+/* Delay before attempting BT connection after USB disconnect (ms) */
+#define BT_CONNECT_DELAY_MS     1000
+
+/* Enable input without waiting for F4 after this long in READY (ms) */
+#define BT_AUTO_ENABLE_MS       500
+
+/* USB must stay enabled this long before BT is dropped (ms) */
+#define BT_USB_HANDOVER_MS      100
+
+/* Back-off after a connection error (ms) */
+#define BT_ERROR_BACKOFF_MS     5000
+
+/* Wake: connect attempts, their spacing, and how long PS is held (ms) */
+#define BT_WAKE_ATTEMPTS        5
+#define BT_WAKE_RETRY_MS        1500
+#define BT_WAKE_PRESS_MS        150
+
+static reactor_t* g_bt_reactor = NULL;
+static int g_bt_manage_fd = -1;
+static int g_bt_pace_fd = -1;
+static uint16_t g_bt_pace_interval_ms = 0;  /* Period the pace timer runs at */
+static motion_decimator_t g_bt_motion;      /* Motion position of the input stream */
+
+static void bt_socket_handler(int fd, uint32_t events, void* ctx);
+
+static void bt_sockets_attach(void) {
+    if (!g_bt_reactor) return;
+    reactor_add(g_bt_reactor, g_ps3_bt_ctx.ctrl_sock, EPOLLIN, bt_socket_handler, NULL);
+    reactor_add(g_bt_reactor, g_ps3_bt_ctx.intr_sock, EPOLLIN, bt_socket_handler, NULL);
+}
+
+static void bt_sockets_detach(void) {
+    if (!g_bt_reactor) return;
+    reactor_timer_set(g_bt_pace_fd, 0, 0);
+    reactor_del(g_bt_reactor, g_ps3_bt_ctx.ctrl_sock);
+    reactor_del(g_bt_reactor, g_ps3_bt_ctx.intr_sock);
+}
+
+static void bt_pace_arm(uint64_t first_ns, uint16_t interval_ms) {
+    g_bt_pace_interval_ms = interval_ms;
+    reactor_timer_set(g_bt_pace_fd, first_ns, TIME_MS(interval_ms));
+}
+
+/* PS3 accepted us - start streaming input (25Hz by default) on a fixed grid */
+static void bt_set_enabled(void) {
+    g_ps3_bt_ctx.state = BT_STATE_ENABLED;
+    motion_decimator_reset(&g_bt_motion);
+    if (g_bt_pace_fd >= 0) {
+        adapter_config_t config;
+        config_get(&config);
+        bt_pace_arm(time_now_ns(), config.bt_input_interval_ms);
+    }
+}
+
 /* ============================================================================
  * CONTROL CHANNEL PROTOCOL
  * ============================================================================ */
@@ -367,12 +438,10 @@ static int handle_get_report(int sock, uint8_t report_id) {
 static int process_control(void) {
     if (g_ps3_bt_ctx.ctrl_sock < 0) return -1;
     
-    struct pollfd pfd = {.fd = g_ps3_bt_ctx.ctrl_sock, .events = POLLIN};
-    if (poll(&pfd, 1, 0) <= 0) return 0;
-    
     uint8_t buf[128];
     ssize_t n = recv(g_ps3_bt_ctx.ctrl_sock, buf, sizeof(buf), MSG_DONTWAIT);
-    if (n <= 0) return (errno == EAGAIN) ? 0 : -1;
+    if (n == 0) return -1;  /* Closed by PS3 */
+    if (n < 0) return (errno == EAGAIN) ? 0 : -1;
     
     uint8_t trans = buf[0];
     
@@ -387,7 +456,7 @@ static int process_control(void) {
         }
         else if (report_id == 0xF4) {
             printf("[BT] *** Received F4 ENABLE ***\n");
-            g_ps3_bt_ctx.state = BT_STATE_ENABLED;
+            bt_set_enabled();
         }
         
         uint8_t ack = 0x00;
@@ -401,22 +470,27 @@ static int process_control(void) {
  * INTERRUPT CHANNEL
  * ============================================================================ */
 
-static uint64_t g_last_send_time = 0;
-
-static int send_input(void) {
+static int send_input(const adapter_config_t* config) {
     if (g_ps3_bt_ctx.state != BT_STATE_ENABLED || g_ps3_bt_ctx.intr_sock < 0) {
         return -1;
     }
     
-    uint64_t now = time_get_ms();
-    if (now - g_last_send_time < 40) return 0;  /* 25Hz */
+    uint64_t now = time_now_ns();
     
-    /* Get current controller state and build DS3 report */
+    /* Get current controller state and build DS3 report. Motion is the
+     * mean over the interval since the previous report, so the PS3 sees
+     * all of it rather than whichever sample is current every 40ms. */
     controller_state_t state;
     controller_state_copy(&state);
+    if (config->motion_filter) {
+        motion_decimate_state(&g_bt_motion, &state, now);
+    } else {
+        motion_align_state(&state, now);
+    }
     
     uint8_t ds3_report[DS3_INPUT_REPORT_SIZE];
     ds3_build_input_report(&state, ds3_report);
+    uint64_t built_time = time_now_ns();
     
     /* Build BT report */
     uint8_t report[DS3_BT_INPUT_REPORT_SIZE];
@@ -428,7 +502,7 @@ static int send_input(void) {
     report[32] = DS3_CONN_BT;
     
     ssize_t sent = send(g_ps3_bt_ctx.intr_sock, report, sizeof(report), MSG_DONTWAIT | MSG_NOSIGNAL);
-    g_last_send_time = now;
+    g_ps3_bt_ctx.last_send_time = now;
     
     if (sent < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -439,18 +513,21 @@ static int send_input(void) {
     }
     
     g_ps3_bt_ctx.packets_sent++;
+    
+    uint64_t sent_time = time_now_ns();
+    latency_record_span(LAT_BT_BUILD, state.publish_time_ns, built_time);
+    latency_record(LAT_BT_SEND, sent_time - built_time);
+    latency_record_span(LAT_BT_AGE, state.rx_time_ns, sent_time);
     return 0;
 }
 
 static int process_interrupt(void) {
     if (g_ps3_bt_ctx.intr_sock < 0) return -1;
     
-    struct pollfd pfd = {.fd = g_ps3_bt_ctx.intr_sock, .events = POLLIN};
-    if (poll(&pfd, 1, 0) <= 0) return 0;
-    
     uint8_t buf[64];
     ssize_t n = recv(g_ps3_bt_ctx.intr_sock, buf, sizeof(buf), MSG_DONTWAIT);
-    if (n <= 0) return (errno == EAGAIN) ? 0 : -1;
+    if (n == 0) return -1;  /* Closed by PS3 */
+    if (n < 0) return (errno == EAGAIN) ? 0 : -1;
     
     /* Handle rumble from PS3 */
     if (n >= 7 && buf[0] == BT_HIDP_DATA_RTYPE_OUTPUT && buf[1] == 0x01) {
@@ -478,70 +555,6 @@ int ps3_bt_init(void) {
     return 0;
 }
 
-int ps3_bt_connect(void) {
-    /* Try to get PS3 MAC from USB handshake first */
-    if (!g_ps3_bt_ctx.ps3_addr_valid && ds3_has_ps3_mac()) {
-        uint8_t mac[6];
-        ds3_get_ps3_mac(mac);
-        
-        g_ps3_bt_ctx.ps3_addr.b[5] = mac[0];
-        g_ps3_bt_ctx.ps3_addr.b[4] = mac[1];
-        g_ps3_bt_ctx.ps3_addr.b[3] = mac[2];
-        g_ps3_bt_ctx.ps3_addr.b[2] = mac[3];
-        g_ps3_bt_ctx.ps3_addr.b[1] = mac[4];
-        g_ps3_bt_ctx.ps3_addr.b[0] = mac[5];
-        g_ps3_bt_ctx.ps3_addr_valid = 1;
-        
-        ps3_bt_save_addr();
-    }
-    
-    if (!g_ps3_bt_ctx.ps3_addr_valid) {
-        if (ps3_bt_scan(8) < 0) return -1;
-    }
-    
-    if (g_ps3_bt_ctx.state != BT_STATE_DISCONNECTED) return -1;
-    
-    g_ps3_bt_ctx.state = BT_STATE_CONNECTING;
-    
-    g_ps3_bt_ctx.ctrl_sock = create_l2cap_socket(L2CAP_PSM_HID_CONTROL, &g_ps3_bt_ctx.ps3_addr);
-    if (g_ps3_bt_ctx.ctrl_sock < 0) {
-        g_ps3_bt_ctx.state = BT_STATE_ERROR;
-        return -1;
-    }
-    
-    usleep(20000);
-    
-    g_ps3_bt_ctx.intr_sock = create_l2cap_socket(L2CAP_PSM_HID_INTERRUPT, &g_ps3_bt_ctx.ps3_addr);
-    if (g_ps3_bt_ctx.intr_sock < 0) {
-        close(g_ps3_bt_ctx.ctrl_sock);
-        g_ps3_bt_ctx.ctrl_sock = -1;
-        g_ps3_bt_ctx.state = BT_STATE_ERROR;
-        return -1;
-    }
-    
-    g_ps3_bt_ctx.state = BT_STATE_READY;
-    g_ps3_bt_ctx.connect_time = time_get_ms();
-    
-    printf("[BT] Connected to PS3\n");
-    
-    /* Send initial reports */
-    controller_state_t state;
-    controller_state_copy(&state);
-    uint8_t ds3_report[DS3_INPUT_REPORT_SIZE];
-    ds3_build_input_report(&state, ds3_report);
-    
-    uint8_t init_report[DS3_BT_INPUT_REPORT_SIZE];
-    init_report[0] = BT_HIDP_DATA_RTYPE_INPUT;
-    memcpy(&init_report[1], ds3_report, DS3_INPUT_REPORT_SIZE);
-    
-    for (int i = 0; i < 3; i++) {
-        send(g_ps3_bt_ctx.intr_sock, init_report, sizeof(init_report), MSG_NOSIGNAL);
-        usleep(20000);
-    }
-    
-    return 0;
-}
-
 void ps3_bt_disconnect(void) {
     if (g_ps3_bt_ctx.state == BT_STATE_DISCONNECTED) {
         return;  /* Already disconnected */
@@ -556,6 +569,8 @@ void ps3_bt_disconnect(void) {
     output.rumble_right = 0;
     controller_output_update(&output);
     
+    bt_sockets_detach();
+    
     if (g_ps3_bt_ctx.intr_sock >= 0) {
         close(g_ps3_bt_ctx.intr_sock);
         g_ps3_bt_ctx.intr_sock = -1;
@@ -577,162 +592,358 @@ bt_state_t ps3_bt_get_state(void) {
     return g_ps3_bt_ctx.state;
 }
 
-int ps3_bt_wake(void) {
-    printf("[BT] Attempting to wake PS3...\n");
+/* ============================================================================
+ * EVENT HANDLERS
+ * ============================================================================ */
+
+static int g_bt_connect_requested = 0;
+static uint64_t g_bt_retry_after = 0;       /* Coarse monotonic ns */
+
+/* Held from starting a connect until its result is handled: at most one at a time */
+static int g_bt_connecting = 0;
+static int g_bt_connected_fd = -1;
+
+/* The worker's job; it owns this and the sockets until it signals g_bt_connected_fd */
+static struct {
+    bdaddr_t addr;
+    int addr_valid;
+    int addr_found;             /* addr came from an inquiry */
+    int ctrl_sock;
+    int intr_sock;
+} g_bt_job;
+
+static void* bt_connect_worker(void* arg) {
+    (void)arg;
     
-    for (int attempt = 0; attempt < 5; attempt++) {
-        if (g_ps3_bt_ctx.state == BT_STATE_ERROR) {
-            ps3_bt_disconnect();
+    g_bt_job.ctrl_sock = -1;
+    g_bt_job.intr_sock = -1;
+    g_bt_job.addr_found = 0;
+    if (!g_bt_job.addr_valid) {
+        g_bt_job.addr_found = bt_scan(8, &g_bt_job.addr) == 0;
+        g_bt_job.addr_valid = g_bt_job.addr_found;
+    }
+    
+    if (g_bt_job.addr_valid) {
+        g_bt_job.ctrl_sock = create_l2cap_socket(L2CAP_PSM_HID_CONTROL, &g_bt_job.addr);
+    }
+    if (g_bt_job.ctrl_sock >= 0) {
+        usleep(20000);
+        g_bt_job.intr_sock = create_l2cap_socket(L2CAP_PSM_HID_INTERRUPT, &g_bt_job.addr);
+        if (g_bt_job.intr_sock < 0) {
+            close(g_bt_job.ctrl_sock);
+            g_bt_job.ctrl_sock = -1;
         }
+    }
+    
+    /* Send initial reports */
+    if (g_bt_job.intr_sock >= 0) {
+        controller_state_t state;
+        controller_state_copy(&state);
+        uint8_t ds3_report[DS3_INPUT_REPORT_SIZE];
+        ds3_build_input_report(&state, ds3_report);
         
-        if (g_ps3_bt_ctx.state == BT_STATE_DISCONNECTED) {
-            if (ps3_bt_connect() == 0) break;
+        uint8_t init_report[DS3_BT_INPUT_REPORT_SIZE];
+        init_report[0] = BT_HIDP_DATA_RTYPE_INPUT;
+        memcpy(&init_report[1], ds3_report, DS3_INPUT_REPORT_SIZE);
+        
+        for (int i = 0; i < 3; i++) {
+            send(g_bt_job.intr_sock, init_report, sizeof(init_report), MSG_NOSIGNAL);
+            usleep(20000);
         }
+    }
+    
+    reactor_event_signal(g_bt_connected_fd);    /* -> bt_connected_handler() */
+    return NULL;
+}
+
+/* Start connecting unless a connect is already running. Control loop. */
+static void bt_connect_async(void) {
+    if (__atomic_exchange_n(&g_bt_connecting, 1, __ATOMIC_ACQ_REL)) return;
+    
+    /* Try to get PS3 MAC from USB handshake first */
+    if (!g_ps3_bt_ctx.ps3_addr_valid && ds3_has_ps3_mac()) {
+        uint8_t mac[6];
+        ds3_get_ps3_mac(mac);
+        
+        g_ps3_bt_ctx.ps3_addr.b[5] = mac[0];
+        g_ps3_bt_ctx.ps3_addr.b[4] = mac[1];
+        g_ps3_bt_ctx.ps3_addr.b[3] = mac[2];
+        g_ps3_bt_ctx.ps3_addr.b[2] = mac[3];
+        g_ps3_bt_ctx.ps3_addr.b[1] = mac[4];
+        g_ps3_bt_ctx.ps3_addr.b[0] = mac[5];
+        g_ps3_bt_ctx.ps3_addr_valid = 1;
         
-        usleep(1500000);
+        ps3_bt_save_addr();
     }
     
-    if (g_ps3_bt_ctx.intr_sock < 0) return -1;
+    bacpy(&g_bt_job.addr, &g_ps3_bt_ctx.ps3_addr);
+    g_bt_job.addr_valid = g_ps3_bt_ctx.ps3_addr_valid;
+    g_ps3_bt_ctx.state = g_bt_job.addr_valid ? BT_STATE_CONNECTING : BT_STATE_SCANNING;
+    
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
     
-    /* Send PS button press */
+    if (pthread_create(&tid, &attr, bt_connect_worker, NULL) != 0) {
+        perror("[BT] Failed to start connect worker");
+        g_ps3_bt_ctx.state = BT_STATE_DISCONNECTED;
+        __atomic_store_n(&g_bt_connecting, 0, __ATOMIC_RELEASE);
+    }
+    
+    pthread_attr_destroy(&attr);
+}
+
+/*
+ * Wake: connect (up to BT_WAKE_ATTEMPTS, BT_WAKE_RETRY_MS apart), then press
+ * and release PS. Timer driven on the control loop; ps3_bt_wake() starts it.
+ */
+
+typedef enum {
+    BT_WAKE_IDLE = 0,
+    BT_WAKE_CONNECT,            /* Waiting for a connection */
+    BT_WAKE_RELEASE             /* PS pressed, release it next */
+} bt_wake_step_t;
+
+static int g_bt_wake_request_fd = -1;
+static int g_bt_wake_timer_fd = -1;
+static bt_wake_step_t g_bt_wake_step = BT_WAKE_IDLE;
+static int g_bt_wake_attempts = 0;
+
+static void bt_send_wake_report(uint8_t buttons) {
     uint8_t wake_report[DS3_BT_INPUT_REPORT_SIZE] = {0};
     wake_report[0] = BT_HIDP_DATA_RTYPE_INPUT;
     wake_report[1] = 0x01;
-    wake_report[5] = DS3_BTN_PS;
+    wake_report[5] = buttons;
     wake_report[7] = 0x80;
     wake_report[8] = 0x80;
     wake_report[9] = 0x80;
     wake_report[10] = 0x80;
     
-    send(g_ps3_bt_ctx.intr_sock, wake_report, sizeof(wake_report), 0);
-    usleep(150000);
+    send(g_ps3_bt_ctx.intr_sock, wake_report, sizeof(wake_report), MSG_NOSIGNAL);
+}
+
+static void bt_wake_step(void) {
+    switch (g_bt_wake_step) {
+        case BT_WAKE_CONNECT:
+            if (g_ps3_bt_ctx.state >= BT_STATE_READY && g_ps3_bt_ctx.intr_sock >= 0) {
+                bt_send_wake_report(DS3_BTN_PS);
+                g_bt_wake_step = BT_WAKE_RELEASE;
+                reactor_timer_set(g_bt_wake_timer_fd, time_deadline_in(TIME_MS(BT_WAKE_PRESS_MS)), 0);
+                break;
+            }
+            
+            if (g_bt_wake_attempts++ >= BT_WAKE_ATTEMPTS) {
+                printf("[BT] Wake failed: no connection to PS3\n");
+                g_bt_wake_step = BT_WAKE_IDLE;
+                break;
+            }
+            
+            if (g_ps3_bt_ctx.state == BT_STATE_ERROR) {
+                ps3_bt_disconnect();
+            }
+            if (g_ps3_bt_ctx.state == BT_STATE_DISCONNECTED) {
+                bt_connect_async();
+            }
+            reactor_timer_set(g_bt_wake_timer_fd, time_deadline_in(TIME_MS(BT_WAKE_RETRY_MS)), 0);
+            break;
+            
+        case BT_WAKE_RELEASE:
+            if (g_ps3_bt_ctx.intr_sock >= 0) {
+                bt_send_wake_report(0);
+                printf("[BT] Wake signal sent\n");
+            }
+            g_bt_wake_step = BT_WAKE_IDLE;
+            break;
+            
+        default:
+            break;
+    }
+}
+
+static void bt_wake_request_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    if (reactor_event_read(fd) == 0) return;
+    if (g_bt_wake_step != BT_WAKE_IDLE) return;     /* Already waking */
     
-    wake_report[5] = 0;
-    send(g_ps3_bt_ctx.intr_sock, wake_report, sizeof(wake_report), 0);
+    printf("[BT] Attempting to wake PS3...\n");
+    g_bt_wake_step = BT_WAKE_CONNECT;
+    g_bt_wake_attempts = 0;
+    bt_wake_step();
+}
+
+static void bt_wake_timer_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
     
-    printf("[BT] Wake signal sent\n");
-    return 0;
+    if (reactor_timer_read(fd) == 0) return;
+    bt_wake_step();
 }
 
-/* ============================================================================
- * THREAD FUNCTIONS
- * ============================================================================ */
+int ps3_bt_wake(void) {
+    if (g_bt_wake_request_fd < 0) return -1;
+    reactor_event_signal(g_bt_wake_request_fd);    /* -> bt_wake_request_handler() */
+    return 0;
+}
 
-void* ps3_bt_thread(void* arg) {
-    (void)arg;
-    printf("[BT] Management thread started\n");
+/* Connect worker finished: take over its sockets */
+static void bt_connected_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
     
-    int connect_requested = 0;
-    int was_usb_connected = 0;
-    uint64_t usb_disconnect_time = 0;
+    if (reactor_event_read(fd) == 0) return;
     
-    /* Delay before attempting BT connection after USB disconnect (ms) */
-    #define BT_CONNECT_DELAY_MS 1000
+    if (g_bt_job.addr_found) {
+        bacpy(&g_ps3_bt_ctx.ps3_addr, &g_bt_job.addr);
+        g_ps3_bt_ctx.ps3_addr_valid = 1;
+        ps3_bt_save_addr();
+    }
     
-    while (g_running) {
-        if (system_is_standby()) {
-            usleep(100000);
-            continue;
-        }
-        
-        switch (g_ps3_bt_ctx.state) {
-            case BT_STATE_DISCONNECTED:
-                if (g_usb_enabled) {
-                    was_usb_connected = 1;
-                    usb_disconnect_time = 0;
-                }
-                
-                /* Track when USB disconnected */
-                if (was_usb_connected && !g_usb_enabled && usb_disconnect_time == 0) {
-                    usb_disconnect_time = time_get_ms();
-                }
-                
-                /* Connect after USB has been disconnected for a while */
-                if (was_usb_connected && !g_usb_enabled && !connect_requested && 
-                    ds3_has_ps3_mac() && usb_disconnect_time > 0) {
-                    
-                    uint64_t elapsed = time_get_ms() - usb_disconnect_time;
-                    if (elapsed >= BT_CONNECT_DELAY_MS) {
-                        if (!system_is_standby() && ps3_bt_connect() == 0) {
-                            connect_requested = 1;
-                        }
-                    }
-                }
-                usleep(100000);
-                break;
-                
-            case BT_STATE_READY:
-            case BT_STATE_ENABLED:
-                /* Auto-enable after timeout */
-                if (g_ps3_bt_ctx.state == BT_STATE_READY) {
-                    static int ready_count = 0;
-                    if (++ready_count >= 50) {
-                        g_ps3_bt_ctx.state = BT_STATE_ENABLED;
-                        ready_count = 0;
-                    }
-                }
-                
-                if (process_control() < 0 || process_interrupt() < 0) {
-                    ps3_bt_disconnect();
-                    connect_requested = 0;
-                    continue;
-                }
-                usleep(10000);
-                break;
-                
-            case BT_STATE_ERROR:
-                ps3_bt_disconnect();
-                connect_requested = 0;
-                sleep(5);
-                break;
-                
-            default:
-                usleep(100000);
-                break;
-        }
+    if ((g_ps3_bt_ctx.state != BT_STATE_CONNECTING && g_ps3_bt_ctx.state != BT_STATE_SCANNING) ||
+        system_is_standby()) {
+        /* Disconnected (standby, USB took over) while the worker ran */
+        if (g_bt_job.intr_sock >= 0) close(g_bt_job.intr_sock);
+        if (g_bt_job.ctrl_sock >= 0) close(g_bt_job.ctrl_sock);
+    } else if (g_bt_job.intr_sock < 0) {
+        /* No PS3 found is not an error: retried without back-off, as before */
+        g_ps3_bt_ctx.state = g_bt_job.addr_valid ? BT_STATE_ERROR : BT_STATE_DISCONNECTED;
+    } else {
+        g_ps3_bt_ctx.ctrl_sock = g_bt_job.ctrl_sock;
+        g_ps3_bt_ctx.intr_sock = g_bt_job.intr_sock;
+        g_ps3_bt_ctx.state = BT_STATE_READY;
+        g_ps3_bt_ctx.connect_time = time_now_coarse_ns();
+        g_bt_connect_requested = 1;
         
-        /* Disconnect BT if USB reconnects (with hysteresis) */
-        if (g_usb_enabled && g_ps3_bt_ctx.state >= BT_STATE_READY) {
-            /* Wait a bit to make sure USB is stable before disconnecting BT */
-            static int usb_stable_count = 0;
-            usb_stable_count++;
-            
-            if (usb_stable_count >= 10) {  /* 100ms at 10ms loop rate */
-                printf("[BT] USB reconnected, disconnecting BT\n");
-                ps3_bt_disconnect();
-                connect_requested = 0;
+        printf("[BT] Connected to PS3\n");
+        bt_sockets_attach();
+    }
+    
+    __atomic_store_n(&g_bt_connecting, 0, __ATOMIC_RELEASE);
+    
+    /* A pending wake needn't sit out its retry timer */
+    if (g_bt_wake_step == BT_WAKE_CONNECT && g_ps3_bt_ctx.state == BT_STATE_READY) {
+        bt_wake_step();
+    }
+}
+
+static void bt_socket_handler(int fd, uint32_t events, void* ctx) {
+    (void)ctx;
+    
+    int ret = (fd == g_ps3_bt_ctx.ctrl_sock) ? process_control() : process_interrupt();
+    
+    if (ret < 0 || (events & (EPOLLERR | EPOLLHUP))) {
+        ps3_bt_disconnect();
+        g_bt_connect_requested = 0;
+    }
+}
+
+static void bt_pace_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    /* Missed periods are simply skipped - the grid keeps its phase */
+    if (reactor_timer_read(fd) == 0) return;
+    if (system_is_standby()) return;
+    
+    adapter_config_t config;
+    config_get(&config);
+    send_input(&config);
+    
+    /* Interval changed at runtime: continue the grid from this report */
+    if (config.bt_input_interval_ms != g_bt_pace_interval_ms) {
+        bt_pace_arm(time_now_ns() + TIME_MS(config.bt_input_interval_ms),
+                    config.bt_input_interval_ms);
+    }
+}
+
+static void bt_manage_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    static int was_usb_connected = 0;
+    static uint64_t usb_disconnect_time = 0;
+    static uint64_t usb_enabled_since = 0;
+    
+    if (reactor_timer_read(fd) == 0) return;
+    if (system_is_standby()) return;
+    
+    uint64_t now = time_now_coarse_ns();
+    
+    switch (g_ps3_bt_ctx.state) {
+        case BT_STATE_DISCONNECTED:
+            if (g_usb_enabled) {
                 was_usb_connected = 1;
-                usb_stable_count = 0;
+                usb_disconnect_time = 0;
             }
-        } else {
-            /* Reset counter if USB not enabled */
-            static int usb_stable_count = 0;
-            usb_stable_count = 0;
-        }
+            
+            /* Track when USB disconnected */
+            if (was_usb_connected && !g_usb_enabled && usb_disconnect_time == 0) {
+                usb_disconnect_time = now;
+            }
+            
+            /* Connect after USB has been disconnected for a while */
+            if (was_usb_connected && !g_usb_enabled && !g_bt_connect_requested && 
+                ds3_has_ps3_mac() && usb_disconnect_time > 0 &&
+                now - usb_disconnect_time >= TIME_MS(BT_CONNECT_DELAY_MS) &&
+                now >= g_bt_retry_after) {
+                bt_connect_async();
+            }
+            break;
+            
+        case BT_STATE_READY:
+            /* Auto-enable after timeout */
+            if (now - g_ps3_bt_ctx.connect_time >= TIME_MS(BT_AUTO_ENABLE_MS)) {
+                bt_set_enabled();
+            }
+            break;
+            
+        case BT_STATE_ERROR:
+            ps3_bt_disconnect();
+            g_bt_connect_requested = 0;
+            g_bt_retry_after = now + TIME_MS(BT_ERROR_BACKOFF_MS);
+            break;
+            
+        default:
+            break;
     }
     
-    ps3_bt_disconnect();
-    printf("[BT] Management thread exiting\n");
-    return NULL;
+    /* Disconnect BT if USB reconnects (with hysteresis) */
+    if (g_usb_enabled && g_ps3_bt_ctx.state >= BT_STATE_READY) {
+        /* Wait a bit to make sure USB is stable before disconnecting BT */
+        if (usb_enabled_since == 0) {
+            usb_enabled_since = now;
+        } else if (now - usb_enabled_since >= TIME_MS(BT_USB_HANDOVER_MS)) {
+            printf("[BT] USB reconnected, disconnecting BT\n");
+            ps3_bt_disconnect();
+            g_bt_connect_requested = 0;
+            was_usb_connected = 1;
+            usb_enabled_since = 0;
+        }
+    } else {
+        usb_enabled_since = 0;
+    }
 }
 
-void* ps3_bt_motion_thread(void* arg) {
-    (void)arg;
-    printf("[BT] Motion thread started\n");
+int ps3_bt_attach(reactor_t* r) {
+    g_bt_manage_fd = reactor_timer_create();
+    g_bt_pace_fd = reactor_timer_create();
+    g_bt_wake_timer_fd = reactor_timer_create();
+    g_bt_connected_fd = reactor_event_create();
+    g_bt_wake_request_fd = reactor_event_create();
+    if (g_bt_manage_fd < 0 || g_bt_pace_fd < 0 || g_bt_wake_timer_fd < 0 ||
+        g_bt_connected_fd < 0 || g_bt_wake_request_fd < 0) {
+        return -1;
+    }
     
-    while (g_running) {
-        if (system_is_standby()) {
-            usleep(100000);
-            continue;
-        }
-        
-        if (g_ps3_bt_ctx.state == BT_STATE_ENABLED) {
-            send_input();
-        }
-        
-        usleep(500);  /* Fast poll for responsive input */
+    if (reactor_add(r, g_bt_manage_fd, EPOLLIN, bt_manage_handler, NULL) < 0 ||
+        reactor_add(r, g_bt_pace_fd, EPOLLIN, bt_pace_handler, NULL) < 0 ||
+        reactor_add(r, g_bt_wake_timer_fd, EPOLLIN, bt_wake_timer_handler, NULL) < 0 ||
+        reactor_add(r, g_bt_connected_fd, EPOLLIN, bt_connected_handler, NULL) < 0 ||
+        reactor_add(r, g_bt_wake_request_fd, EPOLLIN, bt_wake_request_handler, NULL) < 0) {
+        return -1;
     }
     
-    printf("[BT] Motion thread exiting\n");
-    return NULL;
-}
\ No newline at end of file
+    g_bt_reactor = r;
+    reactor_timer_set(g_bt_manage_fd, time_deadline_in(TIME_MS(BT_MANAGE_INTERVAL_MS)),
+                      TIME_MS(BT_MANAGE_INTERVAL_MS));
+    
+    printf("[BT] Attached to %s loop\n", r->name);
+    return 0;
+}
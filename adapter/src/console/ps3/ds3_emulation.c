@@ -11,6 +11,7 @@
 
 #include "core/common.h"
 #include "console/ps3/ds3_emulation.h"
+#include "console/ps3/ds3_transcode.h"
 
 /* ============================================================================
  * DS3 INPUT REPORT STATE
@@ -51,7 +52,7 @@ static uint8_t g_ds3_report[DS3_INPUT_REPORT_SIZE] = {
     0x94, 0x00, /* [46-47] Gyro Z */
     0x02        /* [48] Final byte */
 };
-static pthread_mutex_t g_ds3_report_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t g_ds3_report_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* ============================================================================
  * DS3 FEATURE REPORTS
@@ -138,6 +139,7 @@ static int g_ps3_mac_valid = 0;
  * ============================================================================ */
 
 void ds3_init(void) {
+    ds3_transcode_init();
     printf("[DS3] Emulation layer initialized\n");
 }
 
@@ -236,90 +238,140 @@ void ds3_handle_set_report(uint8_t report_id, const uint8_t* data, size_t len) {
  * INPUT REPORT TRANSLATION
  * 
  * This is the core translation function - converts generic controller state
- * to DS3-specific input report format.
+ * to DS3-specific input report format. The encoders below are also what
+ * console/ps3/ds3_transcode.c builds its lookup tables from.
  * ============================================================================ */
 
-void ds3_build_input_report(const controller_state_t* state, uint8_t* out_report) {
-    /* Start with template */
-    memset(out_report, 0, DS3_INPUT_REPORT_SIZE);
-    out_report[0] = 0x01;  /* Report ID */
+void ds3_encode_buttons(uint32_t buttons, uint8_t* out_report) {
+    #define PRESSED(btn) (buttons & (1u << (btn)))
     
     /* --- Buttons1 (byte 2) --- */
     uint8_t btn1 = 0;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_SELECT))     btn1 |= DS3_BTN_SELECT;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_L3))         btn1 |= DS3_BTN_L3;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_R3))         btn1 |= DS3_BTN_R3;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_START))      btn1 |= DS3_BTN_START;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_DPAD_UP))    btn1 |= DS3_BTN_DPAD_UP;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_DPAD_RIGHT)) btn1 |= DS3_BTN_DPAD_RIGHT;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_DPAD_DOWN))  btn1 |= DS3_BTN_DPAD_DOWN;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_DPAD_LEFT))  btn1 |= DS3_BTN_DPAD_LEFT;
+    if (PRESSED(BTN_SELECT))     btn1 |= DS3_BTN_SELECT;
+    if (PRESSED(BTN_L3))         btn1 |= DS3_BTN_L3;
+    if (PRESSED(BTN_R3))         btn1 |= DS3_BTN_R3;
+    if (PRESSED(BTN_START))      btn1 |= DS3_BTN_START;
+    if (PRESSED(BTN_DPAD_UP))    btn1 |= DS3_BTN_DPAD_UP;
+    if (PRESSED(BTN_DPAD_RIGHT)) btn1 |= DS3_BTN_DPAD_RIGHT;
+    if (PRESSED(BTN_DPAD_DOWN))  btn1 |= DS3_BTN_DPAD_DOWN;
+    if (PRESSED(BTN_DPAD_LEFT))  btn1 |= DS3_BTN_DPAD_LEFT;
     out_report[DS3_OFF_BUTTONS1] = btn1;
     
     /* --- Buttons2 (byte 3) --- */
     uint8_t btn2 = 0;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_L2))    btn2 |= DS3_BTN_L2;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_R2))    btn2 |= DS3_BTN_R2;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_L1))    btn2 |= DS3_BTN_L1;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_R1))    btn2 |= DS3_BTN_R1;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_NORTH)) btn2 |= DS3_BTN_TRIANGLE;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_EAST))  btn2 |= DS3_BTN_CIRCLE;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_SOUTH)) btn2 |= DS3_BTN_CROSS;
-    if (CONTROLLER_BTN_PRESSED(state, BTN_WEST))  btn2 |= DS3_BTN_SQUARE;
+    if (PRESSED(BTN_L2))    btn2 |= DS3_BTN_L2;
+    if (PRESSED(BTN_R2))    btn2 |= DS3_BTN_R2;
+    if (PRESSED(BTN_L1))    btn2 |= DS3_BTN_L1;
+    if (PRESSED(BTN_R1))    btn2 |= DS3_BTN_R1;
+    if (PRESSED(BTN_NORTH)) btn2 |= DS3_BTN_TRIANGLE;
+    if (PRESSED(BTN_EAST))  btn2 |= DS3_BTN_CIRCLE;
+    if (PRESSED(BTN_SOUTH)) btn2 |= DS3_BTN_CROSS;
+    if (PRESSED(BTN_WEST))  btn2 |= DS3_BTN_SQUARE;
     out_report[DS3_OFF_BUTTONS2] = btn2;
     
     /* --- PS Button (byte 4) --- */
-    out_report[DS3_OFF_PS_BUTTON] = CONTROLLER_BTN_PRESSED(state, BTN_HOME) ? DS3_BTN_PS : 0;
-    
-    /* --- Analog Sticks (bytes 6-9) --- */
-    out_report[DS3_OFF_LX] = state->left_stick_x;
-    out_report[DS3_OFF_LY] = state->left_stick_y;
-    out_report[DS3_OFF_RX] = state->right_stick_x;
-    out_report[DS3_OFF_RY] = state->right_stick_y;
+    out_report[DS3_OFF_PS_BUTTON] = PRESSED(BTN_HOME) ? DS3_BTN_PS : 0;
     
     /* --- D-pad Pressure (bytes 10-13) --- */
-    out_report[10] = CONTROLLER_BTN_PRESSED(state, BTN_DPAD_UP)    ? 0xFF : 0x00;
-    out_report[11] = CONTROLLER_BTN_PRESSED(state, BTN_DPAD_RIGHT) ? 0xFF : 0x00;
-    out_report[12] = CONTROLLER_BTN_PRESSED(state, BTN_DPAD_DOWN)  ? 0xFF : 0x00;
-    out_report[13] = CONTROLLER_BTN_PRESSED(state, BTN_DPAD_LEFT)  ? 0xFF : 0x00;
-    
-    /* --- Trigger Pressure (bytes 18-19) --- */
-    out_report[DS3_OFF_L2_PRESSURE] = state->left_trigger;
-    out_report[DS3_OFF_R2_PRESSURE] = state->right_trigger;
+    out_report[10] = PRESSED(BTN_DPAD_UP)    ? 0xFF : 0x00;
+    out_report[11] = PRESSED(BTN_DPAD_RIGHT) ? 0xFF : 0x00;
+    out_report[12] = PRESSED(BTN_DPAD_DOWN)  ? 0xFF : 0x00;
+    out_report[13] = PRESSED(BTN_DPAD_LEFT)  ? 0xFF : 0x00;
     
     /* --- Shoulder Pressure (bytes 20-21) --- */
-    out_report[20] = CONTROLLER_BTN_PRESSED(state, BTN_L1) ? 0xFF : 0x00;
-    out_report[21] = CONTROLLER_BTN_PRESSED(state, BTN_R1) ? 0xFF : 0x00;
+    out_report[20] = PRESSED(BTN_L1) ? 0xFF : 0x00;
+    out_report[21] = PRESSED(BTN_R1) ? 0xFF : 0x00;
     
     /* --- Face Button Pressure (bytes 22-25) --- */
-    out_report[22] = CONTROLLER_BTN_PRESSED(state, BTN_NORTH) ? 0xFF : 0x00;  /* Triangle */
-    out_report[23] = CONTROLLER_BTN_PRESSED(state, BTN_EAST)  ? 0xFF : 0x00;  /* Circle */
-    out_report[24] = CONTROLLER_BTN_PRESSED(state, BTN_SOUTH) ? 0xFF : 0x00;  /* Cross */
-    out_report[25] = CONTROLLER_BTN_PRESSED(state, BTN_WEST)  ? 0xFF : 0x00;  /* Square */
+    out_report[22] = PRESSED(BTN_NORTH) ? 0xFF : 0x00;  /* Triangle */
+    out_report[23] = PRESSED(BTN_EAST)  ? 0xFF : 0x00;  /* Circle */
+    out_report[24] = PRESSED(BTN_SOUTH) ? 0xFF : 0x00;  /* Cross */
+    out_report[25] = PRESSED(BTN_WEST)  ? 0xFF : 0x00;  /* Square */
     
-    /* --- Battery Status (bytes 29-31) --- */
+    #undef PRESSED
+}
+
+uint8_t ds3_encode_battery(const controller_state_t* state) {
     /* Convert generic battery level to DS3 format */
-    uint8_t ds3_battery;
     if (state->battery_full) {
-        ds3_battery = DS3_BATTERY_CHARGED;  /* 0xEF = fully charged */
+        return DS3_BATTERY_CHARGED;  /* 0xEF = fully charged */
     } else if (state->battery_charging) {
-        ds3_battery = DS3_BATTERY_CHARGING;  /* 0xEE = charging */
+        return DS3_BATTERY_CHARGING;  /* 0xEE = charging */
     } else if (state->battery_level <= 5) {
-        ds3_battery = DS3_BATTERY_SHUTDOWN;
+        return DS3_BATTERY_SHUTDOWN;
     } else if (state->battery_level <= 15) {
-        ds3_battery = DS3_BATTERY_DYING;
+        return DS3_BATTERY_DYING;
     } else if (state->battery_level <= 35) {
-        ds3_battery = DS3_BATTERY_LOW;
+        return DS3_BATTERY_LOW;
     } else if (state->battery_level <= 60) {
-        ds3_battery = DS3_BATTERY_MEDIUM;
+        return DS3_BATTERY_MEDIUM;
     } else if (state->battery_level <= 85) {
-        ds3_battery = DS3_BATTERY_HIGH;
-    } else {
-        ds3_battery = DS3_BATTERY_FULL;
+        return DS3_BATTERY_HIGH;
     }
+    return DS3_BATTERY_FULL;
+}
+
+/*
+ * Q16 scales from controller_state_t units to DS3 counts, fixed at build
+ * time (exact for 8192/g and 16 per deg/s: 904 and 34816).
+ */
+#define DS3_ACCEL_SCALE_Q16 ((DS3_ACCEL_COUNTS_PER_G << 16) / CONTROLLER_ACCEL_RES_PER_G)
+#define DS3_GYRO_SCALE_Q16  ((DS3_GYRO_COUNTS_PER_10_DEG_S << 16) / (10 * CONTROLLER_GYRO_RES_PER_DEG_S))
+
+_Static_assert(DS3_ACCEL_SCALE_Q16 * CONTROLLER_ACCEL_RES_PER_G == DS3_ACCEL_COUNTS_PER_G << 16,
+               "DS3 accel scale is not exact in Q16");
+_Static_assert(DS3_GYRO_SCALE_Q16 * 10 * CONTROLLER_GYRO_RES_PER_DEG_S == DS3_GYRO_COUNTS_PER_10_DEG_S << 16,
+               "DS3 gyro scale is not exact in Q16");
+
+/* Scale (rounded), center and clamp one axis, then store it little-endian */
+static inline void encode_motion_axis(int16_t value, int32_t scale, int32_t center, uint8_t* out) {
+    int32_t counts = center + ((value * scale + (1 << 15)) >> 16);
+    if (counts < 0) counts = 0;
+    if (counts > DS3_MOTION_MAX) counts = DS3_MOTION_MAX;
+    out[0] = counts & 0xFF;
+    out[1] = (counts >> 8) & 0xFF;
+}
+
+void ds3_encode_motion(const controller_state_t* state, uint8_t* out_report) {
+    /*
+     * Calibrated motion (controllers/motion_calib.h) is already in the
+     * SIXAXIS frame, and on Bluetooth already averaged over the report
+     * interval (core/motion.h):
+     *   Accel: CONTROLLER_ACCEL_RES_PER_G (8192) units per g
+     *   Gyro:  CONTROLLER_GYRO_RES_PER_DEG_S (16) units per deg/s
+     * 
+     * DS3 motion data: 10-bit unsigned (0-1023), centered at rest
+     *   Accel: 113 counts per g; at rest X=512, Y=512, Z=~400 (gravity)
+     *   Gyro:  8.5 counts per deg/s; at rest Z=~498
+     */
+    encode_motion_axis(state->accel_x, DS3_ACCEL_SCALE_Q16, DS3_ACCEL_CENTER, &out_report[DS3_OFF_ACCEL_X]);
+    encode_motion_axis(state->accel_y, DS3_ACCEL_SCALE_Q16, DS3_ACCEL_CENTER, &out_report[DS3_OFF_ACCEL_Y]);
+    encode_motion_axis(state->accel_z, DS3_ACCEL_SCALE_Q16, DS3_ACCEL_CENTER, &out_report[DS3_OFF_ACCEL_Z]);
+    encode_motion_axis(state->gyro_z, DS3_GYRO_SCALE_Q16, DS3_GYRO_CENTER, &out_report[DS3_OFF_GYRO_Z]);
+}
+
+/* Generic path - any controller */
+static void ds3_build_generic(const controller_state_t* state, uint8_t* out_report) {
+    /* Start with template */
+    memset(out_report, 0, DS3_INPUT_REPORT_SIZE);
+    out_report[0] = 0x01;  /* Report ID */
+    
+    /* --- Buttons and pressure (bytes 2-4, 10-13, 20-25) --- */
+    ds3_encode_buttons(state->buttons, out_report);
     
+    /* --- Analog Sticks (bytes 6-9) --- */
+    out_report[DS3_OFF_LX] = state->left_stick_x;
+    out_report[DS3_OFF_LY] = state->left_stick_y;
+    out_report[DS3_OFF_RX] = state->right_stick_x;
+    out_report[DS3_OFF_RY] = state->right_stick_y;
+    
+    /* --- Trigger Pressure (bytes 18-19) --- */
+    out_report[DS3_OFF_L2_PRESSURE] = state->left_trigger;
+    out_report[DS3_OFF_R2_PRESSURE] = state->right_trigger;
+    
+    /* --- Battery Status (bytes 29-31) --- */
     out_report[DS3_OFF_BATTERY] = DS3_STATUS_PLUGGED;
-    out_report[DS3_OFF_CHARGE] = ds3_battery;
+    out_report[DS3_OFF_CHARGE] = ds3_encode_battery(state);
     out_report[DS3_OFF_CONNECTION] = DS3_CONN_USB;
     
     /* --- Unknown bytes (from real DS3 captures) --- */
@@ -329,54 +381,18 @@ void ds3_build_input_report(const controller_state_t* state, uint8_t* out_report
     out_report[39] = 0x01;
     
     /* --- Motion Data (bytes 40-47) --- */
-    /*
-     * After calibration, DualSense values are normalized:
-     *   Accel: DS_ACC_RES_PER_G (8192) units per g
-     *   Gyro:  DS_GYRO_RES_PER_DEG_S (1024) units per deg/s
-     * 
-     * DS3 motion data: 10-bit unsigned (0-1023), centered at rest
-     *   Accel at rest: X=512, Y=512, Z=~400 (gravity pulls Z down)
-     *   Gyro at rest: Z=~498
-     *
-     * DS3 accel sensitivity is roughly 113 counts per g (from captures)
-     * So: DS3 = 512 + (DualSense / 8192) * 113 = 512 + DualSense / 72
-     *
-     * DS3 gyro sensitivity is roughly 8.5 counts per deg/s
-     * So: DS3 = 498 + (DualSense / 1024) * 8.5 = 498 + DualSense / 120
-     *
-     * Note: Axis orientations may differ - test and adjust signs if needed
-     */
-    
-    /* Convert calibrated accel (8192 per g) to DS3 (113 per g, centered at 512) */
-    int16_t ds3_accel_x = 512 + (state->accel_x / 72);
-    int16_t ds3_accel_y = 512 + (state->accel_y / 72);
-    int16_t ds3_accel_z = 512 + (state->accel_z / 72);
-    
-    /* Convert calibrated gyro (1024 per deg/s) to DS3 (centered at 498) */  
-    int16_t ds3_gyro_z  = 498 + (state->gyro_z / 120);
-    
-    /* Clamp to 10-bit range */
-    if (ds3_accel_x < 0) ds3_accel_x = 0;
-    if (ds3_accel_x > 1023) ds3_accel_x = 1023;
-    if (ds3_accel_y < 0) ds3_accel_y = 0;
-    if (ds3_accel_y > 1023) ds3_accel_y = 1023;
-    if (ds3_accel_z < 0) ds3_accel_z = 0;
-    if (ds3_accel_z > 1023) ds3_accel_z = 1023;
-    if (ds3_gyro_z < 0) ds3_gyro_z = 0;
-    if (ds3_gyro_z > 1023) ds3_gyro_z = 1023;
-    
-    /* Little-endian 16-bit values */
-    out_report[DS3_OFF_ACCEL_X]     = ds3_accel_x & 0xFF;
-    out_report[DS3_OFF_ACCEL_X + 1] = (ds3_accel_x >> 8) & 0xFF;
-    out_report[DS3_OFF_ACCEL_Y]     = ds3_accel_y & 0xFF;
-    out_report[DS3_OFF_ACCEL_Y + 1] = (ds3_accel_y >> 8) & 0xFF;
-    out_report[DS3_OFF_ACCEL_Z]     = ds3_accel_z & 0xFF;
-    out_report[DS3_OFF_ACCEL_Z + 1] = (ds3_accel_z >> 8) & 0xFF;
-    out_report[DS3_OFF_GYRO_Z]      = ds3_gyro_z & 0xFF;
-    out_report[DS3_OFF_GYRO_Z + 1]  = (ds3_gyro_z >> 8) & 0xFF;
+    ds3_encode_motion(state, out_report);
     
     /* --- Final byte --- */
     out_report[48] = 0x02;
+}
+
+void ds3_build_input_report(const controller_state_t* state, uint8_t* out_report) {
+    /* Controller-specific fast path if there is one, else the generic path */
+    if (state->native_format != CONTROLLER_NATIVE_DUALSENSE ||
+        ds3_transcode_dualsense(state, out_report) < 0) {
+        ds3_build_generic(state, out_report);
+    }
     
     /* Update cached report */
     pthread_mutex_lock(&g_ds3_report_mutex);
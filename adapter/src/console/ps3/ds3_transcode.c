@@ -0,0 +1,103 @@
+/*
+ * RosettaPad - DualSense to DS3 Transcoder
+ * =========================================
+ * 
+ * Table-driven fast path, see console/ps3/ds3_transcode.h.
+ */
+
+#include <string.h>
+
+#include "core/common.h"
+#include "controllers/dualsense/dualsense.h"
+#include "console/ps3/ds3_emulation.h"
+#include "console/ps3/ds3_transcode.h"
+
+/* ============================================================================
+ * TABLES
+ * 
+ * The DS3 button encoding is a plain OR of per-button bits and 0xFF
+ * pressure bytes, so the entries for the three DualSense button bytes
+ * can be OR-ed together. Reserved bytes 5 and 14-17 stay zero; bytes
+ * 18-19 (L2/R2 pressure) are overwritten with the analog triggers.
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t buttons;       /* DS3 bytes 2-5 */
+    uint64_t pressure[2];   /* DS3 bytes 10-25 */
+} ds3_button_entry_t;
+
+static ds3_button_entry_t g_buttons1_lut[256];  /* D-pad + face */
+static ds3_button_entry_t g_buttons2_lut[256];  /* Shoulders, sticks, create/options */
+static ds3_button_entry_t g_buttons3_lut[8];    /* PS, touchpad, mute */
+static int g_tables_ready = 0;
+
+/* Everything that doesn't depend on the state */
+static const uint8_t g_report_template[DS3_INPUT_REPORT_SIZE] = {
+    [0]  = 0x01,                    /* Report ID */
+    [DS3_OFF_BATTERY]    = DS3_STATUS_PLUGGED,
+    [DS3_OFF_CONNECTION] = DS3_CONN_USB,
+    [36] = 0x33, [37] = 0x04,       /* Unknown (from real DS3 captures) */
+    [38] = 0x77, [39] = 0x01,
+    [48] = 0x02,                    /* Final byte */
+};
+
+static void build_entry(const uint8_t* native, ds3_button_entry_t* out) {
+    uint8_t report[DS3_INPUT_REPORT_SIZE] = {0};
+    
+    ds3_encode_buttons(dualsense_map_buttons(native), report);
+    
+    memcpy(&out->buttons, &report[DS3_OFF_BUTTONS1], sizeof(out->buttons));
+    memcpy(out->pressure, &report[10], sizeof(out->pressure));
+}
+
+/* buttons1 with the D-pad centered - hat value 0 means "up" */
+#define NEUTRAL_BUTTONS1 0x08
+
+void ds3_transcode_init(void) {
+    for (int v = 0; v < 256; v++) {
+        uint8_t b1[3] = {(uint8_t)v, 0, 0};
+        uint8_t b2[3] = {NEUTRAL_BUTTONS1, (uint8_t)v, 0};
+        build_entry(b1, &g_buttons1_lut[v]);
+        build_entry(b2, &g_buttons2_lut[v]);
+    }
+    for (int v = 0; v < 8; v++) {
+        uint8_t b3[3] = {NEUTRAL_BUTTONS1, 0, (uint8_t)v};
+        build_entry(b3, &g_buttons3_lut[v]);
+    }
+    
+    g_tables_ready = 1;
+}
+
+/* ============================================================================
+ * TRANSCODER
+ * ============================================================================ */
+
+int ds3_transcode_dualsense(const controller_state_t* state, uint8_t* out_report) {
+    if (!g_tables_ready) return -1;
+    
+    const ds3_button_entry_t* e1 = &g_buttons1_lut[state->native_buttons[0]];
+    const ds3_button_entry_t* e2 = &g_buttons2_lut[state->native_buttons[1]];
+    const ds3_button_entry_t* e3 = &g_buttons3_lut[state->native_buttons[2] & 0x07];
+    
+    uint32_t buttons = e1->buttons | e2->buttons | e3->buttons;
+    uint64_t pressure[2] = {
+        e1->pressure[0] | e2->pressure[0] | e3->pressure[0],
+        e1->pressure[1] | e2->pressure[1] | e3->pressure[1],
+    };
+    
+    memcpy(out_report, g_report_template, DS3_INPUT_REPORT_SIZE);
+    memcpy(&out_report[DS3_OFF_BUTTONS1], &buttons, sizeof(buttons));
+    memcpy(&out_report[10], pressure, sizeof(pressure));
+    
+    out_report[DS3_OFF_LX] = state->left_stick_x;
+    out_report[DS3_OFF_LY] = state->left_stick_y;
+    out_report[DS3_OFF_RX] = state->right_stick_x;
+    out_report[DS3_OFF_RY] = state->right_stick_y;
+    out_report[DS3_OFF_L2_PRESSURE] = state->left_trigger;
+    out_report[DS3_OFF_R2_PRESSURE] = state->right_trigger;
+    
+    out_report[DS3_OFF_CHARGE] = ds3_encode_battery(state);
+    ds3_encode_motion(state, out_report);
+    
+    return 0;
+}
@@ -12,10 +12,18 @@
 #include <unistd.h>
 #include <errno.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <linux/aio_abi.h>
 #include <linux/usb/functionfs.h>
 #include <linux/usb/ch9.h>
 
 #include "core/common.h"
+#include "core/cadence.h"
+#include "core/config.h"
+#include "core/latency.h"
+#include "core/motion.h"
+#include "core/rt.h"
 #include "console/ps3/ds3_emulation.h"
 #include "console/ps3/usb_gadget.h"
 
@@ -30,7 +38,7 @@ int g_ep2_fd = -1;
 
 /* Track consecutive suspend events to distinguish real power loss from glitches */
 static int g_suspend_count = 0;
-static uint64_t g_last_enable_time = 0;
+static uint64_t g_last_enable_time = 0;  /* Coarse monotonic ns */
 
 /* Minimum time USB must be enabled before we trust SUSPEND as real standby (ms) */
 #define USB_STABLE_TIME_MS 5000
@@ -38,6 +46,18 @@ static uint64_t g_last_enable_time = 0;
 /* Number of consecutive suspends needed before entering standby */
 #define SUSPEND_THRESHOLD 3
 
+/* ep1 is written from the input thread (run-to-completion) and the
+ * ep1 thread (pacing / keep-alive / AIO completions) - only one write
+ * may be in flight */
+static pthread_mutex_t g_ep1_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile uint64_t g_last_ep1_send_time = 0;  /* Monotonic ns */
+
+/* Host poll cadence learned from ep1 completions. Its own lock, held only
+ * for a few arithmetic steps: the publish slot (input loop, TAS playback)
+ * must never wait behind a blocking ep1 write that holds g_ep1_mutex. */
+static pthread_mutex_t g_ep1_cadence_mutex = PTHREAD_MUTEX_INITIALIZER;
+static cadence_t g_ep1_cadence;
+
 /* ============================================================================
  * USB DESCRIPTORS
  * ============================================================================ */
@@ -286,167 +306,679 @@ void ps3_usb_cleanup(void) {
 }
 
 /* ============================================================================
- * THREAD FUNCTIONS
+ * INPUT REPORT SENDING
  * ============================================================================ */
 
-void* ps3_usb_control_thread(void* arg) {
-    (void)arg;
+/* A built report plus the timestamps needed to account for it */
+typedef struct {
+    uint8_t report[DS3_INPUT_REPORT_SIZE];
+    uint64_t rx_time_ns;
+    uint64_t publish_time_ns;
+    uint64_t built_time_ns;
+} ep1_report_t;
+
+static void ep1_build(const controller_state_t* state, ep1_report_t* out) {
+    /* Motion comes from the sensor-time history, not the last report.
+     * No decimation here: USB polls at about the sensor rate, and reports
+     * are built speculatively (a newer one may replace this one). */
+    controller_state_t aligned = *state;
+    motion_align_state(&aligned, time_now_ns());
     
-    printf("[USB] Control thread started\n");
+    ds3_build_input_report(&aligned, out->report);
+    out->rx_time_ns = state->rx_time_ns;
+    out->publish_time_ns = state->publish_time_ns;
+    out->built_time_ns = time_now_ns();
+}
+
+/* Report left the Pi (write returned / AIO completed) - caller holds g_ep1_mutex */
+static void ep1_account(const ep1_report_t* r, uint64_t sent_time) {
+    g_last_ep1_send_time = sent_time;
+    pthread_mutex_lock(&g_ep1_cadence_mutex);
+    cadence_observe(&g_ep1_cadence, sent_time);
+    pthread_mutex_unlock(&g_ep1_cadence_mutex);
+    latency_record_span(LAT_USB_BUILD, r->publish_time_ns, r->built_time_ns);
+    latency_record(LAT_USB_SEND, sent_time - r->built_time_ns);
+    latency_record_span(LAT_USB_AGE, r->rx_time_ns, sent_time);
+}
+
+/**
+ * Translate state and write it to ep1 (synchronous backend). The write
+ * blocks until the host polls; never waits for one already in flight.
+ */
+static int ep1_send_state(const controller_state_t* state) {
+    if (!g_usb_enabled || g_ep1_fd < 0) return -1;
     
-    while (g_running) {
-        struct usb_functionfs_event event;
-        
-        if (read(g_ep0_fd, &event, sizeof(event)) < 0) {
-            if (errno == EINTR) continue;
-            perror("[USB] read ep0");
-            break;
-        }
+    ep1_report_t r;
+    ep1_build(state, &r);
+    
+    if (pthread_mutex_trylock(&g_ep1_mutex) != 0) {
+        return 0;  /* A fresher report is already going out */
+    }
+    
+    ssize_t written = write(g_ep1_fd, r.report, DS3_INPUT_REPORT_SIZE);
+    uint64_t sent_time = time_now_ns();
+    if (written == DS3_INPUT_REPORT_SIZE) {
+        ep1_account(&r, sent_time);
+    }
+    pthread_mutex_unlock(&g_ep1_mutex);
+    
+    return (written == DS3_INPUT_REPORT_SIZE) ? 0 : -1;
+}
+
+/* ============================================================================
+ * ASYNC ENDPOINT ENGINE
+ * 
+ * FunctionFS endpoints support Linux native AIO. Completions are
+ * signalled on an eventfd (IOCB_FLAG_RESFD), which the ep1 loop watches,
+ * so neither endpoint needs a thread parked in read()/write().
+ * 
+ * ep1 always has exactly one transfer queued. The host takes it at its
+ * next poll; the completion immediately queues the current state again.
+ * If a newer report is built while a transfer is still queued, the
+ * queued one is cancelled and replaced, so the host always gets the
+ * freshest report instead of one that sat waiting for the poll.
+ * 
+ * ep2 always has one read queued, re-armed on every completion.
+ * 
+ * Raw syscalls are used (no libaio dependency).
+ * ============================================================================ */
+
+usb_io_mode_t g_usb_io_mode = USB_IO_AIO;
+
+const char* usb_io_mode_str(usb_io_mode_t mode) {
+    switch (mode) {
+        case USB_IO_AIO:  return "aio";
+        case USB_IO_SYNC: return "sync";
+    }
+    return "unknown";
+}
+
+#define AIO_MAX_EVENTS  4
+#define AIO_TAG_EP1     1
+#define AIO_TAG_EP2     2
+
+static aio_context_t g_aio_ctx = 0;
+static int g_aio_event_fd = -1;
+
+/* ep1 - protected by g_ep1_mutex (input thread submits in rtc mode) */
+static struct iocb g_ep1_iocb;
+static ep1_report_t g_ep1_queued;       /* Owned by the kernel while in flight */
+static ep1_report_t g_ep1_pending;      /* Replacement waiting for the cancel */
+static int g_ep1_inflight = 0;
+static int g_ep1_cancelling = 0;
+static int g_ep1_has_pending = 0;
+
+/* ep2 - only touched from the ep1 loop */
+static struct iocb g_ep2_iocb;
+static uint8_t g_ep2_buf[EP_MAX_PACKET];
+static int g_ep2_inflight = 0;
+
+static inline long sys_io_setup(unsigned nr, aio_context_t* ctx) {
+    return syscall(__NR_io_setup, nr, ctx);
+}
+
+static inline long sys_io_destroy(aio_context_t ctx) {
+    return syscall(__NR_io_destroy, ctx);
+}
+
+static inline long sys_io_submit(aio_context_t ctx, long nr, struct iocb** iocbs) {
+    return syscall(__NR_io_submit, ctx, nr, iocbs);
+}
+
+static inline long sys_io_cancel(aio_context_t ctx, struct iocb* iocb, struct io_event* result) {
+    return syscall(__NR_io_cancel, ctx, iocb, result);
+}
+
+static inline long sys_io_getevents(aio_context_t ctx, long min_nr, long nr,
+                                    struct io_event* events, struct timespec* timeout) {
+    return syscall(__NR_io_getevents, ctx, min_nr, nr, events, timeout);
+}
+
+static int aio_submit(struct iocb* cb, int fd, uint16_t opcode, void* buf, size_t len, uint64_t tag) {
+    memset(cb, 0, sizeof(*cb));
+    cb->aio_data = tag;
+    cb->aio_lio_opcode = opcode;
+    cb->aio_fildes = fd;
+    cb->aio_buf = (uint64_t)(uintptr_t)buf;
+    cb->aio_nbytes = len;
+    cb->aio_flags = IOCB_FLAG_RESFD;
+    cb->aio_resfd = g_aio_event_fd;
+    
+    struct iocb* list[1] = {cb};
+    return (sys_io_submit(g_aio_ctx, 1, list) == 1) ? 0 : -1;
+}
+
+int ps3_usb_aio_init(void) {
+    if (sys_io_setup(AIO_MAX_EVENTS, &g_aio_ctx) < 0) {
+        perror("[USB] io_setup");
+        return -1;
+    }
+    
+    g_aio_event_fd = reactor_event_create();
+    if (g_aio_event_fd < 0) {
+        sys_io_destroy(g_aio_ctx);
+        g_aio_ctx = 0;
+        return -1;
+    }
+    
+    return 0;
+}
+
+/* --- ep1 --- */
+
+/* Caller holds g_ep1_mutex */
+static int ep1_aio_submit_locked(const ep1_report_t* r) {
+    if (g_ep1_fd < 0) return -1;
+    
+    g_ep1_queued = *r;
+    if (aio_submit(&g_ep1_iocb, g_ep1_fd, IOCB_CMD_PWRITE,
+                   g_ep1_queued.report, DS3_INPUT_REPORT_SIZE, AIO_TAG_EP1) < 0) {
+        return -1;
+    }
+    
+    g_ep1_inflight = 1;
+    return 0;
+}
+
+/* Caller holds g_ep1_mutex */
+static void ep1_aio_complete_locked(long res) {
+    g_ep1_inflight = 0;
+    g_ep1_cancelling = 0;
+    
+    int sent = (res == DS3_INPUT_REPORT_SIZE);
+    if (sent) {
+        ep1_account(&g_ep1_queued, time_now_ns());
+    }
+    
+    /* A newer report was waiting for the cancel */
+    if (g_ep1_has_pending) {
+        g_ep1_has_pending = 0;
+        ep1_aio_submit_locked(&g_ep1_pending);
+        return;
+    }
+    
+    /* Keep one transfer queued. After an error (endpoint disabled) the
+     * timer re-arms it instead, so a dead endpoint can't spin us. */
+    if (sent && g_usb_enabled && !system_is_standby()) {
+        controller_state_t state;
+        ep1_report_t r;
+        controller_state_copy(&state);
+        ep1_build(&state, &r);
+        ep1_aio_submit_locked(&r);
+    }
+}
+
+/**
+ * Queue a report on ep1, replacing the one in flight if the host
+ * hasn't taken it yet.
+ * @param only_if_idle Don't replace a queued transfer
+ */
+static int ep1_aio_send(const controller_state_t* state, int only_if_idle) {
+    if (!g_usb_enabled || g_ep1_fd < 0) return -1;
+    
+    ep1_report_t r;
+    ep1_build(state, &r);
+    
+    pthread_mutex_lock(&g_ep1_mutex);
+    
+    int ret = 0;
+    if (!g_ep1_inflight) {
+        ret = ep1_aio_submit_locked(&r);
+    } else if (!only_if_idle) {
+        /* Compare against the newest report we already have */
+        const ep1_report_t* newest = g_ep1_has_pending ? &g_ep1_pending : &g_ep1_queued;
         
-        switch (event.type) {
-            case FUNCTIONFS_SETUP: {
-                uint8_t bRequest = event.u.setup.bRequest;
-                uint16_t wValue = event.u.setup.wValue;
-                uint16_t wLength = event.u.setup.wLength;
-                uint8_t report_id = wValue & 0xFF;
+        if (memcmp(newest->report, r.report, DS3_INPUT_REPORT_SIZE) != 0) {
+            g_ep1_pending = r;
+            g_ep1_has_pending = 1;
+            
+            if (!g_ep1_cancelling) {
+                struct io_event ev;
+                g_ep1_cancelling = 1;
                 
-                if (bRequest == 0x0A) {
-                    /* SET_IDLE */
-                    read(g_ep0_fd, NULL, 0);
-                }
-                else if (bRequest == 0x01) {
-                    /* GET_REPORT */
-                    const char* name = NULL;
-                    const uint8_t* data = ds3_get_feature_report(report_id, &name);
-                    
-                    if (data) {
-                        size_t send_len = (DS3_FEATURE_REPORT_SIZE < wLength) ?
-                                          DS3_FEATURE_REPORT_SIZE : wLength;
-                        write(g_ep0_fd, data, send_len);
-                    } else {
-                        read(g_ep0_fd, NULL, 0);  /* Stall */
-                    }
+                /* Older kernels complete the cancel synchronously; newer ones
+                 * return EINPROGRESS and post the completion to the eventfd.
+                 * If the host already took it, the normal completion follows. */
+                if (sys_io_cancel(g_aio_ctx, &g_ep1_iocb, &ev) == 0) {
+                    ep1_aio_complete_locked(ev.res);
                 }
-                else if (bRequest == 0x09) {
-                    /* SET_REPORT */
-                    uint8_t buf[64] = {0};
-                    ssize_t r = 0;
-                    
-                    if (wLength > 0) {
-                        r = read(g_ep0_fd, buf, wLength < 64 ? wLength : 64);
-                        if (r > 0) {
-                            ds3_handle_set_report(report_id, buf, r);
-                        }
-                    }
-                    write(g_ep0_fd, NULL, 0);  /* ACK */
-                }
-                else {
-                    read(g_ep0_fd, NULL, 0);  /* Stall unknown requests */
-                }
-                break;
             }
+        }
+    }
+    
+    pthread_mutex_unlock(&g_ep1_mutex);
+    return ret;
+}
+
+/* --- ep2 --- */
+
+static void ep2_handle_report(const uint8_t* buf, ssize_t n);
+
+static void ep2_aio_submit(void) {
+    if (g_ep2_inflight || g_ep2_fd < 0) return;
+    
+    if (aio_submit(&g_ep2_iocb, g_ep2_fd, IOCB_CMD_PREAD,
+                   g_ep2_buf, sizeof(g_ep2_buf), AIO_TAG_EP2) == 0) {
+        g_ep2_inflight = 1;
+    }
+}
+
+static void ep2_aio_complete(long res) {
+    g_ep2_inflight = 0;
+    
+    if (res > 0) {
+        ep2_handle_report(g_ep2_buf, res);
+        ep2_aio_submit();
+    }
+    /* On error (endpoint disabled) the ep1 timer re-arms the read */
+}
+
+/* --- completions --- */
+
+static void aio_event_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    uint64_t count = reactor_event_read(fd);
+    if (count == 0) return;
+    
+    struct io_event ev[AIO_MAX_EVENTS];
+    struct timespec zero = {0, 0};
+    long n;
+    
+    while ((n = sys_io_getevents(g_aio_ctx, 0, AIO_MAX_EVENTS, ev, &zero)) > 0) {
+        for (long i = 0; i < n; i++) {
+            if (ev[i].data == AIO_TAG_EP1) {
+                pthread_mutex_lock(&g_ep1_mutex);
+                ep1_aio_complete_locked((long)ev[i].res);
+                pthread_mutex_unlock(&g_ep1_mutex);
+            } else if (ev[i].data == AIO_TAG_EP2) {
+                ep2_aio_complete((long)ev[i].res);
+            }
+        }
+    }
+}
+
+int ps3_usb_send_input(const controller_state_t* state) {
+    if (g_usb_io_mode == USB_IO_AIO) {
+        return ep1_aio_send(state, 0);
+    }
+    return ep1_send_state(state);
+}
+
+/* ============================================================================
+ * HOST POLL CADENCE
+ * 
+ * EP_INTERVAL only bounds how often the PS3 may poll ep1. The real rate
+ * and phase come from completion times (core/cadence.h); with the AIO
+ * backend a transfer is always queued, so every completion is a poll.
+ * ============================================================================ */
+
+static void ep1_cadence_reset(void) {
+    pthread_mutex_lock(&g_ep1_cadence_mutex);
+    cadence_init(&g_ep1_cadence, TIME_MS(EP_INTERVAL));
+    pthread_mutex_unlock(&g_ep1_cadence_mutex);
+}
+
+/* How long before a predicted poll ep1 samples the state (runtime option) */
+static uint64_t ep1_sample_lead_ns(void) {
+    adapter_config_t config;
+    config_get(&config);
+    return TIME_US(config.usb_sample_lead_us);
+}
+
+/* Next predicted poll at least the sample lead away, 0 if not locked */
+static uint64_t ep1_next_poll(uint64_t now) {
+    uint64_t lead = ep1_sample_lead_ns();
+    pthread_mutex_lock(&g_ep1_cadence_mutex);
+    uint64_t poll = cadence_next_poll(&g_ep1_cadence, now + lead);
+    pthread_mutex_unlock(&g_ep1_cadence_mutex);
+    return poll;
+}
+
+uint64_t ps3_usb_publish_slot(uint64_t t) {
+    /* The ep1 sample for poll P is taken at P - lead; land a further lead
+     * ahead of that so the state is in place when it is read */
+    uint64_t lead = ep1_sample_lead_ns();
+    uint64_t poll = ep1_next_poll(t + lead);
+    return poll ? poll - 2 * lead : 0;
+}
+
+void ps3_usb_cadence_dump(void) {
+    cadence_stats_t stats;
+    
+    pthread_mutex_lock(&g_ep1_cadence_mutex);
+    cadence_get_stats(&g_ep1_cadence, &stats);
+    pthread_mutex_unlock(&g_ep1_cadence_mutex);
+    
+    printf("=== PS3 Host Poll (ep1) ===\n");
+    printf("  Completions:    %llu (%llu polls missed)\n",
+           (unsigned long long)stats.polls, (unsigned long long)stats.missed);
+    if (stats.period_ns > 0) {
+        printf("  Poll rate:      %.1f Hz (%.1f us period)\n",
+               1e9 / (double)stats.period_ns, stats.period_ns / 1000.0);
+    }
+    printf("  Jitter:         %.1f us mean\n", stats.jitter_ns / 1000.0);
+    printf("  Phase:          %s (%llu relocks)\n",
+           stats.locked ? "locked" : "searching", (unsigned long long)stats.relocks);
+    printf("===========================\n\n");
+    fflush(stdout);
+}
+
+/* ============================================================================
+ * CONTROL ENDPOINT (ep0)
+ * ============================================================================ */
+
+static reactor_t* g_usb_reactor = NULL;
+
+static void ep0_event_handler(int fd, uint32_t events, void* ctx) {
+    (void)ctx;
+    
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        fprintf(stderr, "[USB] ep0 error, stopping control handling\n");
+        reactor_del(g_usb_reactor, fd);
+        return;
+    }
+    
+    struct usb_functionfs_event event;
+    
+    if (read(fd, &event, sizeof(event)) < 0) {
+        if (errno == EINTR || errno == EAGAIN) return;
+        perror("[USB] read ep0");
+        reactor_del(g_usb_reactor, fd);
+        return;
+    }
+    
+    switch (event.type) {
+        case FUNCTIONFS_SETUP: {
+            uint8_t bRequest = event.u.setup.bRequest;
+            uint16_t wValue = event.u.setup.wValue;
+            uint16_t wLength = event.u.setup.wLength;
+            uint8_t report_id = wValue & 0xFF;
             
-            case FUNCTIONFS_ENABLE:
-                printf("[USB] *** ENABLED - PS3 connected ***\n");
-                g_usb_enabled = 1;
-                g_suspend_count = 0;  /* Reset suspend counter */
-                g_last_enable_time = time_get_ms();
-                
-                if (system_get_state() == SYSTEM_STATE_WAKING) {
-                    printf("[USB] PS3 responded to wake\n");
-                    system_set_state(SYSTEM_STATE_ACTIVE);
-                }
-                break;
-                
-            case FUNCTIONFS_DISABLE:
-                printf("[USB] *** DISABLED - PS3 disconnected ***\n");
-                g_usb_enabled = 0;
-                
-                /* Clear rumble */
-                controller_output_t output;
-                controller_output_copy(&output);
-                output.rumble_left = 0;
-                output.rumble_right = 0;
-                controller_output_update(&output);
-                break;
-                
-            case FUNCTIONFS_SUSPEND: {
-                g_suspend_count++;
-                uint64_t now = time_get_ms();
-                uint64_t time_since_enable = now - g_last_enable_time;
-                
-                printf("[USB] SUSPEND event #%d (USB stable for %llu ms)\n", 
-                       g_suspend_count, (unsigned long long)time_since_enable);
+            if (bRequest == 0x0A) {
+                /* SET_IDLE */
+                read(g_ep0_fd, NULL, 0);
+            }
+            else if (bRequest == 0x01) {
+                /* GET_REPORT */
+                const char* name = NULL;
+                const uint8_t* data = ds3_get_feature_report(report_id, &name);
                 
-                /* 
-                 * Only enter standby if:
-                 * 1. USB has been stable for a while (not just during initial connection)
-                 * 2. We've seen multiple suspend events (not just a glitch)
-                 * 3. We're currently in ACTIVE state
-                 */
-                if (time_since_enable >= USB_STABLE_TIME_MS && 
-                    g_suspend_count >= SUSPEND_THRESHOLD &&
-                    system_get_state() == SYSTEM_STATE_ACTIVE) {
-                    
-                    printf("[USB] *** SUSPEND confirmed - entering standby ***\n");
-                    g_usb_enabled = 0;
-                    system_enter_standby();
+                if (data) {
+                    size_t send_len = (DS3_FEATURE_REPORT_SIZE < wLength) ?
+                                      DS3_FEATURE_REPORT_SIZE : wLength;
+                    write(g_ep0_fd, data, send_len);
                 } else {
-                    printf("[USB] SUSPEND ignored (not stable or threshold not met)\n");
+                    read(g_ep0_fd, NULL, 0);  /* Stall */
                 }
-                break;
             }
+            else if (bRequest == 0x09) {
+                /* SET_REPORT */
+                uint8_t buf[64] = {0};
+                ssize_t r = 0;
                 
-            case FUNCTIONFS_UNBIND:
-                printf("[USB] UNBIND\n");
-                g_running = 0;
-                break;
+                if (wLength > 0) {
+                    r = read(g_ep0_fd, buf, wLength < 64 ? wLength : 64);
+                    if (r > 0) {
+                        ds3_handle_set_report(report_id, buf, r);
+                    }
+                }
+                write(g_ep0_fd, NULL, 0);  /* ACK */
+            }
+            else {
+                read(g_ep0_fd, NULL, 0);  /* Stall unknown requests */
+            }
+            break;
+        }
+        
+        case FUNCTIONFS_ENABLE:
+            printf("[USB] *** ENABLED - PS3 connected ***\n");
+            ep1_cadence_reset();
+            g_usb_enabled = 1;
+            g_suspend_count = 0;  /* Reset suspend counter */
+            g_last_enable_time = time_now_coarse_ns();
+            
+            if (system_get_state() == SYSTEM_STATE_WAKING) {
+                printf("[USB] PS3 responded to wake\n");
+                system_set_state(SYSTEM_STATE_ACTIVE);
+            }
+            break;
+            
+        case FUNCTIONFS_DISABLE:
+            printf("[USB] *** DISABLED - PS3 disconnected ***\n");
+            g_usb_enabled = 0;
+            
+            /* Clear rumble */
+            controller_output_t output;
+            controller_output_copy(&output);
+            output.rumble_left = 0;
+            output.rumble_right = 0;
+            controller_output_update(&output);
+            break;
+            
+        case FUNCTIONFS_SUSPEND: {
+            g_suspend_count++;
+            uint64_t now = time_now_coarse_ns();
+            uint64_t time_since_enable = (now - g_last_enable_time) / TIME_NS_PER_MS;
+            
+            printf("[USB] SUSPEND event #%d (USB stable for %llu ms)\n", 
+                   g_suspend_count, (unsigned long long)time_since_enable);
+            
+            /* 
+             * Only enter standby if:
+             * 1. USB has been stable for a while (not just during initial connection)
+             * 2. We've seen multiple suspend events (not just a glitch)
+             * 3. We're currently in ACTIVE state
+             */
+            if (time_since_enable >= USB_STABLE_TIME_MS && 
+                g_suspend_count >= SUSPEND_THRESHOLD &&
+                system_get_state() == SYSTEM_STATE_ACTIVE) {
                 
-            default:
-                break;
+                printf("[USB] *** SUSPEND confirmed - entering standby ***\n");
+                g_usb_enabled = 0;
+                system_enter_standby();
+            } else {
+                printf("[USB] SUSPEND ignored (not stable or threshold not met)\n");
+            }
+            break;
         }
+            
+        case FUNCTIONFS_UNBIND:
+            printf("[USB] UNBIND\n");
+            reactor_request_shutdown();
+            break;
+            
+        default:
+            break;
     }
+}
+
+int ps3_usb_attach(reactor_t* r) {
+    if (g_ep0_fd < 0) return -1;
     
-    return NULL;
+    g_usb_reactor = r;
+    if (reactor_add(r, g_ep0_fd, EPOLLIN, ep0_event_handler, NULL) < 0) {
+        return -1;
+    }
+    
+    printf("[USB] Control endpoint attached to %s loop\n", r->name);
+    return 0;
+}
+
+/* ============================================================================
+ * INPUT ENDPOINT (ep1)
+ * 
+ * ep1 gets its own loop and thread. A timerfd drives it:
+ *   decoupled   Periodic on an absolute 4ms grid until the host poll
+ *               cadence locks, then one-shot the sample lead before
+ *               each predicted poll
+ *   rtc         One-shot at last send + keep-alive, re-armed after each
+ *               send so it only fires when the input thread goes quiet
+ *   standby     Periodic 100ms, nothing is sent
+ * 
+ * With the AIO backend the same loop also handles ep1/ep2 completions,
+ * and the timer only refreshes (decoupled) or restarts (rtc, after an
+ * error) the queued transfer. With the sync backend each tick blocks in
+ * write() until the host polls.
+ * ============================================================================ */
+
+/* Timer period while the PS3 is in standby */
+#define USB_STANDBY_POLL_MS 100
+
+static int g_ep1_timer_fd = -1;
+static int g_ep1_standby = 0;
+static int g_ep1_aligned = 0;   /* Timer is one-shot before the next poll */
+
+static void ep1_arm_timer(void) {
+    uint64_t now = time_now_ns();
+    
+    g_ep1_aligned = 0;
+    if (g_ep1_standby) {
+        reactor_timer_set(g_ep1_timer_fd, now + TIME_MS(USB_STANDBY_POLL_MS),
+                          TIME_MS(USB_STANDBY_POLL_MS));
+    } else if (g_input_path_mode == INPUT_PATH_DECOUPLED) {
+        uint64_t poll = ep1_next_poll(now);
+        if (poll) {
+            g_ep1_aligned = 1;
+            reactor_timer_set(g_ep1_timer_fd, poll - ep1_sample_lead_ns(), 0);
+        } else {
+            reactor_timer_set(g_ep1_timer_fd, now + TIME_MS(USB_INPUT_INTERVAL_MS),
+                              TIME_MS(USB_INPUT_INTERVAL_MS));
+        }
+    } else {
+        uint64_t keepalive = g_last_ep1_send_time + TIME_MS(USB_KEEPALIVE_MS);
+        if (keepalive <= now) keepalive = now + TIME_MS(USB_KEEPALIVE_MS);
+        reactor_timer_set(g_ep1_timer_fd, keepalive, 0);
+    }
+}
+
+static void ep1_timer_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    if (reactor_timer_read(fd) == 0) return;
+    
+    int standby = system_is_standby();
+    if (standby != g_ep1_standby) {
+        g_ep1_standby = standby;
+        ep1_arm_timer();
+    }
+    if (standby) return;
+    
+    if (g_usb_io_mode == USB_IO_AIO && g_usb_enabled) {
+        ep2_aio_submit();
+    }
+    
+    if (g_input_path_mode == INPUT_PATH_RUN_TO_COMPLETION &&
+        !time_deadline_passed(g_last_ep1_send_time + TIME_MS(USB_KEEPALIVE_MS))) {
+        /* Input thread sent since the timer was armed - just push it back */
+        ep1_arm_timer();
+        return;
+    }
+    
+    if (g_usb_enabled) {
+        /* Get current controller state */
+        controller_state_t state;
+        controller_state_copy(&state);
+        
+        /* Build DS3 report from generic state and send to PS3 */
+        if (g_usb_io_mode == USB_IO_AIO) {
+            ep1_aio_send(&state, g_input_path_mode == INPUT_PATH_RUN_TO_COMPLETION);
+        } else {
+            ep1_send_state(&state);
+        }
+    }
+    
+    if (g_input_path_mode == INPUT_PATH_RUN_TO_COMPLETION) {
+        ep1_arm_timer();
+    } else if (g_ep1_aligned || ep1_next_poll(time_now_ns())) {
+        /* Follow the host: re-aim at the next poll, or lock on / fall
+         * back to the grid if the cadence was acquired / lost */
+        ep1_arm_timer();
+    }
 }
 
 void* ps3_usb_input_thread(void* arg) {
     (void)arg;
     
-    g_ep1_fd = ps3_usb_open_endpoint(1);
-    if (g_ep1_fd < 0) {
+    int fd = ps3_usb_open_endpoint(1);
+    if (fd < 0) {
         printf("[USB] Failed to open ep1\n");
         return NULL;
     }
     
-    printf("[USB] Input thread started\n");
+    /* Fail fast instead of waiting while the endpoint is disabled. Once
+     * enabled, a sync write() still waits for the host's poll, which is
+     * why run-to-completion requires the AIO backend */
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    g_ep1_fd = fd;
     
-    uint8_t report[DS3_INPUT_REPORT_SIZE];
+    reactor_t loop;
+    if (reactor_init(&loop, "ep1") < 0) {
+        return NULL;
+    }
     
-    while (g_running) {
-        if (system_is_standby()) {
-            usleep(100000);
-            continue;
-        }
-        
-        if (g_usb_enabled) {
-            /* Get current controller state */
-            controller_state_t state;
-            controller_state_copy(&state);
-            
-            /* Build DS3 report from generic state */
-            ds3_build_input_report(&state, report);
-            
-            /* Send to PS3 */
-            write(g_ep1_fd, report, DS3_INPUT_REPORT_SIZE);
+    g_ep1_timer_fd = reactor_timer_create();
+    if (g_ep1_timer_fd < 0 ||
+        reactor_add(&loop, g_ep1_timer_fd, EPOLLIN, ep1_timer_handler, NULL) < 0) {
+        reactor_close(&loop);
+        return NULL;
+    }
+    
+    if (g_usb_io_mode == USB_IO_AIO) {
+        /* ep2 reads complete here too - no output thread */
+        g_ep2_fd = ps3_usb_open_endpoint(2);
+        if (g_ep2_fd >= 0) {
+            fcntl(g_ep2_fd, F_SETFL, fcntl(g_ep2_fd, F_GETFL) | O_NONBLOCK);
+        } else {
+            printf("[USB] Failed to open ep2\n");
         }
-        
-        usleep(4000);  /* ~250Hz */
+        reactor_add(&loop, g_aio_event_fd, EPOLLIN, aio_event_handler, NULL);
     }
     
+    printf("[USB] Input thread started (%s, %s I/O)\n",
+           input_path_mode_str(g_input_path_mode), usb_io_mode_str(g_usb_io_mode));
+    rt_thread_enter(RT_THREAD_EP1);
+    
+    ep1_cadence_reset();
+    g_ep1_standby = system_is_standby();
+    ep1_arm_timer();
+    reactor_run(&loop);
+    
+    if (g_usb_io_mode == USB_IO_AIO) {
+        /* Cancels anything still queued */
+        reactor_del(&loop, g_aio_event_fd);
+        sys_io_destroy(g_aio_ctx);
+    }
+    
+    reactor_del(&loop, g_ep1_timer_fd);
+    close(g_ep1_timer_fd);
+    g_ep1_timer_fd = -1;
+    reactor_close(&loop);
     return NULL;
 }
 
+/* ============================================================================
+ * OUTPUT ENDPOINT (ep2)
+ * ============================================================================ */
+
+static void ep2_handle_report(const uint8_t* buf, ssize_t n) {
+    static int output_log_count = 0;
+    
+    /* Debug: log first few output reports to see structure */
+    if (++output_log_count <= 10) {
+        printf("[USB] Output report (%zd bytes):", n);
+        for (ssize_t i = 0; i < n && i < 16; i++) {
+            printf(" %02X", buf[i]);
+        }
+        if (n > 16) printf(" ...");
+        printf("\n");
+    }
+    
+    /* Parse and update output state */
+    if (n >= 6) {
+        ds3_parse_output_report(buf, n);
+    }
+}
+
 void* ps3_usb_output_thread(void* arg) {
     (void)arg;
     
@@ -459,7 +991,6 @@ void* ps3_usb_output_thread(void* arg) {
     printf("[USB] Output thread started\n");
     
     uint8_t buf[EP_MAX_PACKET];
-    static int output_log_count = 0;
     
     while (g_running) {
         ssize_t n = read(g_ep2_fd, buf, sizeof(buf));
@@ -472,21 +1003,8 @@ void* ps3_usb_output_thread(void* arg) {
             continue;
         }
         
-        /* Debug: log first few output reports to see structure */
-        if (++output_log_count <= 10) {
-            printf("[USB] Output report (%zd bytes):", n);
-            for (ssize_t i = 0; i < n && i < 16; i++) {
-                printf(" %02X", buf[i]);
-            }
-            if (n > 16) printf(" ...");
-            printf("\n");
-        }
-        
-        /* Parse and update output state */
-        if (n >= 6) {
-            ds3_parse_output_report(buf, n);
-        }
+        ep2_handle_report(buf, n);
     }
     
     return NULL;
-}
\ No newline at end of file
+}
@@ -4,6 +4,11 @@
  * 
  * Manages controller driver registration and device discovery.
  * 
+ * Drivers are indexed by VID/PID at registration. Discovery is one pass
+ * over /sys/class/hidraw that reads each node's IDs from sysfs (nothing
+ * is opened), looks them up in the index and hands the node to the owning
+ * driver's open_device(). The same lookup serves hotplug events.
+ * 
  * HOW TO ADD A NEW CONTROLLER:
  * ----------------------------
  * 
@@ -22,8 +27,11 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <dirent.h>
 
+#include "core/common.h"
 #include "controllers/controller_interface.h"
+#include "controllers/hotplug.h"
 #include "controllers/dualsense/dualsense.h"
 /* Add new controller includes here */
 /* #include "controllers/xbox/xbox.h" */
@@ -40,6 +48,65 @@ static const controller_driver_t* g_drivers[MAX_DRIVERS];
 static int g_driver_count = 0;
 static const controller_driver_t* g_active_driver = NULL;
 
+/* ============================================================================
+ * VID/PID INDEX
+ * 
+ * Open addressing with linear probing, keyed by (VID << 16) | PID. Sized
+ * for several IDs per driver and kept under half full, so a lookup is one
+ * or two probes.
+ * ============================================================================ */
+
+#define DEVICE_INDEX_SIZE   64      /* Power of two */
+#define DEVICE_KEY(vid, pid) (((uint32_t)(vid) << 16) | (pid))
+
+typedef struct {
+    uint32_t key;                   /* 0 = empty (VID 0 is never valid) */
+    const controller_driver_t* driver;
+} device_index_entry_t;
+
+static device_index_entry_t g_device_index[DEVICE_INDEX_SIZE];
+static int g_device_index_count = 0;
+
+static uint32_t device_index_slot(uint32_t key) {
+    return (key * 2654435761u) >> 26;   /* Fibonacci hash, top 6 bits */
+}
+
+static int device_index_add(uint16_t vid, uint16_t pid, const controller_driver_t* driver) {
+    uint32_t key = DEVICE_KEY(vid, pid);
+    if (vid == 0) return -1;
+    if (g_device_index_count >= DEVICE_INDEX_SIZE / 2) {
+        printf("[Registry] Error: Device index full\n");
+        return -1;
+    }
+    
+    for (uint32_t i = device_index_slot(key);; i = (i + 1) & (DEVICE_INDEX_SIZE - 1)) {
+        if (g_device_index[i].key == key) {
+            printf("[Registry] Warning: %04X:%04X already claimed by %s\n",
+                   vid, pid, g_device_index[i].driver->info->name);
+            return -1;
+        }
+        if (g_device_index[i].key == 0) {
+            g_device_index[i].key = key;
+            g_device_index[i].driver = driver;
+            g_device_index_count++;
+            return 0;
+        }
+    }
+}
+
+static const controller_driver_t* device_index_find(uint16_t vid, uint16_t pid) {
+    uint32_t key = DEVICE_KEY(vid, pid);
+    
+    for (uint32_t i = device_index_slot(key);; i = (i + 1) & (DEVICE_INDEX_SIZE - 1)) {
+        if (g_device_index[i].key == key) return g_device_index[i].driver;
+        if (g_device_index[i].key == 0) return NULL;
+    }
+}
+
+/* ============================================================================
+ * REGISTRATION
+ * ============================================================================ */
+
 int controller_register(const controller_driver_t* driver) {
     if (g_driver_count >= MAX_DRIVERS) {
         printf("[Registry] Error: Driver registry full\n");
@@ -52,6 +119,10 @@ int controller_register(const controller_driver_t* driver) {
     }
     
     g_drivers[g_driver_count++] = driver;
+    device_index_add(driver->info->vendor_id, driver->info->product_id, driver);
+    for (const controller_device_id_t* id = driver->info->extra_ids; id && id->vendor_id; id++) {
+        device_index_add(id->vendor_id, id->product_id, driver);
+    }
     printf("[Registry] Registered: %s (VID=%04X PID=%04X)\n",
            driver->info->name,
            driver->info->vendor_id,
@@ -61,6 +132,10 @@ int controller_register(const controller_driver_t* driver) {
 }
 
 const controller_driver_t* controller_find_driver(uint16_t vid, uint16_t pid) {
+    const controller_driver_t* driver = device_index_find(vid, pid);
+    if (driver) return driver;
+    
+    /* Drivers that can't list their IDs up front */
     for (int i = 0; i < g_driver_count; i++) {
         if (g_drivers[i]->match_device && g_drivers[i]->match_device(vid, pid)) {
             return g_drivers[i];
@@ -125,26 +200,72 @@ void controller_drivers_shutdown(void) {
  * DEVICE SCANNING
  * ============================================================================ */
 
+/**
+ * Open a device whose IDs are already known (scan or hotplug).
+ * 
+ * @param devnode Device node, e.g. "/dev/hidraw3"
+ * @param out_driver Output: the driver that opened it
+ * @return File descriptor on success, -1 if no driver wants it
+ */
+int controller_open_device(const char* devnode, uint16_t vid, uint16_t pid,
+                           const controller_driver_t** out_driver) {
+    const controller_driver_t* driver = controller_find_driver(vid, pid);
+    int fd = -1;
+    
+    if (driver && driver->open_device) {
+        fd = driver->open_device(devnode);
+    }
+    if (out_driver) *out_driver = fd >= 0 ? driver : NULL;
+    return fd;
+}
+
 /**
  * Scan for any supported controller.
- * Tries each registered driver's find_device() function.
+ * One pass over sysfs, dispatching each hidraw node through the VID/PID
+ * index; then find_device() for drivers that aren't hidraw based.
  * 
  * @param out_driver Output: the driver that matched
  * @return File descriptor on success, -1 if no controller found
  */
 int controller_scan_devices(const controller_driver_t** out_driver) {
-    for (int i = 0; i < g_driver_count; i++) {
+    static int scans = 0;
+    uint64_t start_ns = time_now_ns();
+    const controller_driver_t* driver = NULL;
+    int nodes = 0, fd = -1;
+    
+    DIR* dir = opendir(HOTPLUG_SYSFS_HIDRAW);
+    if (dir) {
+        struct dirent* entry;
+        while (fd < 0 && (entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, "hidraw", 6) != 0) continue;
+            nodes++;
+            
+            uint16_t bus, vid, pid;
+            if (hotplug_hidraw_ids(entry->d_name, &bus, &vid, &pid) < 0) continue;
+            
+            char devnode[272];
+            snprintf(devnode, sizeof(devnode), "/dev/%s", entry->d_name);
+            fd = controller_open_device(devnode, vid, pid, &driver);
+        }
+        closedir(dir);
+    }
+    
+    for (int i = 0; fd < 0 && i < g_driver_count; i++) {
         if (g_drivers[i]->find_device) {
-            int fd = g_drivers[i]->find_device();
-            if (fd >= 0) {
-                if (out_driver) *out_driver = g_drivers[i];
-                return fd;
-            }
+            fd = g_drivers[i]->find_device();
+            if (fd >= 0) driver = g_drivers[i];
         }
     }
     
-    if (out_driver) *out_driver = NULL;
-    return -1;
+    /* The periodic fallback scan stays quiet until it finds something */
+    if (fd >= 0 || scans++ == 0) {
+        printf("[Registry] Scan: %d hidraw node(s), %s, %.0f us\n", nodes,
+               fd >= 0 ? driver->info->name : "no controller",
+               (time_now_ns() - start_ns) / 1000.0);
+    }
+    
+    if (out_driver) *out_driver = fd >= 0 ? driver : NULL;
+    return fd;
 }
 
 /* ============================================================================
@@ -156,7 +277,11 @@ void controller_registry_print(void) {
     for (int i = 0; i < g_driver_count; i++) {
         const controller_info_t* info = g_drivers[i]->info;
         printf("  [%d] %s (%s)\n", i + 1, info->name, info->manufacturer);
-        printf("      VID=%04X PID=%04X\n", info->vendor_id, info->product_id);
+        printf("      VID=%04X PID=%04X", info->vendor_id, info->product_id);
+        for (const controller_device_id_t* id = info->extra_ids; id && id->vendor_id; id++) {
+            printf(", %04X:%04X", id->vendor_id, id->product_id);
+        }
+        printf("\n");
         printf("      Capabilities:");
         if (info->capabilities & CONTROLLER_CAP_MOTION) printf(" Motion");
         if (info->capabilities & CONTROLLER_CAP_TOUCHPAD) printf(" Touchpad");
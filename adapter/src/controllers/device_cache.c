@@ -0,0 +1,103 @@
+/*
+ * RosettaPad - Controller Device Cache
+ * =====================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/hidraw.h>
+
+#include "core/crc32.h"
+#include "controllers/device_cache.h"
+
+int device_cache_key(int fd, uint16_t vid, uint16_t pid, device_cache_key_t* key) {
+    memset(key, 0, sizeof(*key));
+    key->vendor_id = vid;
+    key->product_id = pid;
+    
+    if (ioctl(fd, HIDIOCGRAWUNIQ(sizeof(key->uniq) - 1), key->uniq) < 0 || !key->uniq[0]) {
+        return -1;
+    }
+    return 0;
+}
+
+/* DEVICE_CACHE_DIR/054c-0ce6-a0b1c2d3e4f5.cache */
+static void cache_path(const device_cache_key_t* key, char* path, size_t size, const char* suffix) {
+    char id[DEVICE_CACHE_UNIQ_MAX];
+    size_t n = 0;
+    
+    for (const char* c = key->uniq; *c && n < sizeof(id) - 1; c++) {
+        if (isalnum((unsigned char)*c)) id[n++] = (char)tolower((unsigned char)*c);
+    }
+    id[n] = '\0';
+    
+    snprintf(path, size, DEVICE_CACHE_DIR "/%04x-%04x-%s.cache%s",
+             key->vendor_id, key->product_id, id, suffix);
+}
+
+int device_cache_load(const device_cache_key_t* key, uint32_t format, void* data, size_t size) {
+    char path[160];
+    cache_path(key, path, sizeof(path), "");
+    
+    FILE* f = fopen(path, "re");
+    if (!f) return -1;
+    
+    device_cache_file_t hdr;
+    int ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+             memcmp(hdr.magic, DEVICE_CACHE_MAGIC, sizeof(hdr.magic)) == 0 &&
+             hdr.vendor_id == key->vendor_id && hdr.product_id == key->product_id &&
+             hdr.format == format && hdr.size == size &&
+             fread(data, size, 1, f) == 1 &&
+             crc32_compute(data, size) == hdr.crc;
+    fclose(f);
+    
+    if (!ok) {
+        printf("[Cache] Ignoring stale or damaged %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int device_cache_store(const device_cache_key_t* key, uint32_t format, const void* data, size_t size) {
+    char path[160], tmp[168];
+    cache_path(key, path, sizeof(path), "");
+    cache_path(key, tmp, sizeof(tmp), ".tmp");
+    
+    if (size > DEVICE_CACHE_DATA_MAX) return -1;
+    if (mkdir(DEVICE_CACHE_DIR, 0755) < 0 && errno != EEXIST) {
+        perror("[Cache] mkdir " DEVICE_CACHE_DIR);
+        return -1;
+    }
+    
+    device_cache_file_t hdr = {
+        .vendor_id = key->vendor_id,
+        .product_id = key->product_id,
+        .format = format,
+        .size = (uint32_t)size,
+        .crc = crc32_compute(data, size),
+    };
+    memcpy(hdr.magic, DEVICE_CACHE_MAGIC, sizeof(hdr.magic));
+    
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("[Cache] open");
+        return -1;
+    }
+    int ok = write(fd, &hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr) &&
+             write(fd, data, size) == (ssize_t)size &&
+             fsync(fd) == 0;
+    close(fd);
+    
+    if (!ok || rename(tmp, path) < 0) {
+        perror("[Cache] write");
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
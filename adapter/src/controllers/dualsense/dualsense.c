@@ -7,7 +7,9 @@
  * This file demonstrates how to implement a controller driver:
  * 
  * 1. Define controller info (VID, PID, capabilities)
- * 2. Implement find_device() to locate the controller
+ * 2. Implement open_device() to take over a hidraw node the registry
+ *    matched to your VID/PID (controllers/device_cache.h keeps what was
+ *    learned about the device for the next connect)
  * 3. Implement process_input() to parse hardware-specific reports
  * 4. Implement send_output() for rumble/LED control
  * 5. Register the driver at startup
@@ -16,7 +18,8 @@
  * - Parse hardware-specific format into generic controller_state_t
  * - Handle both Bluetooth and USB connections if applicable
  * - Use sysfs for LED control if kernel driver manages them
- * - Calculate CRC for Bluetooth output reports if required
+ * - Calculate CRC for Bluetooth output reports if required, and verify it
+ *   on input reports
  */
 
 #include <stdio.h>
@@ -26,67 +29,118 @@
 #include <unistd.h>
 #include <errno.h>
 #include <dirent.h>
+#include <pthread.h>
 #include <linux/hidraw.h>
 #include <sys/ioctl.h>
 
 #include "core/common.h"
+#include "core/config.h"
+#include "core/crc32.h"
+#include "core/capture.h"
+#include "controllers/led_sysfs.h"
+#include "controllers/motion_calib.h"
+#include "controllers/device_cache.h"
+#include "controllers/hotplug.h"
 #include "controllers/dualsense/dualsense.h"
 
 /* ============================================================================
- * CRC32 FOR BLUETOOTH OUTPUT
+ * CRC32 FOR BLUETOOTH REPORTS
  * 
- * DualSense BT output reports require CRC32 validation.
+ * DualSense BT reports end in a CRC32 over the HID transaction header
+ * (0xA1 input / 0xA2 output) followed by the report. The header is
+ * constant, so it is folded into a seed once (see core/crc32.h).
  * Other controllers may not need this.
  * ============================================================================ */
 
-static uint32_t crc32_table[256];
-static int crc32_initialized = 0;
+static uint32_t g_crc_input_seed;
+static uint32_t g_crc_output_seed;
+static uint64_t g_crc_errors = 0;
 
-static void init_crc32_table(void) {
-    if (crc32_initialized) return;
+static void dualsense_crc_init(void) {
+    static const uint8_t input_header = DS_BT_INPUT_CRC_HEADER;
+    static const uint8_t output_header = DS_BT_OUTPUT_CRC_HEADER;
     
-    for (uint32_t i = 0; i < 256; i++) {
-        uint32_t crc = i;
-        for (int j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
-        }
-        crc32_table[i] = crc;
-    }
-    crc32_initialized = 1;
+    crc32_init();
+    g_crc_input_seed = crc32_compute(&input_header, 1);
+    g_crc_output_seed = crc32_compute(&output_header, 1);
+}
+
+static inline uint32_t load_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
 }
 
 uint32_t dualsense_calc_crc32(const uint8_t* data, size_t len) {
-    uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < len; i++) {
-        crc = (crc >> 8) ^ crc32_table[(crc ^ data[i]) & 0xFF];
-    }
-    return ~crc;
+    return crc32_compute(data, len);
+}
+
+int dualsense_check_input_crc(const uint8_t* report) {
+    uint32_t crc = crc32_extend(g_crc_input_seed, report, DS_BT_INPUT_SIZE - DS_BT_CRC_SIZE);
+    return crc == load_le32(&report[DS_BT_INPUT_SIZE - DS_BT_CRC_SIZE]);
+}
+
+uint64_t dualsense_get_crc_errors(void) {
+    return __atomic_load_n(&g_crc_errors, __ATOMIC_RELAXED);
 }
 
 /* ============================================================================
  * CALIBRATION DATA
  * 
  * DualSense provides per-controller calibration via Feature Report 0x05.
- * This data is used to normalize motion sensor readings.
+ * It is loaded into the motion engine (controllers/motion_calib.h), which
+ * also maps the DualSense axes onto the SIXAXIS frame:
+ * 
+ *   accel   X = X, Y = -Z, Z = -Y   (flat: Y reads +1 g, SIXAXIS Z -1 g)
+ *   gyro    X = -pitch, Y = roll, Z = yaw
+ * 
+ * i.e. the same swap and inversion hid-sony applies to SIXAXIS reports.
+ * Input thread only.
  * ============================================================================ */
 
-static ds_calibration_t g_ds_calibration = { .valid = 0 };
+static const motion_calib_spec_t g_ds_motion_spec = {
+    .nominal_scale = {
+        [MOTION_ACCEL] = (CONTROLLER_ACCEL_RES_PER_G << MOTION_CALIB_SHIFT) / DS_ACC_RAW_PER_G,
+        [MOTION_GYRO] = (CONTROLLER_GYRO_RES_PER_DEG_S << MOTION_CALIB_SHIFT) / DS_GYRO_RAW_PER_DEG_S,
+    },
+    .max_bias = {
+        [MOTION_ACCEL] = DS_ACC_RAW_PER_G / 4,          /* 0.25 g */
+        [MOTION_GYRO] = 64 * DS_GYRO_RAW_PER_DEG_S,     /* 64 deg/s */
+    },
+    .map = {
+        [MOTION_ACCEL] = { { 0, +1 }, { 2, -1 }, { 1, -1 } },
+        [MOTION_GYRO]  = { { 0, -1 }, { 2, +1 }, { 1, +1 } },
+    },
+    .rest_noise = {
+        [MOTION_ACCEL] = DS_ACC_RAW_PER_G / 32,         /* 0.03 g */
+        [MOTION_GYRO] = 3 * DS_GYRO_RAW_PER_DEG_S / 2,  /* 1.5 deg/s */
+    },
+    .max_drift = 5 * DS_GYRO_RAW_PER_DEG_S,             /* 5 deg/s */
+};
+
+static motion_calib_t g_ds_motion;
+
+/* Raw Feature Report 0x05, as read from the controller (and cached) */
+typedef uint8_t ds_calibration_report_t[DS_FEATURE_REPORT_CALIBRATION_SIZE + 1];
 
-/* Read calibration data from controller */
-static int dualsense_read_calibration(int fd) {
-    uint8_t buf[DS_FEATURE_REPORT_CALIBRATION_SIZE + 1] = {0};
+/* Read the calibration report - a round trip to the controller */
+static int dualsense_get_calibration_report(int fd, ds_calibration_report_t buf) {
+    memset(buf, 0, sizeof(ds_calibration_report_t));
     buf[0] = DS_FEATURE_REPORT_CALIBRATION;
     
-    int ret = ioctl(fd, HIDIOCGFEATURE(sizeof(buf)), buf);
+    int ret = ioctl(fd, HIDIOCGFEATURE(sizeof(ds_calibration_report_t)), buf);
     if (ret < 0) {
         printf("[DualSense] Failed to read calibration: %s\n", strerror(errno));
-        /* Use default calibration */
-        g_ds_calibration.valid = 0;
         return -1;
     }
+    return ret;
+}
+
+/* Load the motion calibration from a calibration report (input thread) */
+static void dualsense_parse_calibration(const ds_calibration_report_t buf) {
+    ds_calibration_t calib;
     
-    printf("[DualSense] Calibration report (%d bytes):", ret);
-    for (int i = 0; i < ret && i < 20; i++) {
+    printf("[DualSense] Calibration report:");
+    for (int i = 0; i < 20; i++) {
         printf(" %02X", buf[i]);
     }
     printf(" ...\n");
@@ -124,61 +178,77 @@ static int dualsense_read_calibration(int fd) {
     /* Calculate gyro calibration (same formula as kernel driver) */
     int speed_2x = gyro_speed_plus + gyro_speed_minus;
     
-    g_ds_calibration.gyro[0].bias = gyro_pitch_bias;
-    g_ds_calibration.gyro[0].sens_numer = speed_2x * DS_GYRO_RES_PER_DEG_S;
-    g_ds_calibration.gyro[0].sens_denom = gyro_pitch_plus - gyro_pitch_minus;
+    calib.gyro[0].bias = gyro_pitch_bias;
+    calib.gyro[0].sens_numer = speed_2x * DS_GYRO_RES_PER_DEG_S;
+    calib.gyro[0].sens_denom = gyro_pitch_plus - gyro_pitch_minus;
     
-    g_ds_calibration.gyro[1].bias = gyro_yaw_bias;
-    g_ds_calibration.gyro[1].sens_numer = speed_2x * DS_GYRO_RES_PER_DEG_S;
-    g_ds_calibration.gyro[1].sens_denom = gyro_yaw_plus - gyro_yaw_minus;
+    calib.gyro[1].bias = gyro_yaw_bias;
+    calib.gyro[1].sens_numer = speed_2x * DS_GYRO_RES_PER_DEG_S;
+    calib.gyro[1].sens_denom = gyro_yaw_plus - gyro_yaw_minus;
     
-    g_ds_calibration.gyro[2].bias = gyro_roll_bias;
-    g_ds_calibration.gyro[2].sens_numer = speed_2x * DS_GYRO_RES_PER_DEG_S;
-    g_ds_calibration.gyro[2].sens_denom = gyro_roll_plus - gyro_roll_minus;
+    calib.gyro[2].bias = gyro_roll_bias;
+    calib.gyro[2].sens_numer = speed_2x * DS_GYRO_RES_PER_DEG_S;
+    calib.gyro[2].sens_denom = gyro_roll_plus - gyro_roll_minus;
     
     /* Calculate accel calibration */
     int range_2g;
     
     range_2g = acc_x_plus - acc_x_minus;
-    g_ds_calibration.accel[0].bias = acc_x_plus - range_2g / 2;
-    g_ds_calibration.accel[0].sens_numer = 2 * DS_ACC_RES_PER_G;
-    g_ds_calibration.accel[0].sens_denom = range_2g;
+    calib.accel[0].bias = acc_x_plus - range_2g / 2;
+    calib.accel[0].sens_numer = 2 * DS_ACC_RES_PER_G;
+    calib.accel[0].sens_denom = range_2g;
     
     range_2g = acc_y_plus - acc_y_minus;
-    g_ds_calibration.accel[1].bias = acc_y_plus - range_2g / 2;
-    g_ds_calibration.accel[1].sens_numer = 2 * DS_ACC_RES_PER_G;
-    g_ds_calibration.accel[1].sens_denom = range_2g;
+    calib.accel[1].bias = acc_y_plus - range_2g / 2;
+    calib.accel[1].sens_numer = 2 * DS_ACC_RES_PER_G;
+    calib.accel[1].sens_denom = range_2g;
     
     range_2g = acc_z_plus - acc_z_minus;
-    g_ds_calibration.accel[2].bias = acc_z_plus - range_2g / 2;
-    g_ds_calibration.accel[2].sens_numer = 2 * DS_ACC_RES_PER_G;
-    g_ds_calibration.accel[2].sens_denom = range_2g;
+    calib.accel[2].bias = acc_z_plus - range_2g / 2;
+    calib.accel[2].sens_numer = 2 * DS_ACC_RES_PER_G;
+    calib.accel[2].sens_denom = range_2g;
     
-    /* Sanity check - avoid division by zero */
+    calib.valid = 1;
+    dualsense_set_calibration(&calib);
+    printf("[DualSense] Calibration loaded (%d axes at nominal)\n", g_ds_motion.fallback_axes);
+}
+
+void dualsense_set_calibration(const ds_calibration_t* calib) {
+    motion_calib_init(&g_ds_motion, &g_ds_motion_spec);
+    if (!calib || !calib->valid) return;
+    
+    /* Kernel units (DS_*_RES_*) to controller_state_t units */
     for (int i = 0; i < 3; i++) {
-        if (g_ds_calibration.gyro[i].sens_denom == 0) {
-            printf("[DualSense] WARNING: Invalid gyro calibration for axis %d\n", i);
-            g_ds_calibration.gyro[i].bias = 0;
-            g_ds_calibration.gyro[i].sens_numer = DS_GYRO_RANGE;
-            g_ds_calibration.gyro[i].sens_denom = 32767;
-        }
-        if (g_ds_calibration.accel[i].sens_denom == 0) {
-            printf("[DualSense] WARNING: Invalid accel calibration for axis %d\n", i);
-            g_ds_calibration.accel[i].bias = 0;
-            g_ds_calibration.accel[i].sens_numer = DS_ACC_RANGE;
-            g_ds_calibration.accel[i].sens_denom = 32767;
-        }
+        motion_calib_set_axis(&g_ds_motion, MOTION_GYRO, i, calib->gyro[i].bias,
+                              (int64_t)calib->gyro[i].sens_numer * CONTROLLER_GYRO_RES_PER_DEG_S,
+                              (int64_t)calib->gyro[i].sens_denom * DS_GYRO_RES_PER_DEG_S);
+        motion_calib_set_axis(&g_ds_motion, MOTION_ACCEL, i, calib->accel[i].bias,
+                              (int64_t)calib->accel[i].sens_numer * CONTROLLER_ACCEL_RES_PER_G,
+                              (int64_t)calib->accel[i].sens_denom * DS_ACC_RES_PER_G);
     }
-    
-    g_ds_calibration.valid = 1;
-    printf("[DualSense] Calibration loaded successfully\n");
+}
+
+/*
+ * Live counterpart of dualsense_parse_calibration(): the report also goes
+ * into the raw capture, if one is running. Called before the input report
+ * it applies to is captured, so a replay calibrates exactly like the live run.
+ */
+static void dualsense_use_calibration(const ds_calibration_report_t buf) {
+    capture_calibration(buf, sizeof(ds_calibration_report_t), time_now_ns(),
+                        DUALSENSE_VID, DUALSENSE_PID);
+    dualsense_parse_calibration(buf);
+}
+
+static int dualsense_load_calibration(const uint8_t* buf, size_t len) {
+    if (len != sizeof(ds_calibration_report_t) || buf[0] != DS_FEATURE_REPORT_CALIBRATION) {
+        return -1;
+    }
+    dualsense_parse_calibration(buf);
     return 0;
 }
 
-/* Apply calibration to raw sensor value */
-static inline int32_t apply_calibration(int16_t raw, const ds_axis_calib_t* calib) {
-    /* calibrated = (raw - bias) * sens_numer / sens_denom */
-    return ((int32_t)(raw - calib->bias) * calib->sens_numer) / calib->sens_denom;
+static const motion_calib_t* dualsense_motion_calib(void) {
+    return &g_ds_motion;
 }
 
 /* ============================================================================
@@ -186,53 +256,139 @@ static inline int32_t apply_calibration(int16_t raw, const ds_axis_calib_t* cali
  * 
  * The kernel hid-playstation driver exposes LEDs via sysfs.
  * We use sysfs for LED control to avoid conflicts with the driver.
+ * The attributes stay open while the controller is connected and are only
+ * written when a value changes (controllers/led_sysfs.h). The kernel sets
+ * its own defaults (blue lightbar, player 1) after connecting; the
+ * maintain hook reads the LEDs back and restores ours if that happens.
+ * 
+ * The LED fds are only touched from the output loop. The input thread
+ * (connect / disconnect) just asks for them to be reopened. send_output()
+ * only queues the wanted state; the writes run from their own event
+ * (flush_deferred), never inside the rumble send.
+ * 
+ * LEDs are looked up in the controller's own sysfs directory
+ * (/sys/class/hidraw/hidrawN/device/leds), trying the names cached for
+ * this controller first; /sys/class/leds is only walked as a fallback.
  * ============================================================================ */
 
-static char g_lightbar_path[512] = "";
-static char g_player_led_paths[5][512] = {"", "", "", "", ""};
+#define DS_PLAYER_LED_COUNT 5
+#define DS_LED_NAME_MAX     64
 
-static void find_led_sysfs_paths(void) {
-    g_lightbar_path[0] = '\0';
-    for (int i = 0; i < 5; i++) {
-        g_player_led_paths[i][0] = '\0';
+/* ============================================================================
+ * FAST RECONNECT CACHE
+ * 
+ * Per controller (controllers/device_cache.h): the raw calibration report
+ * and the LED names. On a hit the calibration is used straight away, so
+ * connecting costs no round trip to the controller; the cache thread reads
+ * the report again and swaps in the new one if it changed. On a miss the
+ * report is read as before.
+ * 
+ * The entry is shared by the input thread (connect), the output loop (LED
+ * names) and the cache thread, so it lives under g_cache_mutex, which is
+ * never held across I/O. The feature report read and the file writes
+ * happen on the cache thread only: nothing on the output loop waits on
+ * them. g_cache_gen counts connects and disconnects; work started for one
+ * connection is dropped if it no longer matches.
+ * ============================================================================ */
+
+#define DS_CACHE_FORMAT     1
+
+typedef struct {
+    char lightbar[DS_LED_NAME_MAX];
+    char player_leds[DS_PLAYER_LED_COUNT][DS_LED_NAME_MAX];
+} ds_led_names_t;
+
+typedef struct {
+    ds_calibration_report_t calibration;
+    ds_led_names_t leds;
+} ds_cache_t;
+
+static pthread_mutex_t g_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cache_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_cache_thread;
+static int g_cache_thread_running = 0;
+
+/* Under g_cache_mutex */
+static ds_cache_t g_cache;
+static device_cache_key_t g_cache_key;
+static int g_cache_key_valid = 0;
+static uint32_t g_cache_gen = 0;
+static char g_hidraw_name[32];
+static int g_cache_revalidate_fd = -1;  /* dup of the hidraw fd: calibration came from the cache */
+static int g_cache_dirty = 0;           /* Entry needs writing */
+static int g_cache_stop = 0;
+
+/* Revalidated calibration, handed from the cache thread to the input thread */
+static ds_calibration_report_t g_calib_update;
+static int g_calib_update_ready = 0;
+
+static led_sysfs_t g_lightbar = LED_SYSFS_INIT;
+static led_sysfs_t g_player_leds[DS_PLAYER_LED_COUNT] = {
+    LED_SYSFS_INIT, LED_SYSFS_INIT, LED_SYSFS_INIT, LED_SYSFS_INIT, LED_SYSFS_INIT
+};
+
+/* What we want shown, reapplied after a kernel override */
+static uint8_t g_want_rgb[3] = {255, 0, 0};
+static uint8_t g_want_player_leds = 0;
+
+/* Set by connect / disconnect: LED numbering may have changed */
+static int g_leds_reopen = 1;
+
+static void close_leds(void) {
+    led_sysfs_close(&g_lightbar);
+    for (int i = 0; i < DS_PLAYER_LED_COUNT; i++) {
+        led_sysfs_close(&g_player_leds[i]);
     }
-    
-    DIR* led_dir = opendir("/sys/class/leds");
+}
+
+/* dir/name into out. @return 0, or -1 if it doesn't fit (never open a cut path) */
+static int led_path_join(char* out, size_t size, const char* dir, const char* name) {
+    int n = snprintf(out, size, "%s/%s", dir, name);
+    return (n < 0 || (size_t)n >= size) ? -1 : 0;
+}
+
+/*
+ * Open the DualSense LEDs in a directory and remember their names.
+ * /sys/class/leds holds every LED in the system, so check_owner makes
+ * sure the link points at a DualSense.
+ */
+static void scan_leds(const char* dir, int check_owner, ds_led_names_t* names) {
+    DIR* led_dir = opendir(dir);
     if (!led_dir) return;
     
     struct dirent* entry;
     while ((entry = readdir(led_dir)) != NULL) {
-        if (entry->d_name[0] == '.') continue;
+        if (entry->d_name[0] == '.' || strlen(entry->d_name) >= DS_LED_NAME_MAX) continue;
         
-        char led_path[512];
-        char led_link[512];
-        snprintf(led_path, sizeof(led_path), "/sys/class/leds/%s", entry->d_name);
+        char led_path[LED_SYSFS_PATH_MAX];
+        if (led_path_join(led_path, sizeof(led_path), dir, entry->d_name) < 0) continue;
         
         /* Check if this LED belongs to a DualSense */
-        ssize_t len = readlink(led_path, led_link, sizeof(led_link) - 1);
-        if (len <= 0) continue;
-        led_link[len] = '\0';
-        
-        if (!strstr(led_link, "054C") || !strstr(led_link, "0CE6")) continue;
+        if (check_owner) {
+            char led_link[512];
+            ssize_t len = readlink(led_path, led_link, sizeof(led_link) - 1);
+            if (len <= 0) continue;
+            led_link[len] = '\0';
+            
+            if (!strstr(led_link, "054C") || !strstr(led_link, "0CE6")) continue;
+        }
         
         /* Lightbar */
         if (strstr(entry->d_name, "rgb:indicator")) {
-            snprintf(g_lightbar_path, sizeof(g_lightbar_path), 
-                     "/sys/class/leds/%s", entry->d_name);
-            printf("[DualSense] Found lightbar: %s\n", g_lightbar_path);
+            if (led_sysfs_open(&g_lightbar, led_path) == 0) {
+                strcpy(names->lightbar, entry->d_name);
+                printf("[DualSense] Found lightbar: %s\n", led_path);
+            }
         }
         /* Player LEDs */
         else if (strstr(entry->d_name, ":white:player-")) {
             int player_num = 0;
             const char* p = strstr(entry->d_name, "player-");
-            if (p && sscanf(p, "player-%d", &player_num) == 1) {
-                if (player_num >= 1 && player_num <= 5) {
-                    snprintf(g_player_led_paths[player_num - 1], 
-                             sizeof(g_player_led_paths[0]),
-                             "/sys/class/leds/%s", entry->d_name);
-                    printf("[DualSense] Found player LED %d: %s\n", 
-                           player_num, g_player_led_paths[player_num - 1]);
-                }
+            if (p && sscanf(p, "player-%d", &player_num) == 1 &&
+                player_num >= 1 && player_num <= DS_PLAYER_LED_COUNT &&
+                led_sysfs_open(&g_player_leds[player_num - 1], led_path) == 0) {
+                strcpy(names->player_leds[player_num - 1], entry->d_name);
+                printf("[DualSense] Found player LED %d: %s\n", player_num, led_path);
             }
         }
     }
@@ -240,63 +396,93 @@ static void find_led_sysfs_paths(void) {
     closedir(led_dir);
 }
 
-static void set_lightbar_sysfs(uint8_t r, uint8_t g, uint8_t b) {
-    if (g_lightbar_path[0] == '\0') {
-        find_led_sysfs_paths();
-        if (g_lightbar_path[0] == '\0') return;
+/* Open the LEDs by their cached names. @return 0 if the lightbar opened */
+static int open_cached_leds(const char* dir, const ds_led_names_t* names) {
+    char led_path[LED_SYSFS_PATH_MAX];
+    
+    if (!names->lightbar[0]) return -1;
+    if (led_path_join(led_path, sizeof(led_path), dir, names->lightbar) < 0 ||
+        led_sysfs_open(&g_lightbar, led_path) < 0) {
+        return -1;
+    }
+    
+    for (int i = 0; i < DS_PLAYER_LED_COUNT; i++) {
+        if (!names->player_leds[i][0] ||
+            led_path_join(led_path, sizeof(led_path), dir, names->player_leds[i]) < 0) {
+            continue;
+        }
+        led_sysfs_open(&g_player_leds[i], led_path);
     }
+    return 0;
+}
+
+static void open_leds(void) {
+    close_leds();
     
-    char path[576];
-    FILE* f;
+    char dir[LED_SYSFS_PATH_MAX];
+    ds_led_names_t names;
+    pthread_mutex_lock(&g_cache_mutex);
+    uint32_t gen = g_cache_gen;
+    snprintf(dir, sizeof(dir), HOTPLUG_SYSFS_HIDRAW "/%s/device/leds", g_hidraw_name);
+    names = g_cache.leds;
+    pthread_mutex_unlock(&g_cache_mutex);
     
-    /* Set color intensities */
-    snprintf(path, sizeof(path), "%s/multi_intensity", g_lightbar_path);
-    f = fopen(path, "w");
-    if (f) {
-        fprintf(f, "%d %d %d", r, g, b);
-        fclose(f);
-    } else {
-        g_lightbar_path[0] = '\0';  /* Path stale, search again */
+    if (open_cached_leds(dir, &names) == 0) {
+        printf("[DualSense] LEDs opened by cached name (%s)\n", names.lightbar);
         return;
     }
+    close_leds();
     
-    /* Set brightness to trigger update */
-    snprintf(path, sizeof(path), "%s/brightness", g_lightbar_path);
-    f = fopen(path, "w");
-    if (f) {
-        fprintf(f, "255");
-        fclose(f);
+    /* Names change with the input number on reconnect - look them up again */
+    memset(&names, 0, sizeof(names));
+    scan_leds(dir, 0, &names);
+    if (!led_sysfs_is_open(&g_lightbar)) {
+        scan_leds("/sys/class/leds", 1, &names);
     }
+    
+    /* Unless the controller changed while we looked */
+    pthread_mutex_lock(&g_cache_mutex);
+    if (gen == g_cache_gen && memcmp(&names, &g_cache.leds, sizeof(names)) != 0) {
+        g_cache.leds = names;
+        g_cache_dirty = 1;
+        pthread_cond_signal(&g_cache_cond);
+    }
+    pthread_mutex_unlock(&g_cache_mutex);
 }
 
-static void set_player_leds_sysfs(uint8_t player_mask) {
-    static int pled_log_count = 0;
-    if (++pled_log_count <= 10) {
-        printf("[DualSense] Setting player LEDs: 0x%02X\n", player_mask);
+/* Push the wanted state; only changed attributes are written */
+static void apply_leds(void) {
+    if (__atomic_exchange_n(&g_leds_reopen, 0, __ATOMIC_ACQ_REL) ||
+        !led_sysfs_is_open(&g_lightbar)) {
+        open_leds();
+        if (!led_sysfs_is_open(&g_lightbar)) return;
     }
     
-    int leds_set = 0;
-    for (int i = 0; i < 5; i++) {
-        if (g_player_led_paths[i][0] == '\0') continue;
-        
-        char path[576];
-        snprintf(path, sizeof(path), "%s/brightness", g_player_led_paths[i]);
-        
-        FILE* f = fopen(path, "w");
-        if (f) {
-            int on = (player_mask & (1 << i)) ? 255 : 0;
-            fprintf(f, "%d", on);
-            fclose(f);
-            leds_set++;
-            if (pled_log_count <= 5) {
-                printf("[DualSense] LED %d = %d (path: %s)\n", i+1, on, path);
-            }
-        }
+    if (led_sysfs_set_rgb(&g_lightbar, g_want_rgb[0], g_want_rgb[1], g_want_rgb[2]) < 0) {
+        close_leds();  /* LEDs gone (reconnect renumbers them), search again */
+        return;
     }
     
-    if (pled_log_count <= 5 && leds_set == 0) {
-        printf("[DualSense] WARNING: No player LED paths found!\n");
+    for (int i = 0; i < DS_PLAYER_LED_COUNT; i++) {
+        if (!led_sysfs_is_open(&g_player_leds[i])) continue;
+        led_sysfs_set(&g_player_leds[i], (g_want_player_leds & (1 << i)) ? 255 : 0);
+    }
+}
+
+/* Queue the wanted state; applied from its own output loop event */
+static void set_leds(uint8_t r, uint8_t g, uint8_t b, uint8_t player_mask) {
+    if (player_mask != g_want_player_leds) {
+        static int pled_log_count = 0;
+        if (++pled_log_count <= 10) {
+            printf("[DualSense] Setting player LEDs: 0x%02X\n", player_mask);
+        }
     }
+    
+    g_want_rgb[0] = r;
+    g_want_rgb[1] = g;
+    g_want_rgb[2] = b;
+    g_want_player_leds = player_mask;
+    controller_output_defer();      /* -> dualsense_flush_leds() */
 }
 
 /* ============================================================================
@@ -329,107 +515,238 @@ static const controller_info_t dualsense_info = {
  * DRIVER IMPLEMENTATION
  * ============================================================================ */
 
+/*
+ * Cache thread: checks a cached calibration against the controller and
+ * writes the entry when it changed. The report read is a round trip to the
+ * controller, so it runs here rather than anywhere rumble or input waits.
+ */
+static void* dualsense_cache_thread(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_cache_mutex);
+    while (!g_cache_stop) {
+        if (g_cache_revalidate_fd < 0 && !g_cache_dirty) {
+            pthread_cond_wait(&g_cache_cond, &g_cache_mutex);
+            continue;
+        }
+        uint32_t gen = g_cache_gen;
+        
+        int fd = g_cache_revalidate_fd;
+        if (fd >= 0) {
+            g_cache_revalidate_fd = -1;
+            pthread_mutex_unlock(&g_cache_mutex);
+            ds_calibration_report_t report;
+            int ok = dualsense_get_calibration_report(fd, report) >= 0;
+            close(fd);
+            pthread_mutex_lock(&g_cache_mutex);
+            
+            if (ok && gen == g_cache_gen &&
+                memcmp(report, g_cache.calibration, sizeof(report)) != 0) {
+                printf("[DualSense] Calibration differs from the cached one - updating\n");
+                memcpy(g_calib_update, report, sizeof(report));
+                __atomic_store_n(&g_calib_update_ready, 1, __ATOMIC_RELEASE);
+                memcpy(g_cache.calibration, report, sizeof(report));
+                g_cache_dirty = 1;
+            }
+            continue;
+        }
+        
+        g_cache_dirty = 0;
+        if (!g_cache_key_valid) continue;
+        ds_cache_t entry = g_cache;
+        device_cache_key_t key = g_cache_key;
+        pthread_mutex_unlock(&g_cache_mutex);
+        if (device_cache_store(&key, DS_CACHE_FORMAT, &entry, sizeof(entry)) == 0) {
+            printf("[DualSense] Saved reconnect cache for %s\n", key.uniq);
+        }
+        pthread_mutex_lock(&g_cache_mutex);
+    }
+    pthread_mutex_unlock(&g_cache_mutex);
+    return NULL;
+}
+
 static int dualsense_init(void) {
-    init_crc32_table();
+    dualsense_crc_init();
+    motion_calib_init(&g_ds_motion, &g_ds_motion_spec);
+    
+    g_cache_stop = 0;
+    if (pthread_create(&g_cache_thread, NULL, dualsense_cache_thread, NULL) != 0) {
+        perror("[DualSense] pthread_create");
+        return -1;
+    }
+    g_cache_thread_running = 1;
+    
     printf("[DualSense] Driver initialized\n");
     return 0;
 }
 
 static void dualsense_shutdown(void) {
+    if (g_cache_thread_running) {
+        pthread_mutex_lock(&g_cache_mutex);
+        g_cache_stop = 1;
+        pthread_cond_signal(&g_cache_cond);
+        pthread_mutex_unlock(&g_cache_mutex);
+        pthread_join(g_cache_thread, NULL);
+        g_cache_thread_running = 0;
+    }
+    if (g_cache_revalidate_fd >= 0) {
+        close(g_cache_revalidate_fd);
+        g_cache_revalidate_fd = -1;
+    }
     printf("[DualSense] Driver shutdown\n");
 }
 
-static int dualsense_find_device(void) {
-    DIR* dir = opendir("/dev");
-    if (!dir) return -1;
+static int dualsense_open_device(const char* devnode) {
+    uint64_t start_ns = time_now_ns();
+    int fd = open(devnode, O_RDWR);
+    if (fd < 0) {
+        perror("[DualSense] open");
+        return -1;
+    }
     
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strncmp(entry->d_name, "hidraw", 6) != 0) continue;
-        
-        char path[272];
-        snprintf(path, sizeof(path), "/dev/%s", entry->d_name);
-        
-        int fd = open(path, O_RDWR);
-        if (fd < 0) continue;
-        
-        struct hidraw_devinfo info;
-        if (ioctl(fd, HIDIOCGRAWINFO, &info) < 0) {
-            close(fd);
-            continue;
-        }
-        
-        if (info.vendor == DUALSENSE_VID && info.product == DUALSENSE_PID) {
-            char name[256] = "";
-            ioctl(fd, HIDIOCGRAWNAME(sizeof(name)), name);
-            printf("[DualSense] Found: %s (%s) bus=%d\n", name, path, info.bustype);
-            
-            /* Read calibration data from controller */
-            dualsense_read_calibration(fd);
-            
-            /* Find LED sysfs paths */
-            find_led_sysfs_paths();
-            
-            /* Set initial lightbar color */
-            set_lightbar_sysfs(255, 0, 0);  /* Red */
-            
-            closedir(dir);
-            return fd;
-        }
+    /* The registry matched the IDs from sysfs; make sure the node is still it */
+    struct hidraw_devinfo info;
+    if (ioctl(fd, HIDIOCGRAWINFO, &info) < 0 ||
+        info.vendor != DUALSENSE_VID || info.product != DUALSENSE_PID) {
         close(fd);
+        return -1;
+    }
+    
+    char name[256] = "";
+    ioctl(fd, HIDIOCGRAWNAME(sizeof(name)), name);
+    printf("[DualSense] Found: %s (%s) bus=%d\n", name, devnode, info.bustype);
+    
+    /* Calibration: cached if we've seen this controller, else ask it */
+    ds_cache_t entry;
+    device_cache_key_t key;
+    int key_valid = device_cache_key(fd, info.vendor, info.product, &key) == 0;
+    int cached = key_valid &&
+                 device_cache_load(&key, DS_CACHE_FORMAT, &entry, sizeof(entry)) == 0;
+    int calibrated = cached;
+    if (!cached) {
+        memset(&entry, 0, sizeof(entry));
+        calibrated = dualsense_get_calibration_report(fd, entry.calibration) >= 0;
+        if (!calibrated) key_valid = 0;     /* Nothing worth caching */
     }
     
-    closedir(dir);
-    return -1;
+    /* Publish the entry; anything still running for the last connection is dropped */
+    const char* base = strrchr(devnode, '/');
+    pthread_mutex_lock(&g_cache_mutex);
+    g_cache_gen++;
+    g_cache = entry;
+    g_cache_key = key;
+    g_cache_key_valid = key_valid;
+    snprintf(g_hidraw_name, sizeof(g_hidraw_name), "%s", base ? base + 1 : devnode);
+    __atomic_store_n(&g_calib_update_ready, 0, __ATOMIC_RELAXED);
+    if (g_cache_revalidate_fd >= 0) close(g_cache_revalidate_fd);
+    g_cache_revalidate_fd = cached ? dup(fd) : -1;
+    g_cache_dirty = !cached && calibrated;
+    pthread_cond_signal(&g_cache_cond);
+    pthread_mutex_unlock(&g_cache_mutex);
+    
+    if (calibrated) {
+        dualsense_use_calibration(entry.calibration);
+    } else {
+        dualsense_set_calibration(NULL);    /* Nominal sensitivity */
+    }
+    
+    /* Initial lightbar color, applied by the output loop */
+    g_want_rgb[0] = 255;  /* Red */
+    g_want_rgb[1] = 0;
+    g_want_rgb[2] = 0;
+    __atomic_store_n(&g_leds_reopen, 1, __ATOMIC_RELEASE);
+    
+    printf("[DualSense] Ready in %.1f ms (%s)\n", (time_now_ns() - start_ns) / 1e6,
+           cached ? "cached calibration" : "calibration read from controller");
+    return fd;
 }
 
-static int dualsense_match_device(uint16_t vid, uint16_t pid) {
-    return (vid == DUALSENSE_VID && pid == DUALSENSE_PID);
+/* ============================================================================
+ * BUTTON DECODING
+ * 
+ * Each button byte is decoded with one lookup into a table built at
+ * compile time, instead of a D-pad switch plus a test per button.
+ * ============================================================================ */
+
+#define DS_B(btn)   (1u << (btn))
+#define DS_IF(v, mask, btn) (((v) & (mask)) ? DS_B(btn) : 0)
+
+/* D-pad hat (low nibble of buttons1): 0 = N, clockwise to 7 = NW, 8+ = centered */
+#define DS_DPAD(h) \
+    ((h) == 0 ? DS_B(BTN_DPAD_UP) : \
+     (h) == 1 ? DS_B(BTN_DPAD_UP)   | DS_B(BTN_DPAD_RIGHT) : \
+     (h) == 2 ? DS_B(BTN_DPAD_RIGHT) : \
+     (h) == 3 ? DS_B(BTN_DPAD_DOWN) | DS_B(BTN_DPAD_RIGHT) : \
+     (h) == 4 ? DS_B(BTN_DPAD_DOWN) : \
+     (h) == 5 ? DS_B(BTN_DPAD_DOWN) | DS_B(BTN_DPAD_LEFT) : \
+     (h) == 6 ? DS_B(BTN_DPAD_LEFT) : \
+     (h) == 7 ? DS_B(BTN_DPAD_UP)   | DS_B(BTN_DPAD_LEFT) : 0)
+
+#define DS_BUTTONS1(v) (DS_DPAD((v) & 0x0F) | \
+    DS_IF(v, DS_BTN1_CROSS, BTN_SOUTH)  | DS_IF(v, DS_BTN1_CIRCLE, BTN_EAST) | \
+    DS_IF(v, DS_BTN1_SQUARE, BTN_WEST)  | DS_IF(v, DS_BTN1_TRIANGLE, BTN_NORTH))
+
+#define DS_BUTTONS2(v) ( \
+    DS_IF(v, DS_BTN2_L1, BTN_L1)        | DS_IF(v, DS_BTN2_R1, BTN_R1) | \
+    DS_IF(v, DS_BTN2_L2, BTN_L2)        | DS_IF(v, DS_BTN2_R2, BTN_R2) | \
+    DS_IF(v, DS_BTN2_L3, BTN_L3)        | DS_IF(v, DS_BTN2_R3, BTN_R3) | \
+    DS_IF(v, DS_BTN2_CREATE, BTN_SELECT) | DS_IF(v, DS_BTN2_OPTIONS, BTN_START))
+
+#define DS_BUTTONS3(v) ( \
+    DS_IF(v, DS_BTN3_PS, BTN_HOME)      | DS_IF(v, DS_BTN3_TOUCHPAD, BTN_TOUCHPAD) | \
+    DS_IF(v, DS_BTN3_MUTE, BTN_MUTE))
+
+#define DS_ROW(f, r) \
+    f(r + 0x0), f(r + 0x1), f(r + 0x2), f(r + 0x3), \
+    f(r + 0x4), f(r + 0x5), f(r + 0x6), f(r + 0x7), \
+    f(r + 0x8), f(r + 0x9), f(r + 0xA), f(r + 0xB), \
+    f(r + 0xC), f(r + 0xD), f(r + 0xE), f(r + 0xF)
+
+#define DS_TABLE(f) \
+    DS_ROW(f, 0x00), DS_ROW(f, 0x10), DS_ROW(f, 0x20), DS_ROW(f, 0x30), \
+    DS_ROW(f, 0x40), DS_ROW(f, 0x50), DS_ROW(f, 0x60), DS_ROW(f, 0x70), \
+    DS_ROW(f, 0x80), DS_ROW(f, 0x90), DS_ROW(f, 0xA0), DS_ROW(f, 0xB0), \
+    DS_ROW(f, 0xC0), DS_ROW(f, 0xD0), DS_ROW(f, 0xE0), DS_ROW(f, 0xF0)
+
+static const uint32_t g_ds_buttons1_map[256] = { DS_TABLE(DS_BUTTONS1) };
+static const uint32_t g_ds_buttons2_map[256] = { DS_TABLE(DS_BUTTONS2) };
+static const uint32_t g_ds_buttons3_map[256] = { DS_TABLE(DS_BUTTONS3) };
+
+uint32_t dualsense_map_buttons(const uint8_t* buttons) {
+    return g_ds_buttons1_map[buttons[0]] |
+           g_ds_buttons2_map[buttons[1]] |
+           g_ds_buttons3_map[buttons[2]];
 }
 
 /* D-pad parsing helper */
 void dualsense_parse_dpad(uint8_t buttons1, controller_state_t* out_state) {
-    uint8_t dpad = buttons1 & 0x0F;
-    
-    switch (dpad) {
-        case 0: /* N */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_UP);
-            break;
-        case 1: /* NE */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_UP);
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_RIGHT);
-            break;
-        case 2: /* E */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_RIGHT);
-            break;
-        case 3: /* SE */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_DOWN);
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_RIGHT);
-            break;
-        case 4: /* S */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_DOWN);
-            break;
-        case 5: /* SW */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_DOWN);
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_LEFT);
-            break;
-        case 6: /* W */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_LEFT);
-            break;
-        case 7: /* NW */
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_UP);
-            CONTROLLER_BTN_SET(out_state, BTN_DPAD_LEFT);
-            break;
-        /* 8+ = centered, no buttons */
-    }
+    out_state->buttons |= g_ds_buttons1_map[buttons1 & 0x0F];
 }
 
+/* Extended sensor clock (input thread only) */
+static uint64_t g_sensor_ticks = 0;
+static uint32_t g_sensor_ticks_last = 0;
+static int g_sensor_ticks_valid = 0;
+
 static int dualsense_process_input(const uint8_t* buf, size_t len, 
                                    controller_state_t* out_state) {
     if (len < 12 || buf[DS_OFF_REPORT_ID] != DS_BT_REPORT_ID) {
         return -1;
     }
     
+    /* Drop corrupted Bluetooth frames before they reach the state */
+    if (len >= DS_BT_INPUT_SIZE && !dualsense_check_input_crc(buf)) {
+        uint64_t errors = __atomic_add_fetch(&g_crc_errors, 1, __ATOMIC_RELAXED);
+        
+        /* Log the 1st, 10th, 100th... */
+        uint64_t n = errors;
+        while (n % 10 == 0) n /= 10;
+        if (n == 1) {
+            printf("[DualSense] Input report CRC mismatch (%llu dropped)\n",
+                   (unsigned long long)errors);
+        }
+        return -1;
+    }
+    
     /* Clear state */
     memset(out_state, 0, sizeof(*out_state));
     out_state->left_stick_x = 128;
@@ -443,75 +760,40 @@ static int dualsense_process_input(const uint8_t* buf, size_t len,
     out_state->right_stick_x = buf[DS_OFF_RX];
     out_state->right_stick_y = buf[DS_OFF_RY];
     
+    /* Runtime options (core/config.h) - one consistent set per report */
+    adapter_config_t config;
+    config_get(&config);
+    
     /* Apply deadzone */
-    #define DEADZONE 6
-    out_state->left_stick_x = CONTROLLER_APPLY_DEADZONE(out_state->left_stick_x, DEADZONE);
-    out_state->left_stick_y = CONTROLLER_APPLY_DEADZONE(out_state->left_stick_y, DEADZONE);
-    out_state->right_stick_x = CONTROLLER_APPLY_DEADZONE(out_state->right_stick_x, DEADZONE);
-    out_state->right_stick_y = CONTROLLER_APPLY_DEADZONE(out_state->right_stick_y, DEADZONE);
+    int deadzone = config.stick_deadzone;
+    out_state->left_stick_x = CONTROLLER_APPLY_DEADZONE(out_state->left_stick_x, deadzone);
+    out_state->left_stick_y = CONTROLLER_APPLY_DEADZONE(out_state->left_stick_y, deadzone);
+    out_state->right_stick_x = CONTROLLER_APPLY_DEADZONE(out_state->right_stick_x, deadzone);
+    out_state->right_stick_y = CONTROLLER_APPLY_DEADZONE(out_state->right_stick_y, deadzone);
     
     /* Triggers */
     out_state->left_trigger = buf[DS_OFF_L2];
     out_state->right_trigger = buf[DS_OFF_R2];
     
-    /* Buttons */
-    uint8_t buttons1 = buf[DS_OFF_BUTTONS1];
-    uint8_t buttons2 = buf[DS_OFF_BUTTONS2];
-    uint8_t buttons3 = buf[DS_OFF_BUTTONS3];
-    
-    /* D-pad */
-    dualsense_parse_dpad(buttons1, out_state);
-    
-    /* Face buttons */
-    if (buttons1 & DS_BTN1_CROSS)    CONTROLLER_BTN_SET(out_state, BTN_SOUTH);
-    if (buttons1 & DS_BTN1_CIRCLE)   CONTROLLER_BTN_SET(out_state, BTN_EAST);
-    if (buttons1 & DS_BTN1_SQUARE)   CONTROLLER_BTN_SET(out_state, BTN_WEST);
-    if (buttons1 & DS_BTN1_TRIANGLE) CONTROLLER_BTN_SET(out_state, BTN_NORTH);
-    
-    /* Shoulder buttons */
-    if (buttons2 & DS_BTN2_L1) CONTROLLER_BTN_SET(out_state, BTN_L1);
-    if (buttons2 & DS_BTN2_R1) CONTROLLER_BTN_SET(out_state, BTN_R1);
-    if (buttons2 & DS_BTN2_L2) CONTROLLER_BTN_SET(out_state, BTN_L2);
-    if (buttons2 & DS_BTN2_R2) CONTROLLER_BTN_SET(out_state, BTN_R2);
-    
-    /* Stick clicks */
-    if (buttons2 & DS_BTN2_L3) CONTROLLER_BTN_SET(out_state, BTN_L3);
-    if (buttons2 & DS_BTN2_R3) CONTROLLER_BTN_SET(out_state, BTN_R3);
-    
-    /* Center buttons */
-    if (buttons2 & DS_BTN2_CREATE)  CONTROLLER_BTN_SET(out_state, BTN_SELECT);
-    if (buttons2 & DS_BTN2_OPTIONS) CONTROLLER_BTN_SET(out_state, BTN_START);
-    if (buttons3 & DS_BTN3_PS)      CONTROLLER_BTN_SET(out_state, BTN_HOME);
-    if (buttons3 & DS_BTN3_TOUCHPAD) CONTROLLER_BTN_SET(out_state, BTN_TOUCHPAD);
-    if (buttons3 & DS_BTN3_MUTE)    CONTROLLER_BTN_SET(out_state, BTN_MUTE);
+    /* Buttons - kept raw too, for the DS3 fast path (console/ps3/ds3_transcode.h) */
+    out_state->native_format = CONTROLLER_NATIVE_DUALSENSE;
+    out_state->native_buttons[0] = buf[DS_OFF_BUTTONS1];
+    out_state->native_buttons[1] = buf[DS_OFF_BUTTONS2];
+    out_state->native_buttons[2] = buf[DS_OFF_BUTTONS3];
+    out_state->buttons = dualsense_map_buttons(out_state->native_buttons);
     
     /* Motion sensors */
-    if (len >= 28) {
-        int16_t raw_gyro_x  = (int16_t)(buf[DS_OFF_GYRO_X] | (buf[DS_OFF_GYRO_X + 1] << 8));
-        int16_t raw_gyro_y  = (int16_t)(buf[DS_OFF_GYRO_Y] | (buf[DS_OFF_GYRO_Y + 1] << 8));
-        int16_t raw_gyro_z  = (int16_t)(buf[DS_OFF_GYRO_Z] | (buf[DS_OFF_GYRO_Z + 1] << 8));
-        int16_t raw_accel_x = (int16_t)(buf[DS_OFF_ACCEL_X] | (buf[DS_OFF_ACCEL_X + 1] << 8));
-        int16_t raw_accel_y = (int16_t)(buf[DS_OFF_ACCEL_Y] | (buf[DS_OFF_ACCEL_Y + 1] << 8));
-        int16_t raw_accel_z = (int16_t)(buf[DS_OFF_ACCEL_Z] | (buf[DS_OFF_ACCEL_Z + 1] << 8));
-        
-        if (g_ds_calibration.valid) {
-            /* Apply calibration: output is in DS_GYRO_RES_PER_DEG_S (1024) units per deg/s
-             * and DS_ACC_RES_PER_G (8192) units per g */
-            out_state->gyro_x  = (int16_t)apply_calibration(raw_gyro_x, &g_ds_calibration.gyro[0]);
-            out_state->gyro_y  = (int16_t)apply_calibration(raw_gyro_y, &g_ds_calibration.gyro[1]);
-            out_state->gyro_z  = (int16_t)apply_calibration(raw_gyro_z, &g_ds_calibration.gyro[2]);
-            out_state->accel_x = (int16_t)apply_calibration(raw_accel_x, &g_ds_calibration.accel[0]);
-            out_state->accel_y = (int16_t)apply_calibration(raw_accel_y, &g_ds_calibration.accel[1]);
-            out_state->accel_z = (int16_t)apply_calibration(raw_accel_z, &g_ds_calibration.accel[2]);
-        } else {
-            /* No calibration - use raw values */
-            out_state->gyro_x  = raw_gyro_x;
-            out_state->gyro_y  = raw_gyro_y;
-            out_state->gyro_z  = raw_gyro_z;
-            out_state->accel_x = raw_accel_x;
-            out_state->accel_y = raw_accel_y;
-            out_state->accel_z = raw_accel_z;
+    if (__atomic_load_n(&g_calib_update_ready, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&g_calib_update_ready, 0, __ATOMIC_RELAXED);
+        dualsense_use_calibration(g_calib_update);
+    }
+    if (len >= DS_OFF_ACCEL_Z + 2) {
+        int16_t raw_gyro[3], raw_accel[3];
+        for (int i = 0; i < 3; i++) {
+            raw_gyro[i] = (int16_t)(buf[DS_OFF_GYRO_X + 2 * i] | (buf[DS_OFF_GYRO_X + 2 * i + 1] << 8));
+            raw_accel[i] = (int16_t)(buf[DS_OFF_ACCEL_X + 2 * i] | (buf[DS_OFF_ACCEL_X + 2 * i + 1] << 8));
         }
+        motion_calib_apply(&g_ds_motion, raw_accel, raw_gyro, out_state);
     }
     
     /* Touchpad */
@@ -534,7 +816,7 @@ static int dualsense_process_input(const uint8_t* buf, size_t len,
         static int touch_initial_y = 0;
         static int touch_was_active = 0;
         
-        if (out_state->touch[0].active) {
+        if (out_state->touch[0].active && config.touchpad_stick) {
             int touch_x = out_state->touch[0].x;
             int touch_y = out_state->touch[0].y;
             
@@ -549,8 +831,8 @@ static int dualsense_process_input(const uint8_t* buf, size_t len,
             int delta_x = touch_x - touch_initial_x;
             int delta_y = touch_y - touch_initial_y;
             
-            /* Convert to stick value (sensitivity: 400 pixels = full deflection) */
-            int sensitivity = 400;
+            /* Convert to stick value (touchpad_range pixels = full deflection) */
+            int sensitivity = config.touchpad_range;
             int stick_x = 128 + (delta_x * 127) / sensitivity;
             int stick_y = 128 + (delta_y * 127) / sensitivity;
             
@@ -585,7 +867,30 @@ static int dualsense_process_input(const uint8_t* buf, size_t len,
         out_state->battery_full = (charging_status == 0x2) ? 1 : 0;
     }
     
-    out_state->timestamp_ms = time_get_ms();
+    /* Device timing: sequence number and sensor sample clock */
+    out_state->sequence = buf[DS_OFF_SEQUENCE];
+    out_state->timing_flags |= CONTROLLER_TIMING_SEQUENCE;
+    
+    if (len >= DS_OFF_SENSOR_TIMESTAMP + 4) {
+        uint32_t ticks = (uint32_t)buf[DS_OFF_SENSOR_TIMESTAMP] |
+                         ((uint32_t)buf[DS_OFF_SENSOR_TIMESTAMP + 1] << 8) |
+                         ((uint32_t)buf[DS_OFF_SENSOR_TIMESTAMP + 2] << 16) |
+                         ((uint32_t)buf[DS_OFF_SENSOR_TIMESTAMP + 3] << 24);
+        
+        /* 32-bit tick counter wraps every ~24 minutes - extend to 64 bits */
+        if (g_sensor_ticks_valid) {
+            g_sensor_ticks += (uint32_t)(ticks - g_sensor_ticks_last);
+        } else {
+            g_sensor_ticks = ticks;
+            g_sensor_ticks_valid = 1;
+        }
+        g_sensor_ticks_last = ticks;
+        
+        out_state->sensor_time_ns = g_sensor_ticks * 1000 / DS_SENSOR_TICKS_PER_US;
+        out_state->timing_flags |= CONTROLLER_TIMING_SENSOR_CLOCK;
+    }
+    
+    out_state->timestamp_ns = time_now_ns();
     
     return 0;
 }
@@ -593,41 +898,7 @@ static int dualsense_process_input(const uint8_t* buf, size_t len,
 /* Output report sequence counter */
 static uint8_t output_seq = 0;
 
-/* Cached LED state for change detection */
-static uint8_t last_led_r = 255, last_led_g = 255, last_led_b = 255;
-static uint8_t last_player_leds = 0xFF;
-
-static int dualsense_send_output(int fd, const controller_output_t* output) {
-    /* 
-     * LED control via sysfs.
-     * We refresh every call to fight against the kernel driver's defaults.
-     * The kernel hid-playstation driver sets blue + player 1, so we override.
-     */
-    static int led_refresh_counter = 0;
-    led_refresh_counter++;
-    
-    /* Force refresh every 10 calls (~100ms at 100Hz) to fight kernel driver */
-    int force_refresh = (led_refresh_counter >= 10);
-    if (force_refresh) {
-        led_refresh_counter = 0;
-    }
-    
-    if (force_refresh || 
-        output->led_r != last_led_r || 
-        output->led_g != last_led_g || 
-        output->led_b != last_led_b) {
-        set_lightbar_sysfs(output->led_r, output->led_g, output->led_b);
-        last_led_r = output->led_r;
-        last_led_g = output->led_g;
-        last_led_b = output->led_b;
-    }
-    
-    if (force_refresh || output->player_leds != last_player_leds) {
-        set_player_leds_sysfs(output->player_leds);
-        last_player_leds = output->player_leds;
-    }
-    
-    /* Rumble via hidraw */
+static int dualsense_send_rumble(int fd, const controller_output_t* output) {
     if (fd < 0) return -1;
     
     uint8_t report[DS_BT_OUTPUT_SIZE] = {0};
@@ -641,11 +912,8 @@ static int dualsense_send_output(int fd, const controller_output_t* output) {
     report[5] = output->rumble_right;
     report[6] = output->rumble_left;
     
-    /* Calculate CRC32 */
-    uint8_t crc_buf[75];
-    crc_buf[0] = 0xA2;  /* BT output report header */
-    memcpy(&crc_buf[1], report, 74);
-    uint32_t crc = dualsense_calc_crc32(crc_buf, 75);
+    /* CRC32 over the 0xA2 header (seed) and the report */
+    uint32_t crc = crc32_extend(g_crc_output_seed, report, DS_BT_OUTPUT_SIZE - DS_BT_CRC_SIZE);
     
     report[74] = crc & 0xFF;
     report[75] = (crc >> 8) & 0xFF;
@@ -656,29 +924,69 @@ static int dualsense_send_output(int fd, const controller_output_t* output) {
     return (written > 0) ? 0 : -1;
 }
 
+static int dualsense_send_output(int fd, const controller_output_t* output) {
+    /* LEDs via sysfs are only queued - their writes must not delay rumble */
+    set_leds(output->led_r, output->led_g, output->led_b, output->player_leds);
+    return dualsense_send_rumble(fd, output);
+}
+
+static void dualsense_flush_leds(int fd) {
+    (void)fd;
+    apply_leds();   /* No-op unless something changed */
+}
+
+static void dualsense_maintain(int fd) {
+    (void)fd;
+    
+    /* Newly connected: open the LEDs and show our state */
+    if (__atomic_load_n(&g_leds_reopen, __ATOMIC_ACQUIRE)) {
+        apply_leds();
+        return;
+    }
+    
+    /* Restore LEDs the kernel driver changed behind our back */
+    int overridden = 0;
+    if (led_sysfs_check(&g_lightbar) > 0) overridden = 1;
+    for (int i = 0; i < DS_PLAYER_LED_COUNT; i++) {
+        if (led_sysfs_check(&g_player_leds[i]) > 0) overridden = 1;
+    }
+    
+    if (overridden) {
+        static int override_log_count = 0;
+        if (++override_log_count <= 5) {
+            printf("[DualSense] LEDs changed by the kernel driver - restoring\n");
+        }
+        apply_leds();
+    }
+}
+
 static void dualsense_on_disconnect(void) {
     printf("[DualSense] Disconnected\n");
     
-    /* Reset LED cache */
-    last_led_r = 255;
-    last_led_g = 255;
-    last_led_b = 255;
-    last_player_leds = 0xFF;
+    /* Sensor clock restarts with the controller */
+    g_sensor_ticks_valid = 0;
     
-    /* Clear sysfs paths (device might get new input number on reconnect) */
-    g_lightbar_path[0] = '\0';
+    /* Nothing left to check against this controller */
+    pthread_mutex_lock(&g_cache_mutex);
+    g_cache_gen++;
+    if (g_cache_revalidate_fd >= 0) {
+        close(g_cache_revalidate_fd);
+        g_cache_revalidate_fd = -1;
+    }
+    pthread_mutex_unlock(&g_cache_mutex);
+    
+    /* Reopen the LEDs next time (device might get new input number on reconnect) */
+    __atomic_store_n(&g_leds_reopen, 1, __ATOMIC_RELEASE);
 }
 
 static void dualsense_enter_low_power(int fd) {
     printf("[DualSense] Entering low power mode\n");
     
-    /* Turn off LEDs */
-    set_lightbar_sysfs(0, 0, 0);
-    set_player_leds_sysfs(0);
-    
-    /* Stop rumble */
+    /* Stop rumble, turn off LEDs - now, the output loop has stopped */
     controller_output_t off = {0};
-    dualsense_send_output(fd, &off);
+    dualsense_send_rumble(fd, &off);
+    set_leds(0, 0, 0, 0);
+    apply_leds();
 }
 
 /* ============================================================================
@@ -689,12 +997,15 @@ static const controller_driver_t dualsense_driver = {
     .info = &dualsense_info,
     .init = dualsense_init,
     .shutdown = dualsense_shutdown,
-    .find_device = dualsense_find_device,
-    .match_device = dualsense_match_device,
+    .open_device = dualsense_open_device,
     .process_input = dualsense_process_input,
     .send_output = dualsense_send_output,
+    .flush_deferred = dualsense_flush_leds,
     .on_disconnect = dualsense_on_disconnect,
-    .enter_low_power = dualsense_enter_low_power
+    .enter_low_power = dualsense_enter_low_power,
+    .maintain = dualsense_maintain,
+    .motion_calib = dualsense_motion_calib,
+    .load_calibration = dualsense_load_calibration
 };
 
 const controller_driver_t* dualsense_get_driver(void) {
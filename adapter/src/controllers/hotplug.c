@@ -0,0 +1,133 @@
+/*
+ * RosettaPad - Controller Hotplug
+ * ================================
+ *
+ * Kernel uevent messages are "ACTION@DEVPATH" followed by NUL-separated
+ * KEY=VALUE properties. Only messages from the kernel itself (sender port
+ * 0, multicast group 1) are accepted; udev rebroadcasts use group 2.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#include "core/common.h"
+#include "controllers/hotplug.h"
+
+#define UEVENT_BUFFER_SIZE      4096
+#define UEVENT_KERNEL_GROUP     1
+
+int hotplug_open(void) {
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        perror("[Hotplug] socket");
+        return -1;
+    }
+    
+    struct sockaddr_nl addr = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = UEVENT_KERNEL_GROUP,
+    };
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("[Hotplug] bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int hotplug_hidraw_ids(const char* devname, uint16_t* bus, uint16_t* vid, uint16_t* pid) {
+    char path[128];
+    snprintf(path, sizeof(path), HOTPLUG_SYSFS_HIDRAW "/%s/device/uevent", devname);
+    
+    FILE* f = fopen(path, "re");
+    if (!f) return -1;
+    
+    char line[256];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        unsigned int b, v, p;
+        if (sscanf(line, "HID_ID=%x:%x:%x", &b, &v, &p) == 3) {
+            *bus = (uint16_t)b;
+            *vid = (uint16_t)v;
+            *pid = (uint16_t)p;
+            found = 1;
+        }
+    }
+    fclose(f);
+    return found ? 0 : -1;
+}
+
+/* Parse one message. @return 1 if it was a hidraw add/remove */
+static int parse_uevent(const char* buf, size_t len, hotplug_event_t* ev) {
+    const char* action = NULL;
+    const char* subsystem = NULL;
+    const char* devname = NULL;
+    
+    /* Skip the "ACTION@DEVPATH" summary, then walk KEY=VALUE pairs */
+    for (size_t pos = strnlen(buf, len) + 1; pos < len; pos += strnlen(buf + pos, len - pos) + 1) {
+        const char* kv = buf + pos;
+        if (strncmp(kv, "ACTION=", 7) == 0) action = kv + 7;
+        else if (strncmp(kv, "SUBSYSTEM=", 10) == 0) subsystem = kv + 10;
+        else if (strncmp(kv, "DEVNAME=", 8) == 0) devname = kv + 8;
+    }
+    
+    if (!action || !subsystem || !devname || strcmp(subsystem, "hidraw") != 0) return 0;
+    
+    /* DEVNAME is relative to /dev ("hidraw3") */
+    const char* base = strrchr(devname, '/');
+    base = base ? base + 1 : devname;
+    if (strlen(base) >= sizeof(ev->devname)) return 0;
+    
+    memset(ev, 0, sizeof(*ev));
+    if (strcmp(action, "add") == 0) {
+        ev->action = HOTPLUG_ADD;
+    } else if (strcmp(action, "remove") == 0) {
+        ev->action = HOTPLUG_REMOVE;
+    } else {
+        return 0;
+    }
+    strcpy(ev->devname, base);
+    snprintf(ev->devnode, sizeof(ev->devnode), "/dev/%s", base);
+    
+    if (ev->action == HOTPLUG_ADD) {
+        hotplug_hidraw_ids(ev->devname, &ev->bus, &ev->vendor_id, &ev->product_id);
+    }
+    return 1;
+}
+
+int hotplug_next(int fd, hotplug_event_t* ev) {
+    char buf[UEVENT_BUFFER_SIZE];
+    
+    for (;;) {
+        struct sockaddr_nl sender;
+        struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) - 1 };
+        struct msghdr msg = {
+            .msg_name = &sender,
+            .msg_namelen = sizeof(sender),
+            .msg_iov = &iov,
+            .msg_iovlen = 1,
+        };
+        
+        ssize_t n = recvmsg(fd, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS) {
+                printf("[Hotplug] uevent overrun, some events were lost\n");
+                return -1;
+            }
+            return 0;
+        }
+        if (n == 0 || sender.nl_pid != 0 || (msg.msg_flags & MSG_TRUNC)) continue;
+        
+        buf[n] = '\0';
+        if (parse_uevent(buf, (size_t)n, ev)) {
+            ev->event_time_ns = time_now_ns();
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ * RosettaPad - sysfs LED Engine
+ * ==============================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "controllers/led_sysfs.h"
+
+/* ============================================================================
+ * ATTRIBUTE I/O
+ * 
+ * sysfs attributes are regenerated on every read at offset 0 and accept a
+ * whole value per write at offset 0, so one fd serves for the lifetime of
+ * the LED.
+ * ============================================================================ */
+
+static int attr_open(const char* dir, const char* name, int flags) {
+    char path[LED_SYSFS_PATH_MAX + 32];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return open(path, flags | O_CLOEXEC);
+}
+
+static int attr_write(int fd, const char* buf, size_t len) {
+    return pwrite(fd, buf, len, 0) == (ssize_t)len ? 0 : -1;
+}
+
+static int attr_read(int fd, char* buf, size_t size) {
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    return 0;
+}
+
+/* ============================================================================
+ * API
+ * ============================================================================ */
+
+int led_sysfs_open(led_sysfs_t* led, const char* dir) {
+    led_sysfs_close(led);
+    snprintf(led->dir, sizeof(led->dir), "%s", dir);
+    
+    led->brightness_fd = attr_open(dir, "brightness", O_RDWR);
+    if (led->brightness_fd < 0) {
+        return -1;
+    }
+    led->intensity_fd = attr_open(dir, "multi_intensity", O_RDWR);
+    
+    /* Player LEDs are on/off (max 1); writes above max are clamped by the
+     * LED core, so read-back must compare against the clamped value */
+    led->max_brightness = 255;
+    int fd = attr_open(dir, "max_brightness", O_RDONLY);
+    if (fd >= 0) {
+        char buf[16];
+        if (attr_read(fd, buf, sizeof(buf)) == 0) {
+            int max = atoi(buf);
+            if (max > 0 && max < 255) led->max_brightness = (uint8_t)max;
+        }
+        close(fd);
+    }
+    
+    led->known = 0;
+    return 0;
+}
+
+void led_sysfs_close(led_sysfs_t* led) {
+    if (led->brightness_fd >= 0) close(led->brightness_fd);
+    if (led->intensity_fd >= 0) close(led->intensity_fd);
+    led->brightness_fd = -1;
+    led->intensity_fd = -1;
+    led->known = 0;
+}
+
+static int write_brightness(led_sysfs_t* led, uint8_t brightness) {
+    char buf[8];
+    int len = snprintf(buf, sizeof(buf), "%u", brightness);
+    
+    if (attr_write(led->brightness_fd, buf, len) < 0) {
+        return -1;
+    }
+    led->brightness = brightness;
+    led->writes++;
+    return 1;
+}
+
+int led_sysfs_set(led_sysfs_t* led, uint8_t brightness) {
+    if (!led_sysfs_is_open(led)) return -1;
+    
+    if (brightness > led->max_brightness) brightness = led->max_brightness;
+    if (led->known && led->brightness == brightness) return 0;
+    
+    if (write_brightness(led, brightness) < 0) return -1;
+    
+    /* Multicolor LEDs also need their color known before caching */
+    if (led->intensity_fd < 0) led->known = 1;
+    return 1;
+}
+
+int led_sysfs_set_rgb(led_sysfs_t* led, uint8_t r, uint8_t g, uint8_t b) {
+    if (!led_sysfs_is_open(led) || led->intensity_fd < 0) return -1;
+    
+    int color_same = led->known && led->rgb[0] == r && led->rgb[1] == g && led->rgb[2] == b;
+    int brightness_same = led->known && led->brightness == led->max_brightness;
+    if (color_same && brightness_same) return 0;
+    
+    if (!color_same) {
+        char buf[16];
+        int len = snprintf(buf, sizeof(buf), "%u %u %u", r, g, b);
+        if (attr_write(led->intensity_fd, buf, len) < 0) {
+            led->known = 0;
+            return -1;
+        }
+        led->rgb[0] = r;
+        led->rgb[1] = g;
+        led->rgb[2] = b;
+        led->writes++;
+    }
+    
+    /* The kernel applies multi_intensity on the next brightness write */
+    if (write_brightness(led, led->max_brightness) < 0) {
+        led->known = 0;
+        return -1;
+    }
+    
+    led->known = 1;
+    return 1;
+}
+
+int led_sysfs_check(led_sysfs_t* led) {
+    if (!led_sysfs_is_open(led)) return -1;
+    if (!led->known) return 0;     /* Nothing to compare against yet */
+    
+    char buf[32];
+    if (attr_read(led->brightness_fd, buf, sizeof(buf)) < 0) return -1;
+    int changed = atoi(buf) != led->brightness;
+    
+    if (!changed && led->intensity_fd >= 0) {
+        unsigned r, g, b;
+        if (attr_read(led->intensity_fd, buf, sizeof(buf)) < 0) return -1;
+        changed = sscanf(buf, "%u %u %u", &r, &g, &b) != 3 ||
+                  r != led->rgb[0] || g != led->rgb[1] || b != led->rgb[2];
+    }
+    
+    if (changed) {
+        led->known = 0;
+        led->overrides++;
+    }
+    return changed;
+}
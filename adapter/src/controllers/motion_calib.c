@@ -0,0 +1,163 @@
+/*
+ * RosettaPad - Motion Calibration Engine
+ * =======================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "controllers/motion_calib.h"
+
+#define MOTION_APPLY_SHIFT  (MOTION_CALIB_SHIFT + MOTION_BIAS_FRAC)
+
+static const char* const g_sensor_names[MOTION_SENSOR_COUNT] = { "accel", "gyro" };
+
+/* Re-resolve the output axes fed by a raw axis after its calibration changed */
+static void update_outputs(motion_calib_t* c, motion_sensor_t sensor) {
+    for (int i = 0; i < 3; i++) {
+        const motion_axis_map_t* m = &c->spec->map[sensor][i];
+        c->output[sensor][i].source = m->source;
+        c->output[sensor][i].scale = m->sign * c->axis[sensor][m->source].scale;
+    }
+}
+
+static void set_nominal(motion_calib_t* c, motion_sensor_t sensor, int axis) {
+    motion_axis_calib_t* a = &c->axis[sensor][axis];
+    a->bias = 0;
+    a->scale = c->spec->nominal_scale[sensor];
+    a->exact_scale = a->scale;
+    update_outputs(c, sensor);
+}
+
+void motion_calib_init(motion_calib_t* c, const motion_calib_spec_t* spec) {
+    memset(c, 0, sizeof(*c));
+    c->spec = spec;
+    for (int s = 0; s < MOTION_SENSOR_COUNT; s++) {
+        for (int i = 0; i < 3; i++) set_nominal(c, s, i);
+    }
+}
+
+int motion_calib_set_axis(motion_calib_t* c, motion_sensor_t sensor, int axis,
+                          int32_t bias, int64_t numer, int64_t denom) {
+    int64_t nominal = c->spec->nominal_scale[sensor];
+    int64_t scale = denom ? (numer * (1 << MOTION_CALIB_SHIFT)) / denom : 0;
+    
+    /* Sign flips, zero spans and wild scales all land outside the band */
+    if (llabs(scale - nominal) * 100 > nominal * MOTION_SCALE_TOLERANCE_PCT ||
+        abs(bias) > c->spec->max_bias[sensor]) {
+        printf("[Motion] Rejecting %s axis %d calibration (bias %d, scale %.3f of nominal)"
+               " - using nominal\n", g_sensor_names[sensor], axis, bias, (double)scale / nominal);
+        set_nominal(c, sensor, axis);
+        c->fallback_axes++;
+        return -1;
+    }
+    
+    motion_axis_calib_t* a = &c->axis[sensor][axis];
+    a->bias = bias;
+    a->exact_scale = (double)numer * (1 << MOTION_CALIB_SHIFT) / denom;
+    a->scale = (int32_t)(a->exact_scale + (a->exact_scale < 0 ? -0.5 : 0.5));
+    update_outputs(c, sensor);
+    return 0;
+}
+
+/* |v| <= limit, branch-free */
+static inline int within(int32_t v, int32_t limit) {
+    return (uint32_t)(v + limit) <= 2 * (uint32_t)limit;
+}
+
+/* Update the rest detector, and the online bias while at rest */
+static inline void track_gyro_bias(motion_calib_t* c, const int32_t v[MOTION_SENSOR_COUNT][3]) {
+    const motion_calib_spec_t* spec = c->spec;
+    
+    /* Turning faster than any drift (most samples in play): not at rest.
+     * A slow steady turn is quiet too, but it isn't drift either. */
+    int32_t drift = spec->max_drift << MOTION_BIAS_FRAC;
+    if (!(within(v[MOTION_GYRO][0], drift) & within(v[MOTION_GYRO][1], drift) &
+          within(v[MOTION_GYRO][2], drift))) {
+        c->rest_count = 0;
+        c->primed = 0;
+        return;
+    }
+    
+    if (!c->primed) {
+        memcpy(c->avg, v, sizeof(c->avg));
+        c->primed = 1;
+    }
+    
+    int still = 1;
+    for (int s = 0; s < MOTION_SENSOR_COUNT; s++) {
+        int32_t noise = spec->rest_noise[s] << MOTION_BIAS_FRAC;
+        for (int i = 0; i < 3; i++) {
+            c->avg[s][i] += (v[s][i] - c->avg[s][i]) >> MOTION_AVG_SHIFT;
+            still &= within(v[s][i] - c->avg[s][i], noise);
+        }
+    }
+    
+    if (!still) {
+        c->rest_count = 0;
+        return;
+    }
+    if (c->rest_count < MOTION_REST_SAMPLES) {
+        c->rest_count++;
+        return;
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        c->gyro_bias[i] += (c->avg[MOTION_GYRO][i] - c->gyro_bias[i]) >> MOTION_BIAS_SHIFT;
+    }
+    c->rest_samples++;
+}
+
+static inline int16_t saturate16(int64_t v) {
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+/* Scale (rounded) one output axis from its raw axis, less an online bias */
+static inline int16_t scale_output(const motion_output_t* o, const int32_t v[3], const int32_t bias[3]) {
+    int64_t x = (int64_t)(v[o->source] - bias[o->source]) * o->scale;
+    return saturate16((x + (1LL << (MOTION_APPLY_SHIFT - 1))) >> MOTION_APPLY_SHIFT);
+}
+
+void motion_calib_apply(motion_calib_t* c, const int16_t raw_accel[3], const int16_t raw_gyro[3],
+                        controller_state_t* out) {
+    static const int32_t no_bias[3];
+    int32_t v[MOTION_SENSOR_COUNT][3];
+    
+    for (int i = 0; i < 3; i++) {
+        c->raw[MOTION_ACCEL][i] = raw_accel[i];
+        c->raw[MOTION_GYRO][i] = raw_gyro[i];
+        v[MOTION_ACCEL][i] = (raw_accel[i] - c->axis[MOTION_ACCEL][i].bias) * (1 << MOTION_BIAS_FRAC);
+        v[MOTION_GYRO][i] = (raw_gyro[i] - c->axis[MOTION_GYRO][i].bias) * (1 << MOTION_BIAS_FRAC);
+    }
+    
+    track_gyro_bias(c, (const int32_t (*)[3])v);
+    
+    out->accel_x = scale_output(&c->output[MOTION_ACCEL][0], v[MOTION_ACCEL], no_bias);
+    out->accel_y = scale_output(&c->output[MOTION_ACCEL][1], v[MOTION_ACCEL], no_bias);
+    out->accel_z = scale_output(&c->output[MOTION_ACCEL][2], v[MOTION_ACCEL], no_bias);
+    out->gyro_x = scale_output(&c->output[MOTION_GYRO][0], v[MOTION_GYRO], c->gyro_bias);
+    out->gyro_y = scale_output(&c->output[MOTION_GYRO][1], v[MOTION_GYRO], c->gyro_bias);
+    out->gyro_z = scale_output(&c->output[MOTION_GYRO][2], v[MOTION_GYRO], c->gyro_bias);
+}
+
+void motion_calib_reference(const motion_calib_t* c, double out[MOTION_SENSOR_COUNT][3]) {
+    for (int s = 0; s < MOTION_SENSOR_COUNT; s++) {
+        for (int i = 0; i < 3; i++) {
+            const motion_axis_map_t* m = &c->spec->map[s][i];
+            const motion_axis_calib_t* a = &c->axis[s][m->source];
+            double v = c->raw[s][m->source] - a->bias;
+            if (s == MOTION_GYRO) v -= (double)c->gyro_bias[m->source] / (1 << MOTION_BIAS_FRAC);
+            
+            double x = m->sign * v * a->exact_scale / (1 << MOTION_CALIB_SHIFT);
+            out[s][i] = x > INT16_MAX ? INT16_MAX : x < INT16_MIN ? INT16_MIN : x;
+        }
+    }
+}
+
+double motion_calib_gyro_bias(const motion_calib_t* c, int axis) {
+    return (double)c->gyro_bias[axis] * c->axis[MOTION_GYRO][axis].exact_scale /
+           (1 << MOTION_APPLY_SHIFT);
+}
@@ -0,0 +1,107 @@
+/*
+ * RosettaPad - Host Poll Cadence Detector
+ * ========================================
+ * 
+ * Period by median of recent intervals, phase by a first-order PLL.
+ * Not thread-safe: callers serialize (usb_gadget.c uses g_ep1_cadence_mutex).
+ */
+
+#include <string.h>
+
+#include "core/cadence.h"
+#include "core/latency.h"
+
+void cadence_init(cadence_t* c, uint64_t nominal_period_ns) {
+    memset(c, 0, sizeof(*c));
+    c->period_ns = nominal_period_ns;
+    c->stats.period_ns = nominal_period_ns;
+}
+
+static uint64_t median_interval(const cadence_t* c) {
+    uint64_t sorted[CADENCE_HISTORY];
+    uint32_t n = c->interval_count < CADENCE_HISTORY ? c->interval_count : CADENCE_HISTORY;
+    
+    memcpy(sorted, c->intervals, n * sizeof(uint64_t));
+    
+    /* Insertion sort - 16 elements */
+    for (uint32_t i = 1; i < n; i++) {
+        uint64_t v = sorted[i];
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    
+    return sorted[n / 2];
+}
+
+void cadence_observe(cadence_t* c, uint64_t t) {
+    c->stats.polls++;
+    
+    if (c->last_ns == 0) {
+        c->last_ns = t;
+        c->predicted_ns = t;
+        return;
+    }
+    
+    uint64_t dt = t - c->last_ns;
+    c->last_ns = t;
+    
+    /* Period: median of raw intervals (robust to the odd missed poll) */
+    c->intervals[c->interval_count % CADENCE_HISTORY] = dt;
+    c->interval_count++;
+    if (c->interval_count < CADENCE_HISTORY / 2) {
+        /* Not enough intervals to trust a period yet */
+        c->predicted_ns = t;
+        return;
+    }
+    c->period_ns = median_interval(c);
+    
+    latency_record(LAT_HOST_POLL_INTERVAL, dt);
+    
+    /* How many polls since the last completion? */
+    uint64_t elapsed = t - c->predicted_ns;
+    uint64_t polls = (elapsed + c->period_ns / 2) / c->period_ns;
+    if (polls == 0) polls = 1;
+    if (polls > 1) c->stats.missed += polls - 1;
+    
+    /* Phase error against the prediction */
+    uint64_t predicted = c->predicted_ns + polls * c->period_ns;
+    int64_t error = (int64_t)(t - predicted);
+    uint64_t abs_error = (uint64_t)(error < 0 ? -error : error);
+    
+    if (abs_error > c->period_ns / 4) {
+        /* Way off - restart the phase from this completion */
+        if (c->stats.locked) c->stats.relocks++;
+        c->predicted_ns = t;
+        c->in_phase = 0;
+        c->stats.locked = 0;
+    } else {
+        c->predicted_ns = (uint64_t)((int64_t)predicted + error / CADENCE_PHASE_GAIN);
+        if (++c->in_phase >= CADENCE_LOCK_COUNT) {
+            c->stats.locked = 1;
+        }
+        
+        latency_record(LAT_HOST_POLL_JITTER, abs_error);
+        c->abs_error_sum += abs_error;
+        c->error_samples++;
+    }
+    
+    c->stats.period_ns = c->period_ns;
+    c->stats.jitter_ns = c->error_samples ? c->abs_error_sum / c->error_samples : 0;
+}
+
+uint64_t cadence_next_poll(const cadence_t* c, uint64_t after_ns) {
+    if (!c->stats.locked || c->period_ns == 0) return 0;
+    
+    if (after_ns <= c->predicted_ns) return c->predicted_ns;
+    
+    uint64_t periods = (after_ns - c->predicted_ns + c->period_ns - 1) / c->period_ns;
+    return c->predicted_ns + periods * c->period_ns;
+}
+
+void cadence_get_stats(const cadence_t* c, cadence_stats_t* out) {
+    memcpy(out, &c->stats, sizeof(*out));
+}
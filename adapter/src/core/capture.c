@@ -0,0 +1,93 @@
+/*
+ * RosettaPad - Raw Input Capture
+ * ===============================
+ *
+ * See core/capture.h for the file format.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "core/common.h"
+#include "core/capture.h"
+#include "core/spool.h"
+
+/* Producer: input thread. Consumer: control loop. */
+static struct {
+    int active;
+    spool_t spool;
+    
+    uint64_t reports;
+    uint64_t dropped;
+} g_cap;
+
+int capture_open(const char* path) {
+    capture_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.start_time_ns = time_now_ns();
+    
+    if (spool_open(&g_cap.spool, path, CAPTURE_RING_SIZE, &header, sizeof(header),
+                   "[Capture]") < 0) {
+        return -1;
+    }
+    
+    g_cap.active = 1;
+    printf("[Capture] Capturing raw input to %s\n", path);
+    return 0;
+}
+
+static void capture_record(uint8_t type, const uint8_t* buf, size_t len,
+                           uint64_t rx_time_ns, uint16_t vid, uint16_t pid) {
+    if (!g_cap.active) return;
+    
+    if (len > CAPTURE_MAX_REPORT) len = CAPTURE_MAX_REPORT;
+    
+    capture_record_t rec = {
+        .rx_time_ns = rx_time_ns,
+        .vendor_id = vid,
+        .product_id = pid,
+        .len = (uint16_t)len,
+        .type = type,
+    };
+    size_t total = sizeof(rec) + len;
+    
+    if (!spool_room(&g_cap.spool, total)) {
+        g_cap.dropped++;
+        return;
+    }
+    
+    spool_put(&g_cap.spool, 0, &rec, sizeof(rec));
+    spool_put(&g_cap.spool, sizeof(rec), buf, len);
+    spool_commit(&g_cap.spool, total);
+    g_cap.reports++;
+}
+
+void capture_report(const uint8_t* buf, size_t len, uint64_t rx_time_ns,
+                    uint16_t vid, uint16_t pid) {
+    capture_record(CAPTURE_RECORD_INPUT, buf, len, rx_time_ns, vid, pid);
+}
+
+void capture_calibration(const uint8_t* buf, size_t len, uint64_t time_ns,
+                         uint16_t vid, uint16_t pid) {
+    capture_record(CAPTURE_RECORD_CALIBRATION, buf, len, time_ns, vid, pid);
+}
+
+int capture_attach(reactor_t* r) {
+    if (!g_cap.active) return 0;
+    return spool_attach(&g_cap.spool, r, CAPTURE_DRAIN_INTERVAL_MS, NULL, NULL);
+}
+
+void capture_close(void) {
+    if (!g_cap.active) return;
+    g_cap.active = 0;
+    
+    spool_drain(&g_cap.spool);
+    
+    printf("[Capture] Captured %llu reports (%llu bytes, %llu dropped)\n",
+           (unsigned long long)g_cap.reports, (unsigned long long)g_cap.spool.bytes_written,
+           (unsigned long long)g_cap.dropped);
+    
+    spool_close(&g_cap.spool);
+}
@@ -8,8 +8,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/time.h>
 #include <unistd.h>
+#include <sys/inotify.h>
 
 #include "core/common.h"
 
@@ -25,9 +25,9 @@ volatile int g_running = 1;
 
 static volatile system_state_t g_system_state = SYSTEM_STATE_ACTIVE;
 static pthread_mutex_t g_system_state_mutex = PTHREAD_MUTEX_INITIALIZER;
-static uint64_t g_last_state_change_time = 0;
+static uint64_t g_last_state_change_time = 0;  /* Coarse monotonic ns */
 
-/* Minimum time between state changes (ms) - prevents rapid oscillation */
+/* Minimum time between state changes - prevents rapid oscillation */
 #define STATE_CHANGE_DEBOUNCE_MS 2000
 
 static const char* state_names[] = {"ACTIVE", "STANDBY", "WAKING"};
@@ -36,7 +36,7 @@ void system_set_state(system_state_t state) {
     pthread_mutex_lock(&g_system_state_mutex);
     system_state_t old_state = g_system_state;
     g_system_state = state;
-    g_last_state_change_time = time_get_ms();
+    g_last_state_change_time = time_now_coarse_ns();
     pthread_mutex_unlock(&g_system_state_mutex);
     
     printf("[System] State: %s -> %s\n", state_names[old_state], state_names[state]);
@@ -56,13 +56,17 @@ int system_is_standby(void) {
 /* Check if we can change state (debounce) */
 static int can_change_state(void) {
     pthread_mutex_lock(&g_system_state_mutex);
-    uint64_t now = time_get_ms();
+    uint64_t now = time_now_coarse_ns();
     uint64_t elapsed = now - g_last_state_change_time;
     pthread_mutex_unlock(&g_system_state_mutex);
     
-    return elapsed >= STATE_CHANGE_DEBOUNCE_MS;
+    return elapsed >= TIME_MS(STATE_CHANGE_DEBOUNCE_MS);
 }
 
+/* Wakes the output handler (defined below) */
+static void output_notify(void);
+static void lightbar_ipc_invalidate(void);
+
 /* Forward declarations for console-specific functions */
 extern void ps3_bt_disconnect(void);
 extern int ps3_bt_wake(void);
@@ -98,6 +102,7 @@ void system_enter_standby(void) {
     g_controller_output.led_b = 0;
     g_controller_output.player_leds = 0;
     pthread_mutex_unlock(&g_controller_output_mutex);
+    output_notify();
     
     printf("[System] Standby active - press PS button to wake\n");
 }
@@ -126,10 +131,14 @@ void system_exit_standby(void) {
     g_controller_output.led_b = 0;
     pthread_mutex_unlock(&g_controller_output_mutex);
     
-    /* Try to wake PS3 via Bluetooth */
+    /* ...or the web panel's color, which was ignored during standby */
+    lightbar_ipc_invalidate();
+    output_notify();
+    
+    /* Try to wake PS3 via Bluetooth - queued; the control loop connects and presses PS */
     printf("[System] Sending wake signal to PS3...\n");
     if (ps3_bt_wake() < 0) {
-        printf("[System] Warning: Wake signal failed\n");
+        printf("[System] Warning: Wake signal not queued (Bluetooth not running)\n");
     }
     
     system_set_state(SYSTEM_STATE_ACTIVE);
@@ -139,44 +148,60 @@ void system_exit_standby(void) {
  * CONTROLLER STATE MANAGEMENT
  * ============================================================================ */
 
-controller_state_t g_controller_state = {
-    .buttons = 0,
-    .left_stick_x = 128,
-    .left_stick_y = 128,
-    .right_stick_x = 128,
-    .right_stick_y = 128,
-    .left_trigger = 0,
-    .right_trigger = 0,
-    .accel_x = 0,
-    .accel_y = 0,
-    .accel_z = 0,
-    .gyro_x = 0,
-    .gyro_y = 0,
-    .gyro_z = 0,
-    .touch = {{0, 0, 0}, {0, 0, 0}},
-    .battery_level = 100,
-    .battery_charging = 0,
-    .timestamp_ms = 0
+/*
+ * Sequence counter and state share one cache-aligned slot, so a reader
+ * pulls in as few lines as possible and never false-shares with the
+ * output state below.
+ */
+static struct {
+    seqlock_t seq;
+    controller_state_t state;
+} g_controller_state_slot CACHE_ALIGNED = {
+    .seq = SEQLOCK_INITIALIZER,
+    .state = {
+        .buttons = 0,
+        .left_stick_x = 128,
+        .left_stick_y = 128,
+        .right_stick_x = 128,
+        .right_stick_y = 128,
+        .left_trigger = 0,
+        .right_trigger = 0,
+        .accel_x = 0,
+        .accel_y = 0,
+        .accel_z = 0,
+        .gyro_x = 0,
+        .gyro_y = 0,
+        .gyro_z = 0,
+        .touch = {{0, 0, 0}, {0, 0, 0}},
+        .battery_level = 100,
+        .battery_charging = 0,
+        .timestamp_ns = 0
+    }
 };
 pthread_mutex_t g_controller_state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 void controller_state_update(const controller_state_t* state) {
+    /* Writers are serialized; readers never touch this mutex */
     pthread_mutex_lock(&g_controller_state_mutex);
-    memcpy(&g_controller_state, state, sizeof(controller_state_t));
+    seqlock_write_begin(&g_controller_state_slot.seq);
+    memcpy(&g_controller_state_slot.state, state, sizeof(controller_state_t));
+    seqlock_write_end(&g_controller_state_slot.seq);
     pthread_mutex_unlock(&g_controller_state_mutex);
 }
 
 void controller_state_copy(controller_state_t* out_state) {
-    pthread_mutex_lock(&g_controller_state_mutex);
-    memcpy(out_state, &g_controller_state, sizeof(controller_state_t));
-    pthread_mutex_unlock(&g_controller_state_mutex);
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&g_controller_state_slot.seq);
+        memcpy(out_state, &g_controller_state_slot.state, sizeof(controller_state_t));
+    } while (seqlock_read_retry(&g_controller_state_slot.seq, seq));
 }
 
 /* ============================================================================
  * OUTPUT STATE MANAGEMENT
  * ============================================================================ */
 
-controller_output_t g_controller_output = {
+controller_output_t g_controller_output CACHE_ALIGNED = {
     .rumble_left = 0,
     .rumble_right = 0,
     .led_r = 255,
@@ -189,16 +214,33 @@ pthread_mutex_t g_controller_output_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static int g_output_changed = 0;
 
+/* Signalled whenever the output state changes (see controller_output_attach) */
+static int g_output_event_fd = -1;
+
+/* Signalled by the driver for its flush_deferred() */
+static int g_output_deferred_fd = -1;
+
+static void output_notify(void) {
+    if (g_output_event_fd >= 0) {
+        reactor_event_signal(g_output_event_fd);
+    }
+}
+
 void controller_output_update(const controller_output_t* output) {
+    int changed = 0;
+    
     pthread_mutex_lock(&g_controller_output_mutex);
     
     /* Check if anything changed */
     if (memcmp(&g_controller_output, output, sizeof(controller_output_t)) != 0) {
         memcpy(&g_controller_output, output, sizeof(controller_output_t));
         g_output_changed = 1;
+        changed = 1;
     }
     
     pthread_mutex_unlock(&g_controller_output_mutex);
+    
+    if (changed) output_notify();
 }
 
 void controller_output_copy(controller_output_t* out_output) {
@@ -272,75 +314,215 @@ void controller_clear_active(void) {
     g_active_driver = NULL;
 }
 
-void* controller_output_thread(void* arg) {
-    (void)arg;
+/* Last output successfully sent to the controller */
+static controller_output_t g_last_sent_output;
+static int g_output_failures = 0;
+
+/* Retry timer for failed sends, lightbar IPC watch, driver upkeep */
+static int g_output_retry_fd = -1;
+static int g_lightbar_watch_fd = -1;
+static int g_lightbar_timer_fd = -1;     /* Only if inotify is unavailable */
+static int g_maintain_timer_fd = -1;
+
+/* Set when the IPC file must be re-read on the next output event */
+static int g_lightbar_ipc_stale = 0;
+
+/* Retry a failed output send after this long */
+#define OUTPUT_RETRY_MS         10
+
+/* Lightbar IPC file poll interval, without inotify */
+#define LIGHTBAR_IPC_POLL_MS    500
+
+static void output_flush(void) {
+    /* Get current output state */
+    controller_output_t output;
+    controller_output_copy(&output);
     
-    printf("[Output] Controller output thread started\n");
+    /* Check if anything changed */
+    int changed = (
+        output.rumble_left != g_last_sent_output.rumble_left ||
+        output.rumble_right != g_last_sent_output.rumble_right ||
+        output.led_r != g_last_sent_output.led_r ||
+        output.led_g != g_last_sent_output.led_g ||
+        output.led_b != g_last_sent_output.led_b ||
+        output.player_leds != g_last_sent_output.player_leds
+    );
     
-    controller_output_t last_output = {0};
-    int ipc_counter = 0;
-    int consecutive_failures = 0;
+    /* Send output if changed and we have an active controller */
+    if (!changed || !g_active_driver || g_controller_fd < 0) {
+        return;
+    }
+    
+    if (!g_active_driver->send_output) {
+        g_last_sent_output = output;
+        return;
+    }
     
-    while (g_running) {
-        /* Check for lightbar IPC updates every ~500ms */
-        if (++ipc_counter >= 50) {
-            ipc_counter = 0;
-            
-            controller_output_t output;
-            controller_output_copy(&output);
-            lightbar_read_ipc(&output);
-            controller_output_update(&output);
+    int ret = g_active_driver->send_output(g_controller_fd, &output);
+    if (ret < 0) {
+        g_output_failures++;
+        /* Only log after several failures to reduce noise */
+        if (g_output_failures == 5) {
+            printf("[Output] Warning: Multiple output send failures\n");
         }
-        
-        /* Get current output state */
-        controller_output_t output;
-        controller_output_copy(&output);
-        
-        /* Check if anything changed */
-        int changed = (
-            output.rumble_left != last_output.rumble_left ||
-            output.rumble_right != last_output.rumble_right ||
-            output.led_r != last_output.led_r ||
-            output.led_g != last_output.led_g ||
-            output.led_b != last_output.led_b ||
-            output.player_leds != last_output.player_leds
-        );
-        
-        /* Send output if changed and we have an active controller */
-        if (changed && g_active_driver && g_controller_fd >= 0) {
-            if (g_active_driver->send_output) {
-                int ret = g_active_driver->send_output(g_controller_fd, &output);
-                if (ret < 0) {
-                    consecutive_failures++;
-                    /* Only log after several failures to reduce noise */
-                    if (consecutive_failures == 5) {
-                        printf("[Output] Warning: Multiple output send failures\n");
-                    }
-                    /* Don't update last_output so we retry */
-                } else {
-                    if (consecutive_failures >= 5) {
-                        printf("[Output] Output send recovered\n");
-                    }
-                    consecutive_failures = 0;
-                    last_output = output;
-                }
-            } else {
-                last_output = output;
+        /* Don't update g_last_sent_output so we retry */
+        reactor_timer_set(g_output_retry_fd, time_deadline_in(TIME_MS(OUTPUT_RETRY_MS)), 0);
+    } else {
+        if (g_output_failures >= 5) {
+            printf("[Output] Output send recovered\n");
+        }
+        g_output_failures = 0;
+        g_last_sent_output = output;
+    }
+}
+
+static void lightbar_apply_ipc(void) {
+    controller_output_t output;
+    controller_output_copy(&output);
+    lightbar_read_ipc(&output);
+    controller_output_update(&output);
+}
+
+static void lightbar_ipc_invalidate(void) {
+    __atomic_store_n(&g_lightbar_ipc_stale, 1, __ATOMIC_RELEASE);
+}
+
+static void output_event_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    reactor_event_read(fd);
+    
+    if (__atomic_exchange_n(&g_lightbar_ipc_stale, 0, __ATOMIC_ACQ_REL)) {
+        lightbar_apply_ipc();   /* Notifies again if it changed anything */
+    }
+    output_flush();
+}
+
+static void output_retry_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    if (reactor_timer_read(fd) == 0) return;
+    output_flush();
+}
+
+void controller_output_defer(void) {
+    if (g_output_deferred_fd >= 0) {
+        reactor_event_signal(g_output_deferred_fd);
+    }
+}
+
+static void output_deferred_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    reactor_event_read(fd);
+    
+    if (g_active_driver && g_active_driver->flush_deferred && g_controller_fd >= 0) {
+        g_active_driver->flush_deferred(g_controller_fd);
+    }
+}
+
+/* The web backend rewrote (or renamed over) the IPC file */
+static void lightbar_watch_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+    ssize_t n;
+    
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + n; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            /* On overflow events were lost, ours maybe among them */
+            if ((ev->mask & IN_Q_OVERFLOW) ||
+                (ev->len && strcmp(ev->name, LIGHTBAR_IPC_FILE) == 0)) {
+                changed = 1;
             }
+            p += sizeof(*ev) + ev->len;
         }
-        
-        usleep(10000);  /* 100Hz */
     }
     
-    printf("[Output] Controller output thread exiting\n");
-    return NULL;
+    if (changed) lightbar_apply_ipc();
+}
+
+static void lightbar_timer_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    if (reactor_timer_read(fd) == 0) return;
+    lightbar_apply_ipc();
+}
+
+/* Watch the IPC directory (the file may not exist yet, and may be replaced
+ * by rename); fall back to polling if inotify isn't available */
+static int lightbar_watch_attach(reactor_t* r) {
+    g_lightbar_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_lightbar_watch_fd >= 0 &&
+        inotify_add_watch(g_lightbar_watch_fd, LIGHTBAR_IPC_DIR, IN_CLOSE_WRITE | IN_MOVED_TO) >= 0 &&
+        reactor_add(r, g_lightbar_watch_fd, EPOLLIN, lightbar_watch_handler, NULL) == 0) {
+        return 0;
+    }
+    
+    perror("[Output] inotify on " LIGHTBAR_IPC_DIR);
+    if (g_lightbar_watch_fd >= 0) close(g_lightbar_watch_fd);
+    g_lightbar_watch_fd = -1;
+    printf("[Output] Polling lightbar IPC every %dms instead\n", LIGHTBAR_IPC_POLL_MS);
+    
+    g_lightbar_timer_fd = reactor_timer_create();
+    if (g_lightbar_timer_fd < 0 ||
+        reactor_add(r, g_lightbar_timer_fd, EPOLLIN, lightbar_timer_handler, NULL) < 0) {
+        return -1;
+    }
+    return reactor_timer_set(g_lightbar_timer_fd, time_deadline_in(TIME_MS(LIGHTBAR_IPC_POLL_MS)),
+                             TIME_MS(LIGHTBAR_IPC_POLL_MS));
+}
+
+static void maintain_timer_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    if (reactor_timer_read(fd) == 0) return;
+    
+    if (g_active_driver && g_active_driver->maintain && g_controller_fd >= 0) {
+        g_active_driver->maintain(g_controller_fd);
+    }
+}
+
+int controller_output_attach(reactor_t* r) {
+    g_output_event_fd = reactor_event_create();
+    g_output_deferred_fd = reactor_event_create();
+    g_output_retry_fd = reactor_timer_create();
+    g_maintain_timer_fd = reactor_timer_create();
+    
+    if (g_output_event_fd < 0 || g_output_deferred_fd < 0 || g_output_retry_fd < 0 ||
+        g_maintain_timer_fd < 0) {
+        return -1;
+    }
+    
+    if (reactor_add(r, g_output_event_fd, EPOLLIN, output_event_handler, NULL) < 0 ||
+        reactor_add(r, g_output_deferred_fd, EPOLLIN, output_deferred_handler, NULL) < 0 ||
+        reactor_add(r, g_output_retry_fd, EPOLLIN, output_retry_handler, NULL) < 0 ||
+        reactor_add(r, g_maintain_timer_fd, EPOLLIN, maintain_timer_handler, NULL) < 0 ||
+        lightbar_watch_attach(r) < 0) {
+        return -1;
+    }
+    
+    reactor_timer_set(g_maintain_timer_fd, time_deadline_in(TIME_MS(CONTROLLER_MAINTAIN_MS)),
+                      TIME_MS(CONTROLLER_MAINTAIN_MS));
+    
+    /* Pick up the current IPC file and push whatever is already pending */
+    lightbar_ipc_invalidate();
+    output_notify();
+    
+    printf("[Output] Controller output attached to %s loop\n", r->name);
+    return 0;
 }
 
 /* ============================================================================
  * CONFIGURATION
  * ============================================================================ */
 
-volatile int g_touchpad_as_right_stick = 1;  /* Enabled by default */
+volatile input_path_mode_t g_input_path_mode = INPUT_PATH_DECOUPLED;
+
+const char* input_path_mode_str(input_path_mode_t mode) {
+    switch (mode) {
+        case INPUT_PATH_DECOUPLED:         return "decoupled";
+        case INPUT_PATH_RUN_TO_COMPLETION: return "run-to-completion";
+    }
+    return "unknown";
+}
 
 /* ============================================================================
  * DEBUG UTILITIES
@@ -354,10 +536,4 @@ void debug_print_hex(const char* label, const uint8_t* data, size_t len) {
     }
     printf("\n");
     fflush(stdout);
-}
-
-uint64_t time_get_ms(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000ULL + tv.tv_usec / 1000;
 }
\ No newline at end of file
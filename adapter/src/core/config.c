@@ -0,0 +1,112 @@
+/*
+ * RosettaPad - Runtime Configuration
+ * ===================================
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+#include "core/config.h"
+#include "core/seqlock.h"
+
+static struct {
+    seqlock_t seq;
+    adapter_config_t config;
+} g_config CACHE_ALIGNED = {
+    .seq = SEQLOCK_INITIALIZER,
+    .config = {
+        .touchpad_stick = 1,
+        .stick_deadzone = CONFIG_DEFAULT_STICK_DEADZONE,
+        .touchpad_range = CONFIG_DEFAULT_TOUCHPAD_RANGE,
+        .bt_input_interval_ms = CONFIG_DEFAULT_BT_INPUT_INTERVAL_MS,
+        .usb_sample_lead_us = CONFIG_DEFAULT_USB_SAMPLE_LEAD_US,
+        .motion_filter = 1,
+    },
+};
+
+/* Writers are serialized; readers never wait for this */
+static pthread_mutex_t g_config_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const struct {
+    const char* name;
+    size_t offset;
+    size_t size;
+    int32_t min;
+    int32_t max;
+} g_options[CONFIG_OPTION_COUNT] = {
+    [CONFIG_TOUCHPAD_STICK] = { "touchpad_stick",
+        offsetof(adapter_config_t, touchpad_stick), 1, 0, 1 },
+    [CONFIG_STICK_DEADZONE] = { "deadzone",
+        offsetof(adapter_config_t, stick_deadzone), 1, 0, 64 },
+    [CONFIG_TOUCHPAD_RANGE] = { "touchpad_range",
+        offsetof(adapter_config_t, touchpad_range), 2, 50, 1920 },
+    [CONFIG_BT_INPUT_INTERVAL_MS] = { "bt_interval_ms",
+        offsetof(adapter_config_t, bt_input_interval_ms), 2, 5, 100 },
+    [CONFIG_USB_SAMPLE_LEAD_US] = { "usb_sample_lead_us",
+        offsetof(adapter_config_t, usb_sample_lead_us), 2, 0, 900 },
+    [CONFIG_MOTION_FILTER] = { "motion_filter",
+        offsetof(adapter_config_t, motion_filter), 1, 0, 1 },
+};
+
+static int option_valid(int option) {
+    return option > 0 && option < CONFIG_OPTION_COUNT;
+}
+
+void config_get(adapter_config_t* out) {
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&g_config.seq);
+        *out = g_config.config;
+    } while (seqlock_read_retry(&g_config.seq, seq));
+}
+
+void config_commit(const adapter_config_t* config) {
+    pthread_mutex_lock(&g_config_write_mutex);
+    seqlock_write_begin(&g_config.seq);
+    g_config.config = *config;
+    seqlock_write_end(&g_config.seq);
+    pthread_mutex_unlock(&g_config_write_mutex);
+}
+
+int config_get_option(const adapter_config_t* config, int option, int32_t* value) {
+    if (!option_valid(option)) return -1;
+    
+    const uint8_t* field = (const uint8_t*)config + g_options[option].offset;
+    if (g_options[option].size == 1) {
+        *value = *field;
+    } else {
+        uint16_t v;
+        memcpy(&v, field, sizeof(v));
+        *value = v;
+    }
+    return 0;
+}
+
+int config_set_option(adapter_config_t* config, int option, int32_t value) {
+    if (!option_valid(option) ||
+        value < g_options[option].min || value > g_options[option].max) {
+        return -1;
+    }
+    
+    uint8_t* field = (uint8_t*)config + g_options[option].offset;
+    if (g_options[option].size == 1) {
+        *field = (uint8_t)value;
+    } else {
+        uint16_t v = (uint16_t)value;
+        memcpy(field, &v, sizeof(v));
+    }
+    return 0;
+}
+
+int config_option_by_name(const char* name) {
+    for (int i = 1; i < CONFIG_OPTION_COUNT; i++) {
+        if (strcasecmp(name, g_options[i].name) == 0) return i;
+    }
+    return -1;
+}
+
+const char* config_option_name(int option) {
+    return option_valid(option) ? g_options[option].name : NULL;
+}
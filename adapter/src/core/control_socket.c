@@ -0,0 +1,361 @@
+/*
+ * RosettaPad - Control Socket
+ * ============================
+ *
+ * See core/control_socket.h for the protocol.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "core/control_socket.h"
+#include "core/config.h"
+#include "core/latency.h"
+#include "core/remap.h"
+#include "controllers/controller_interface.h"
+
+static struct {
+    reactor_t* reactor;
+    const char* path;
+    const live_export_hooks_t* hooks;
+    int listen_fd;
+    int clients[CTL_MAX_CLIENTS];
+    
+    uint64_t batches;
+    uint64_t commands;
+    uint64_t rejected;
+} g_ctl = { .listen_fd = -1 };
+
+/* Changes staged by one batch, applied only if every command passes */
+typedef struct {
+    adapter_config_t config;
+    int config_changed;
+    
+    remap_table_t* remap;
+    int remap_changed;
+    
+    controller_output_t output;
+    int output_changed;
+    
+    int failed;
+} ctl_txn_t;
+
+/* ============================================================================
+ * COMMANDS
+ * ============================================================================ */
+
+/* Appends one reply; payload may be NULL with len 0 */
+typedef struct {
+    uint8_t* buf;
+    size_t len;
+} ctl_out_t;
+
+static int out_reply(ctl_out_t* out, uint8_t op, int status, const void* payload, size_t len) {
+    if (out->len + sizeof(ctl_reply_t) + len > CTL_MAX_PACKET) return -1;
+    
+    ctl_reply_t reply = { .op = op, .status = (int8_t)status, .len = (uint16_t)len };
+    memcpy(out->buf + out->len, &reply, sizeof(reply));
+    if (len) memcpy(out->buf + out->len + sizeof(reply), payload, len);
+    out->len += sizeof(reply) + len;
+    return 0;
+}
+
+static void fill_stats(ctl_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->system_state = (uint32_t)system_get_state();
+    stats->controller_connected = controller_get_active() != NULL;
+    if (g_ctl.hooks && g_ctl.hooks->sample_console) {
+        live_console_t console;
+        memset(&console, 0, sizeof(console));
+        g_ctl.hooks->sample_console(&console);
+        stats->console = console;
+    }
+    stats->batches = g_ctl.batches;
+    stats->commands = g_ctl.commands;
+    stats->rejected = g_ctl.rejected;
+}
+
+/* Run one command against the transaction. @return ctl_status_t */
+static int run_command(ctl_txn_t* txn, const ctl_cmd_t* cmd, const uint8_t* payload,
+                       ctl_out_t* out) {
+    switch (cmd->op) {
+        case CTL_OP_PING:
+            return out_reply(out, cmd->op, CTL_OK, payload, cmd->len) < 0 ? CTL_EBADOP : CTL_OK;
+        
+        case CTL_OP_GET_OPTION: {
+            int32_t value;
+            if (config_get_option(&txn->config, cmd->arg, &value) < 0) return CTL_EINVAL;
+            return out_reply(out, cmd->op, CTL_OK, &value, sizeof(value)) < 0 ? CTL_EBADOP : CTL_OK;
+        }
+        
+        case CTL_OP_SET_OPTION: {
+            int32_t value;
+            if (cmd->len != sizeof(value)) return CTL_EBADOP;
+            memcpy(&value, payload, sizeof(value));
+            if (config_set_option(&txn->config, cmd->arg, value) < 0) return CTL_EINVAL;
+            txn->config_changed = 1;
+            break;
+        }
+        
+        case CTL_OP_LOAD_REMAP: {
+            char path[PATH_MAX];
+            memcpy(path, payload, cmd->len);
+            path[cmd->len] = '\0';
+            
+            /* Relative to our working directory would surprise the client */
+            if (cmd->len && path[0] != '/') return CTL_EINVAL;
+            
+            remap_table_t* table = NULL;
+            if (cmd->len && !(table = remap_compile_file(path))) return CTL_ELOAD;
+            free(txn->remap);       /* Last one in the batch wins */
+            txn->remap = table;
+            txn->remap_changed = 1;
+            break;
+        }
+        
+        case CTL_OP_SET_OUTPUT: {
+            ctl_output_t o;
+            if (cmd->len != sizeof(o)) return CTL_EBADOP;
+            memcpy(&o, payload, sizeof(o));
+            
+            if (cmd->arg & CTL_OUT_RUMBLE) {
+                txn->output.rumble_left = o.rumble_left;
+                txn->output.rumble_right = o.rumble_right;
+            }
+            if (cmd->arg & CTL_OUT_LIGHTBAR) {
+                txn->output.led_r = o.led_r;
+                txn->output.led_g = o.led_g;
+                txn->output.led_b = o.led_b;
+            }
+            if (cmd->arg & CTL_OUT_PLAYER_LEDS) {
+                txn->output.player_leds = o.player_leds;
+                txn->output.player_brightness = o.player_brightness;
+            }
+            txn->output_changed = 1;
+            break;
+        }
+        
+        case CTL_OP_GET_STATS: {
+            ctl_stats_t stats;
+            fill_stats(&stats);
+            return out_reply(out, cmd->op, CTL_OK, &stats, sizeof(stats)) < 0 ? CTL_EBADOP : CTL_OK;
+        }
+        
+        case CTL_OP_GET_LATENCY: {
+            if (cmd->arg >= LAT_STAGE_COUNT) return CTL_EINVAL;
+            ctl_latency_t lat = {
+                .p50_ns = latency_percentile(cmd->arg, 50),
+                .p90_ns = latency_percentile(cmd->arg, 90),
+                .p99_ns = latency_percentile(cmd->arg, 99),
+            };
+            return out_reply(out, cmd->op, CTL_OK, &lat, sizeof(lat)) < 0 ? CTL_EBADOP : CTL_OK;
+        }
+        
+        default:
+            return CTL_EBADOP;
+    }
+    
+    return out_reply(out, cmd->op, CTL_OK, NULL, 0) < 0 ? CTL_EBADOP : CTL_OK;
+}
+
+static int op_changes_state(uint8_t op) {
+    return op == CTL_OP_SET_OPTION || op == CTL_OP_LOAD_REMAP || op == CTL_OP_SET_OUTPUT;
+}
+
+/* Handle one request packet. @return reply length, 0 if malformed */
+static size_t run_batch(const uint8_t* req, size_t req_len, uint8_t* reply) {
+    ctl_batch_t batch;
+    if (req_len < sizeof(batch)) return 0;
+    memcpy(&batch, req, sizeof(batch));
+    if (batch.version != CTL_VERSION) return 0;
+    
+    ctl_out_t out = { .buf = reply, .len = sizeof(batch) };
+    ctl_txn_t txn;
+    memset(&txn, 0, sizeof(txn));
+    config_get(&txn.config);
+    controller_output_copy(&txn.output);
+    
+    size_t pos = sizeof(batch);
+    size_t reply_pos[256];
+    int n = 0;
+    
+    for (; n < batch.count; n++) {
+        ctl_cmd_t cmd;
+        reply_pos[n] = out.len;
+        if (req_len - pos < sizeof(cmd)) break;
+        memcpy(&cmd, req + pos, sizeof(cmd));
+        pos += sizeof(cmd);
+        if (req_len - pos < cmd.len) break;
+        
+        int status = run_command(&txn, &cmd, req + pos, &out);
+        pos += cmd.len;
+        if (status != CTL_OK) {
+            txn.failed = 1;
+            if (out_reply(&out, cmd.op, status, NULL, 0) < 0) break;
+        }
+    }
+    
+    /* Truncated batch: the rest is malformed */
+    for (; n < batch.count; n++) {
+        txn.failed = 1;
+        reply_pos[n] = out.len;
+        if (out_reply(&out, 0, CTL_EBADOP, NULL, 0) < 0) return 0;
+    }
+    
+    g_ctl.batches++;
+    g_ctl.commands += batch.count;
+    
+    if (txn.failed) {
+        /* Nothing from this batch takes effect */
+        free(txn.remap);
+        for (int i = 0; i < batch.count; i++) {
+            ctl_reply_t r;
+            memcpy(&r, reply + reply_pos[i], sizeof(r));
+            if (r.status == CTL_OK && op_changes_state(r.op)) {
+                r.status = CTL_EABORTED;
+                memcpy(reply + reply_pos[i], &r, sizeof(r));
+            }
+        }
+        g_ctl.rejected++;
+    } else {
+        if (txn.config_changed) config_commit(&txn.config);
+        if (txn.remap_changed) remap_install(txn.remap);
+        if (txn.output_changed) controller_output_update(&txn.output);
+    }
+    
+    memcpy(reply, &batch, sizeof(batch));
+    return out.len;
+}
+
+/* ============================================================================
+ * CONNECTIONS
+ * ============================================================================ */
+
+static void client_close(int slot) {
+    reactor_del(g_ctl.reactor, g_ctl.clients[slot]);
+    close(g_ctl.clients[slot]);
+    g_ctl.clients[slot] = -1;
+}
+
+static void client_handler(int fd, uint32_t events, void* ctx) {
+    int slot = (int)(intptr_t)ctx;
+    uint8_t req[CTL_MAX_PACKET];
+    uint8_t reply[CTL_MAX_PACKET];
+    
+    /* Drain every pipelined batch in this wakeup */
+    for (;;) {
+        ssize_t n = recv(fd, req, sizeof(req), MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) break;
+        if (n <= 0) {
+            client_close(slot);
+            return;
+        }
+        
+        size_t len = run_batch(req, (size_t)n, reply);
+        if (len == 0) {
+            printf("[Control] Malformed batch, closing client\n");
+            client_close(slot);
+            return;
+        }
+        
+        /* A client that doesn't read its replies is dropped, never waited on */
+        if (send(fd, reply, len, MSG_DONTWAIT | MSG_NOSIGNAL) != (ssize_t)len) {
+            printf("[Control] Client not reading replies, closing it\n");
+            client_close(slot);
+            return;
+        }
+    }
+    
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        client_close(slot);
+    }
+}
+
+static void listen_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    int client;
+    while ((client = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        int slot = -1;
+        for (int i = 0; i < CTL_MAX_CLIENTS; i++) {
+            if (g_ctl.clients[i] < 0) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            printf("[Control] Too many clients (%d), refusing one\n", CTL_MAX_CLIENTS);
+            close(client);
+            continue;
+        }
+        
+        if (reactor_add(g_ctl.reactor, client, EPOLLIN, client_handler, (void*)(intptr_t)slot) < 0) {
+            close(client);
+            continue;
+        }
+        g_ctl.clients[slot] = client;
+    }
+}
+
+int ctl_attach(reactor_t* r, const char* path, const live_export_hooks_t* hooks) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("[Control] Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    
+    for (int i = 0; i < CTL_MAX_CLIENTS; i++) g_ctl.clients[i] = -1;
+    g_ctl.reactor = r;
+    g_ctl.path = path;
+    g_ctl.hooks = hooks;
+    
+    g_ctl.listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (g_ctl.listen_fd < 0) {
+        perror("[Control] socket");
+        return -1;
+    }
+    
+    unlink(path);   /* Left over from a previous run */
+    if (bind(g_ctl.listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        chmod(path, 0660) < 0 ||
+        listen(g_ctl.listen_fd, CTL_MAX_CLIENTS) < 0) {
+        perror("[Control] bind/listen");
+        close(g_ctl.listen_fd);
+        g_ctl.listen_fd = -1;
+        return -1;
+    }
+    
+    if (reactor_add(r, g_ctl.listen_fd, EPOLLIN, listen_handler, NULL) < 0) {
+        close(g_ctl.listen_fd);
+        g_ctl.listen_fd = -1;
+        return -1;
+    }
+    
+    printf("[Control] Listening on %s\n", path);
+    return 0;
+}
+
+void ctl_close(void) {
+    if (g_ctl.listen_fd < 0) return;
+    
+    for (int i = 0; i < CTL_MAX_CLIENTS; i++) {
+        if (g_ctl.clients[i] >= 0) client_close(i);
+    }
+    reactor_del(g_ctl.reactor, g_ctl.listen_fd);
+    close(g_ctl.listen_fd);
+    g_ctl.listen_fd = -1;
+    unlink(g_ctl.path);
+    
+    printf("[Control] Closed (%llu batches, %llu rejected)\n",
+           (unsigned long long)g_ctl.batches, (unsigned long long)g_ctl.rejected);
+}
@@ -0,0 +1,164 @@
+/*
+ * RosettaPad - CRC32
+ * ===================
+ * 
+ * All implementations work on the inverted running register; the
+ * inversions happen once in crc32_extend().
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_acle.h>
+#endif
+
+#include "core/crc32.h"
+
+#define CRC32_POLY 0xEDB88320u
+
+typedef uint32_t (*crc32_fn_t)(uint32_t crc, const uint8_t* p, size_t len);
+
+static uint32_t g_crc32_tables[8][256];
+static int g_crc32_ready = 0;
+
+/* ============================================================================
+ * TABLE (bytewise)
+ * ============================================================================ */
+
+static uint32_t crc32_table(uint32_t crc, const uint8_t* p, size_t len) {
+    while (len--) {
+        crc = (crc >> 8) ^ g_crc32_tables[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+/* ============================================================================
+ * SLICING-BY-8
+ * ============================================================================ */
+
+static inline uint32_t load_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t crc32_slice8(uint32_t crc, const uint8_t* p, size_t len) {
+    while (len >= 8) {
+        uint32_t lo = load_le32(p) ^ crc;
+        uint32_t hi = load_le32(p + 4);
+        crc = g_crc32_tables[7][lo & 0xFF] ^
+              g_crc32_tables[6][(lo >> 8) & 0xFF] ^
+              g_crc32_tables[5][(lo >> 16) & 0xFF] ^
+              g_crc32_tables[4][lo >> 24] ^
+              g_crc32_tables[3][hi & 0xFF] ^
+              g_crc32_tables[2][(hi >> 8) & 0xFF] ^
+              g_crc32_tables[1][(hi >> 16) & 0xFF] ^
+              g_crc32_tables[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    return crc32_table(crc, p, len);
+}
+
+/* ============================================================================
+ * ARMv8 CRC32 INSTRUCTIONS
+ * ============================================================================ */
+
+#if defined(__aarch64__)
+
+__attribute__((target("+crc")))
+static uint32_t crc32_armv8(uint32_t crc, const uint8_t* p, size_t len) {
+    uint64_t v;
+    
+    while (len >= 8) {
+        memcpy(&v, p, 8);
+        crc = __crc32d(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = __crc32b(crc, *p++);
+    }
+    return crc;
+}
+
+static int cpu_has_crc32(void) {
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+
+#else
+
+#define crc32_armv8 NULL
+
+static int cpu_has_crc32(void) {
+    return 0;
+}
+
+#endif
+
+/* ============================================================================
+ * DISPATCH
+ * ============================================================================ */
+
+static const struct {
+    const char* name;
+    crc32_fn_t fn;
+} g_impls[CRC32_IMPL_COUNT] = {
+    [CRC32_IMPL_TABLE]  = { "table",  crc32_table },
+    [CRC32_IMPL_SLICE8] = { "slice8", crc32_slice8 },
+    [CRC32_IMPL_ARMV8]  = { "armv8",  crc32_armv8 },
+};
+
+static crc32_impl_t g_impl = CRC32_IMPL_TABLE;
+static crc32_fn_t g_crc32_fn = NULL;
+
+static void build_tables(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? CRC32_POLY : 0);
+        }
+        g_crc32_tables[0][i] = crc;
+    }
+    for (int t = 1; t < 8; t++) {
+        for (int i = 0; i < 256; i++) {
+            uint32_t prev = g_crc32_tables[t - 1][i];
+            g_crc32_tables[t][i] = (prev >> 8) ^ g_crc32_tables[0][prev & 0xFF];
+        }
+    }
+    g_crc32_ready = 1;
+}
+
+int crc32_select(crc32_impl_t impl) {
+    if (impl >= CRC32_IMPL_COUNT || !g_impls[impl].fn) return -1;
+    if (impl == CRC32_IMPL_ARMV8 && !cpu_has_crc32()) return -1;
+    
+    if (!g_crc32_ready) build_tables();
+    g_impl = impl;
+    g_crc32_fn = g_impls[impl].fn;
+    return 0;
+}
+
+void crc32_init(void) {
+    if (g_crc32_fn) return;
+    
+    if (crc32_select(CRC32_IMPL_ARMV8) < 0) {
+        crc32_select(CRC32_IMPL_SLICE8);
+    }
+    printf("[CRC32] Using %s implementation\n", g_impls[g_impl].name);
+}
+
+const char* crc32_impl_name(void) {
+    return g_impls[g_impl].name;
+}
+
+const char* crc32_impl_str(crc32_impl_t impl) {
+    return impl < CRC32_IMPL_COUNT ? g_impls[impl].name : "unknown";
+}
+
+uint32_t crc32_extend(uint32_t crc, const void* data, size_t len) {
+    if (__builtin_expect(!g_crc32_fn, 0)) crc32_init();
+    return ~g_crc32_fn(~crc, data, len);
+}
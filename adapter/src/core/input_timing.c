@@ -0,0 +1,135 @@
+/*
+ * RosettaPad - Controller Input Timing
+ * =====================================
+ * 
+ * Device clock tracking, dropped frame and jitter accounting.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "core/common.h"
+#include "core/input_timing.h"
+#include "core/latency.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+/*
+ * The clock offset estimate follows the least-delayed report. To track
+ * crystal drift in the "device clock slower" direction, the estimate is
+ * allowed to creep up by this much per second of device time. Crystal
+ * tolerance is ~±100ppm, so 200ppm comfortably covers it.
+ */
+#define CLOCK_DRIFT_ALLOWANCE_PPM   200
+
+/* A device time step larger than this is treated as a clock reset */
+#define CLOCK_RESYNC_THRESHOLD_NS   TIME_SEC(1)
+
+/* ============================================================================
+ * STATE
+ * 
+ * Only the input thread writes. Statistics are read with relaxed loads,
+ * which is fine for monitoring.
+ * ============================================================================ */
+
+static input_timing_stats_t g_stats;
+
+static int g_have_previous = 0;
+static uint8_t g_prev_sequence = 0;
+static uint64_t g_prev_sensor_ns = 0;
+
+static int g_offset_valid = 0;
+static int64_t g_offset_ns = 0;
+
+void input_timing_reset(void) {
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_have_previous = 0;
+    g_offset_valid = 0;
+    g_offset_ns = 0;
+}
+
+/* ============================================================================
+ * UPDATE
+ * ============================================================================ */
+
+void input_timing_update(controller_state_t* state) {
+    g_stats.reports++;
+    
+    /* Dropped frames from sequence gaps */
+    if ((state->timing_flags & CONTROLLER_TIMING_SEQUENCE) && g_have_previous) {
+        uint8_t gap = (uint8_t)(state->sequence - g_prev_sequence);
+        if (gap > 1 && gap < 128) {
+            g_stats.dropped_frames += gap - 1;
+        }
+    }
+    g_prev_sequence = state->sequence;
+    
+    if (!(state->timing_flags & CONTROLLER_TIMING_SENSOR_CLOCK)) {
+        /* No device clock - the best we have is arrival time */
+        state->sample_time_ns = state->rx_time_ns;
+        g_have_previous = 1;
+        return;
+    }
+    
+    g_stats.timed_reports++;
+    uint64_t sensor_ns = state->sensor_time_ns;
+    int64_t offset = (int64_t)(state->rx_time_ns - sensor_ns);
+    
+    if (g_have_previous && g_offset_valid) {
+        uint64_t interval = sensor_ns - g_prev_sensor_ns;
+        
+        if (sensor_ns < g_prev_sensor_ns || interval > CLOCK_RESYNC_THRESHOLD_NS) {
+            /* Device clock restarted - rebuild the mapping */
+            g_stats.clock_resyncs++;
+            g_offset_ns = offset;
+        } else {
+            g_stats.last_interval_ns = interval;
+            latency_record(LAT_SENSOR_INTERVAL, interval);
+            
+            /* Let the estimate drift up slowly, snap down to faster arrivals */
+            g_offset_ns += (int64_t)(interval * CLOCK_DRIFT_ALLOWANCE_PPM / 1000000);
+            if (offset < g_offset_ns) g_offset_ns = offset;
+        }
+    } else {
+        g_offset_ns = offset;
+        g_offset_valid = 1;
+    }
+    
+    state->sample_time_ns = (uint64_t)((int64_t)sensor_ns + g_offset_ns);
+    
+    /* Delivery jitter: how much later than the best-case path this arrived */
+    latency_record_span(LAT_DELIVERY_JITTER, state->sample_time_ns, state->rx_time_ns);
+    
+    g_stats.clock_offset_ns = g_offset_ns;
+    g_have_previous = 1;
+    g_prev_sensor_ns = sensor_ns;
+}
+
+/* ============================================================================
+ * QUERIES
+ * ============================================================================ */
+
+void input_timing_get_stats(input_timing_stats_t* out) {
+    memcpy(out, &g_stats, sizeof(*out));
+}
+
+void input_timing_dump(void) {
+    input_timing_stats_t stats;
+    input_timing_get_stats(&stats);
+    
+    printf("=== Controller Timing ===\n");
+    printf("  Reports:        %llu (%llu with sensor clock)\n",
+           (unsigned long long)stats.reports, (unsigned long long)stats.timed_reports);
+    printf("  Dropped frames: %llu", (unsigned long long)stats.dropped_frames);
+    if (stats.reports > 0) {
+        printf(" (%.3f%%)", 100.0 * stats.dropped_frames /
+               (double)(stats.reports + stats.dropped_frames));
+    }
+    printf("\n");
+    printf("  Clock resyncs:  %llu\n", (unsigned long long)stats.clock_resyncs);
+    printf("  Last interval:  %.1f us\n", stats.last_interval_ns / 1000.0);
+    printf("=========================\n\n");
+    fflush(stdout);
+}
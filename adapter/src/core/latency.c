@@ -0,0 +1,153 @@
+/*
+ * RosettaPad - Input Latency Instrumentation
+ * ===========================================
+ * 
+ * Lock-free log-linear histograms for pipeline stage latencies.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "core/latency.h"
+
+/* ============================================================================
+ * HISTOGRAM STORAGE
+ * ============================================================================ */
+
+static latency_histogram_t g_histograms[LAT_STAGE_COUNT];
+
+static const char* stage_names[LAT_STAGE_COUNT] = {
+    [LAT_PARSE]     = "parse",
+    [LAT_PUBLISH]   = "publish",
+    [LAT_USB_BUILD] = "usb build",
+    [LAT_USB_SEND]  = "usb send",
+    [LAT_USB_AGE]   = "usb input age",
+    [LAT_BT_BUILD]  = "bt build",
+    [LAT_BT_SEND]   = "bt send",
+    [LAT_BT_AGE]    = "bt input age",
+    [LAT_SENSOR_INTERVAL] = "sensor interval",
+    [LAT_DELIVERY_JITTER] = "link jitter",
+    [LAT_HOST_POLL_INTERVAL] = "host poll",
+    [LAT_HOST_POLL_JITTER]   = "host poll err",
+    [LAT_MACRO_STEP] = "macro step",
+    [LAT_TAS_FRAME] = "tas frame",
+};
+
+const char* latency_stage_str(latency_stage_t stage) {
+    return (stage < LAT_STAGE_COUNT) ? stage_names[stage] : "unknown";
+}
+
+/* ============================================================================
+ * BUCKET MAPPING
+ * 
+ * Values below LAT_SUB_COUNT map 1:1. Above that, each power of two is
+ * split into LAT_SUB_COUNT linear sub-buckets.
+ * ============================================================================ */
+
+static inline unsigned bucket_index(uint64_t ns) {
+    if (ns < LAT_SUB_COUNT) return (unsigned)ns;
+    
+    unsigned msb = 63 - __builtin_clzll(ns);
+    unsigned shift = msb - LAT_SUB_BITS;
+    unsigned index = ((shift + 1) << LAT_SUB_BITS) +
+                     (unsigned)((ns >> shift) & (LAT_SUB_COUNT - 1));
+    
+    return (index < LAT_BUCKETS) ? index : LAT_BUCKETS - 1;
+}
+
+/* Largest value that maps to the given bucket */
+static uint64_t bucket_upper_bound(unsigned index) {
+    if (index < LAT_SUB_COUNT) return index;
+    
+    unsigned shift = (index >> LAT_SUB_BITS) - 1;
+    uint64_t sub = LAT_SUB_COUNT + (index & (LAT_SUB_COUNT - 1));
+    return ((sub + 1) << shift) - 1;
+}
+
+/* ============================================================================
+ * RECORDING
+ * ============================================================================ */
+
+void latency_record(latency_stage_t stage, uint64_t ns) {
+    if (stage >= LAT_STAGE_COUNT) return;
+    latency_histogram_t* h = &g_histograms[stage];
+    
+    __atomic_fetch_add(&h->counts[bucket_index(ns)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->total, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum_ns, ns, __ATOMIC_RELAXED);
+    
+    uint64_t max = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+    while (ns > max &&
+           !__atomic_compare_exchange_n(&h->max_ns, &max, ns, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        /* max reloaded by the failed exchange */
+    }
+}
+
+/* ============================================================================
+ * QUERIES
+ * ============================================================================ */
+
+uint64_t latency_percentile(latency_stage_t stage, double percentile) {
+    if (stage >= LAT_STAGE_COUNT) return 0;
+    const latency_histogram_t* h = &g_histograms[stage];
+    
+    uint64_t total = __atomic_load_n(&h->total, __ATOMIC_RELAXED);
+    if (total == 0) return 0;
+    
+    uint64_t target = (uint64_t)((percentile / 100.0) * total + 0.5);
+    if (target < 1) target = 1;
+    if (target > total) target = total;
+    
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < LAT_BUCKETS; i++) {
+        seen += __atomic_load_n(&h->counts[i], __ATOMIC_RELAXED);
+        if (seen >= target) {
+            uint64_t bound = bucket_upper_bound(i);
+            uint64_t max = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+            return (bound < max) ? bound : max;
+        }
+    }
+    
+    return __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+}
+
+void latency_dump(void) {
+    printf("\n=== Input Latency (us) ===\n");
+    printf("  %-14s %10s %9s %9s %9s %9s %9s\n",
+           "stage", "count", "mean", "p50", "p99", "p99.9", "max");
+    
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        const latency_histogram_t* h = &g_histograms[s];
+        uint64_t total = __atomic_load_n(&h->total, __ATOMIC_RELAXED);
+        if (total == 0) {
+            printf("  %-14s %10s\n", stage_names[s], "-");
+            continue;
+        }
+        
+        double mean = (double)__atomic_load_n(&h->sum_ns, __ATOMIC_RELAXED) / total;
+        printf("  %-14s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+               stage_names[s], (unsigned long long)total,
+               mean / 1000.0,
+               latency_percentile(s, 50.0) / 1000.0,
+               latency_percentile(s, 99.0) / 1000.0,
+               latency_percentile(s, 99.9) / 1000.0,
+               __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED) / 1000.0);
+    }
+    
+    printf("==========================\n\n");
+    fflush(stdout);
+}
+
+void latency_reset(void) {
+    /* Not atomic as a whole - concurrent samples may straddle the reset */
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        latency_histogram_t* h = &g_histograms[s];
+        for (unsigned i = 0; i < LAT_BUCKETS; i++) {
+            __atomic_store_n(&h->counts[i], 0, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&h->total, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&h->sum_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&h->max_ns, 0, __ATOMIC_RELAXED);
+    }
+}
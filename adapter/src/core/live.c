@@ -0,0 +1,162 @@
+/*
+ * RosettaPad - Live State Export
+ * ===============================
+ *
+ * See core/live.h for the segment layout.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "core/live.h"
+#include "controllers/controller_interface.h"
+
+static struct {
+    live_shm_t* shm;
+    const char* path;
+    int timer_fd;
+    const live_export_hooks_t* hooks;
+    
+    live_snapshot_t last;       /* Previous sample, to skip unchanged ones */
+    uint64_t updates;
+} g_live = { .timer_fd = -1 };
+
+int live_export_open(const char* path) {
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("[Live] Failed to create live state segment");
+        return -1;
+    }
+    
+    /* Readers only map it: the file must be exactly one live_shm_t */
+    if (ftruncate(fd, sizeof(live_shm_t)) < 0) {
+        perror("[Live] ftruncate");
+        close(fd);
+        return -1;
+    }
+    
+    live_shm_t* shm = mmap(NULL, sizeof(live_shm_t), PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        perror("[Live] mmap");
+        return -1;
+    }
+    
+    /* Taking over from a previous run: invalidate first, so nobody reads a
+     * half-written header, and keep seq monotonic for running readers.
+     * A writer that died mid-update left seq odd; round it up to even, or
+     * every later write would leave it odd and readers would spin forever. */
+    __atomic_store_n(&shm->header.version, 0, __ATOMIC_RELEASE);
+    uint32_t seq = __atomic_load_n(&shm->seq.seq, __ATOMIC_RELAXED);
+    if (seq & 1) __atomic_store_n(&shm->seq.seq, seq + 1, __ATOMIC_RELEASE);
+    seqlock_write_begin(&shm->seq);
+    memset(&shm->snap, 0, sizeof(shm->snap));
+    seqlock_write_end(&shm->seq);
+    
+    memcpy(shm->header.magic, LIVE_MAGIC, sizeof(shm->header.magic));
+    shm->header.size = sizeof(live_shm_t);
+    shm->header.snapshot_size = sizeof(live_snapshot_t);
+    shm->header.controller_size = sizeof(controller_state_t);
+    shm->header.writer_pid = (uint32_t)getpid();
+    shm->header.interval_ms = LIVE_EXPORT_INTERVAL_MS;
+    __atomic_store_n(&shm->header.version, LIVE_VERSION, __ATOMIC_RELEASE);
+    
+    g_live.shm = shm;
+    g_live.path = path;
+    printf("[Live] Exporting live state to %s (%zu bytes, every %dms)\n",
+           path, sizeof(live_shm_t), LIVE_EXPORT_INTERVAL_MS);
+    return 0;
+}
+
+static void live_sample(live_snapshot_t* snap) {
+    memset(snap, 0, sizeof(*snap));
+    snap->system_state = (uint32_t)system_get_state();
+    snap->controller_connected = controller_get_active() != NULL;
+    controller_state_copy(&snap->controller);
+    
+    if (g_live.hooks->sample_console) {
+        g_live.hooks->sample_console(&snap->console);
+    }
+    if (g_live.hooks->sample_report) {
+        snap->report_len = g_live.hooks->sample_report(snap->report, LIVE_REPORT_MAX);
+    }
+}
+
+static void live_timer_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    if (reactor_timer_read(fd) == 0) return;
+    
+    live_snapshot_t snap;
+    live_sample(&snap);
+    
+    /* update_time_ns is still 0 in both, so this compares the contents */
+    if (g_live.updates && memcmp(&snap, &g_live.last, sizeof(snap)) == 0) {
+        return;
+    }
+    g_live.last = snap;
+    snap.update_time_ns = time_now_ns();
+    
+    seqlock_write_begin(&g_live.shm->seq);
+    g_live.shm->snap = snap;
+    seqlock_write_end(&g_live.shm->seq);
+    g_live.updates++;
+}
+
+int live_export_attach(reactor_t* r, const live_export_hooks_t* hooks) {
+    if (!g_live.shm) return 0;
+    
+    g_live.hooks = hooks;
+    g_live.timer_fd = reactor_timer_create();
+    if (g_live.timer_fd < 0 ||
+        reactor_add(r, g_live.timer_fd, EPOLLIN, live_timer_handler, NULL) < 0) {
+        return -1;
+    }
+    return reactor_timer_set(g_live.timer_fd, time_deadline_in(TIME_MS(LIVE_EXPORT_INTERVAL_MS)),
+                             TIME_MS(LIVE_EXPORT_INTERVAL_MS));
+}
+
+void live_export_close(void) {
+    if (!g_live.shm) return;
+    
+    __atomic_store_n(&g_live.shm->header.version, 0, __ATOMIC_RELEASE);
+    munmap(g_live.shm, sizeof(live_shm_t));
+    unlink(g_live.path);
+    g_live.shm = NULL;
+    
+    if (g_live.timer_fd >= 0) close(g_live.timer_fd);
+    g_live.timer_fd = -1;
+    printf("[Live] Live state export closed (%llu updates)\n",
+           (unsigned long long)g_live.updates);
+}
+
+/* ============================================================================
+ * READER
+ * ============================================================================ */
+
+int live_check_header(const live_shm_t* shm) {
+    if (memcmp(shm->header.magic, LIVE_MAGIC, sizeof(shm->header.magic)) != 0 ||
+        __atomic_load_n(&shm->header.version, __ATOMIC_ACQUIRE) != LIVE_VERSION ||
+        shm->header.size != sizeof(live_shm_t) ||
+        shm->header.snapshot_size != sizeof(live_snapshot_t) ||
+        shm->header.controller_size != sizeof(controller_state_t)) {
+        return -1;
+    }
+    return 0;
+}
+
+int live_snapshot_read(const live_shm_t* shm, live_snapshot_t* out, uint32_t* seq_out) {
+    if (live_check_header(shm) < 0) return -1;
+    
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&shm->seq);
+        memcpy(out, &shm->snap, sizeof(*out));
+    } while (seqlock_read_retry(&shm->seq, seq));
+    
+    if (seq_out) *seq_out = seq;
+    return 0;
+}
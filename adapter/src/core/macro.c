@@ -0,0 +1,295 @@
+/*
+ * RosettaPad - Macros
+ * ====================
+ * 
+ * Parser and player. Everything except macro_dump() runs on the input
+ * thread, so playback state needs no locking; statistics are atomics
+ * because the dump runs on the control loop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "core/common.h"
+#include "core/latency.h"
+#include "core/macro.h"
+
+/* ============================================================================
+ * STATE
+ * ============================================================================ */
+
+static macro_t g_macros[MACRO_MAX];
+static int g_num_macros = 0;
+
+static int g_macro_timer_fd = -1;
+static macro_publish_t g_publish = NULL;
+
+/* Playback - input thread only */
+static controller_state_t g_live;       /* Last report, before overlay */
+static uint32_t g_prev_buttons = 0;
+static macro_t* g_playing = NULL;
+static int g_step = 0;
+static uint64_t g_step_start_ns = 0;    /* Scheduled, not actual */
+
+/* ============================================================================
+ * PARSER
+ * ============================================================================ */
+
+/* "cross+down" or "none" */
+static int parse_combo(const char* text, uint32_t* out) {
+    char buf[REMAP_MAX_LINE];
+    char* save = NULL;
+    
+    *out = 0;
+    if (strcasecmp(text, "none") == 0) return 0;
+    
+    snprintf(buf, sizeof(buf), "%s", text);
+    for (char* tok = strtok_r(buf, "+", &save); tok; tok = strtok_r(NULL, "+", &save)) {
+        int btn = remap_button_by_name(tok);
+        if (btn < 0) return -1;
+        *out |= 1u << btn;
+    }
+    return 0;
+}
+
+/* "16.7ms" / "500us" */
+static int parse_duration(const char* text, uint64_t* out_ns) {
+    char* end;
+    double v = strtod(text, &end);
+    
+    if (end == text || v <= 0) return -1;
+    if (strcasecmp(end, "ms") == 0) {
+        *out_ns = (uint64_t)(v * TIME_NS_PER_MS + 0.5);
+    } else if (strcasecmp(end, "us") == 0) {
+        *out_ns = (uint64_t)(v * TIME_NS_PER_US + 0.5);
+    } else {
+        return -1;
+    }
+    return *out_ns > 0 ? 0 : -1;
+}
+
+static int parse_step(char* line, macro_step_t* step, const char** err) {
+    char* save = NULL;
+    int have_buttons = 0;
+    
+    memset(step, 0, sizeof(*step));
+    
+    for (char* tok = strtok_r(line, " \t\r\n", &save); tok; tok = strtok_r(NULL, " \t\r\n", &save)) {
+        char* eq = strchr(tok, '=');
+        
+        if (eq) {
+            *eq = '\0';
+            int axis = remap_axis_by_name(tok);
+            char* end;
+            long v = strtol(eq + 1, &end, 0);
+            if (axis < 0 || *end != '\0' || v < 0 || v > 255) {
+                *err = "bad axis value (lx ly rx ry lt rt = 0-255)";
+                return -1;
+            }
+            step->axis_mask |= 1u << axis;
+            step->axes[axis] = (uint8_t)v;
+        } else if (parse_duration(tok, &step->duration_ns) == 0) {
+            continue;
+        } else if (!have_buttons && parse_combo(tok, &step->buttons) == 0) {
+            have_buttons = 1;
+        } else {
+            *err = "expected buttons, axis=value or a duration (ms/us)";
+            return -1;
+        }
+    }
+    
+    if (step->duration_ns == 0) {
+        *err = "step needs a duration";
+        return -1;
+    }
+    return 0;
+}
+
+int macro_load(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror("[Macro] Failed to open macro file");
+        return -1;
+    }
+    
+    char line[REMAP_MAX_LINE];
+    int lineno = 0;
+    macro_t* cur = NULL;
+    const char* err = NULL;
+    
+    g_num_macros = 0;
+    
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        
+        char word[16], name[MACRO_MAX_NAME], combo[REMAP_MAX_LINE];
+        int n = sscanf(line, "%15s %31s %127s", word, name, combo);
+        if (n <= 0) continue;
+        
+        if (strcmp(word, "macro") == 0) {
+            if (cur) { err = "missing 'end'"; break; }
+            if (n != 3) { err = "expected: macro <name> <combo>"; break; }
+            if (g_num_macros >= MACRO_MAX) { err = "too many macros"; break; }
+            
+            cur = &g_macros[g_num_macros];
+            memset(cur, 0, sizeof(*cur));
+            snprintf(cur->name, sizeof(cur->name), "%s", name);
+            if (parse_combo(combo, &cur->trigger) < 0 || cur->trigger == 0) {
+                err = "bad trigger combo";
+                break;
+            }
+        } else if (strcmp(word, "end") == 0) {
+            if (!cur || cur->num_steps == 0) { err = "'end' without a macro or steps"; break; }
+            g_num_macros++;
+            cur = NULL;
+        } else {
+            if (!cur) { err = "step outside a macro"; break; }
+            if (cur->num_steps >= MACRO_MAX_STEPS) { err = "too many steps"; break; }
+            if (parse_step(line, &cur->steps[cur->num_steps], &err) < 0) break;
+            cur->num_steps++;
+        }
+    }
+    fclose(f);
+    
+    if (!err && cur) err = "missing 'end' at end of file";
+    if (err) {
+        printf("[Macro] %s:%d: %s\n", path, lineno, err);
+        g_num_macros = 0;
+        return -1;
+    }
+    
+    for (int i = 0; i < g_num_macros; i++) {
+        uint64_t total = 0;
+        for (int s = 0; s < g_macros[i].num_steps; s++) total += g_macros[i].steps[s].duration_ns;
+        printf("[Macro] %s: %d steps, %.3f ms\n", g_macros[i].name,
+               g_macros[i].num_steps, total / 1e6);
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * PLAYBACK
+ * ============================================================================ */
+
+static void overlay_step(controller_state_t* state) {
+    const macro_step_t* step = &g_playing->steps[g_step];
+    
+    if (state->buttons != step->buttons) {
+        state->native_format = CONTROLLER_NATIVE_NONE;
+    }
+    state->buttons = step->buttons;
+    
+    uint8_t* axes = &state->left_stick_x;
+    for (int i = 0; i < REMAP_AXIS_COUNT; i++) {
+        if (step->axis_mask & (1u << i)) axes[i] = step->axes[i];
+    }
+}
+
+static void arm_step_timer(void) {
+    reactor_timer_set(g_macro_timer_fd,
+                      g_step_start_ns + g_playing->steps[g_step].duration_ns, 0);
+}
+
+static void macro_start(macro_t* m) {
+    g_playing = m;
+    g_step = 0;
+    g_step_start_ns = time_now_ns();
+    __atomic_add_fetch(&m->plays, 1, __ATOMIC_RELAXED);
+    arm_step_timer();
+}
+
+static void macro_timer_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    if (reactor_timer_read(fd) == 0 || !g_playing) return;
+    
+    macro_t* m = g_playing;
+    
+    /* Advance exactly one step, even if we woke late, so none is lost;
+     * the next deadline stays on the original schedule */
+    uint64_t deadline = g_step_start_ns + m->steps[g_step].duration_ns;
+    g_step_start_ns = deadline;
+    
+    if (++g_step >= m->num_steps) {
+        g_playing = NULL;
+    } else {
+        arm_step_timer();
+    }
+    
+    /* Aged from the step deadline, not the last controller report */
+    controller_state_t state = g_live;
+    state.rx_time_ns = deadline;
+    if (g_playing) overlay_step(&state);
+    g_publish(&state);
+    
+    uint64_t late = time_now_ns() - deadline;
+    latency_record(LAT_MACRO_STEP, late);
+    __atomic_add_fetch(&m->steps_played, 1, __ATOMIC_RELAXED);
+    if (late > __atomic_load_n(&m->max_late_ns, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&m->max_late_ns, late, __ATOMIC_RELAXED);
+    }
+}
+
+int macro_attach(reactor_t* r, macro_publish_t publish) {
+    if (g_num_macros == 0) return 0;
+    
+    g_publish = publish;
+    g_macro_timer_fd = reactor_timer_create();
+    if (g_macro_timer_fd < 0 ||
+        reactor_add(r, g_macro_timer_fd, EPOLLIN, macro_timer_handler, NULL) < 0) {
+        return -1;
+    }
+    
+    printf("[Macro] %d macro(s) attached to %s loop\n", g_num_macros, r->name);
+    return 0;
+}
+
+void macro_process(controller_state_t* state) {
+    if (g_macro_timer_fd < 0) return;
+    
+    uint32_t buttons = state->buttons;
+    g_live = *state;
+    
+    if (!g_playing) {
+        for (int i = 0; i < g_num_macros; i++) {
+            uint32_t trig = g_macros[i].trigger;
+            if ((buttons & trig) == trig && (g_prev_buttons & trig) != trig) {
+                macro_start(&g_macros[i]);
+                break;
+            }
+        }
+    }
+    g_prev_buttons = buttons;
+    
+    if (g_playing) overlay_step(state);
+}
+
+void macro_cancel(void) {
+    if (g_macro_timer_fd < 0) return;
+    
+    g_playing = NULL;
+    g_prev_buttons = 0;
+    reactor_timer_set(g_macro_timer_fd, 0, 0);
+}
+
+void macro_dump(void) {
+    if (g_num_macros == 0) return;
+    
+    printf("=== Macros ===\n");
+    for (int i = 0; i < g_num_macros; i++) {
+        const macro_t* m = &g_macros[i];
+        printf("  %-16s plays=%llu steps=%llu max late=%.1f us\n", m->name,
+               (unsigned long long)__atomic_load_n(&m->plays, __ATOMIC_RELAXED),
+               (unsigned long long)__atomic_load_n(&m->steps_played, __ATOMIC_RELAXED),
+               __atomic_load_n(&m->max_late_ns, __ATOMIC_RELAXED) / 1000.0);
+    }
+    printf("  (per-step lateness: \"macro step\" in the latency histograms)\n");
+    printf("==============\n\n");
+    fflush(stdout);
+}
@@ -0,0 +1,238 @@
+/*
+ * RosettaPad - Motion Sample Alignment
+ * =====================================
+ * 
+ * Single writer (controller input thread), any number of readers.
+ * The whole ring is guarded by one seqlock: writes are a few stores,
+ * readers copy two samples and retry on overlap.
+ * 
+ * Each entry also carries the running sums of every sample before it.
+ * They are 32-bit and wrap; the difference of two is still exact as long
+ * as the window between them fits (MOTION_HISTORY_SIZE * 32768 does).
+ */
+
+#include <string.h>
+
+#include "core/common.h"
+#include "core/motion.h"
+
+#define MOTION_MASK         (MOTION_HISTORY_SIZE - 1)
+#define MOTION_RECIP_SHIFT  24
+
+typedef struct {
+    motion_sample_t sample;
+    uint32_t sum_accel[3];  /* Running sums of all earlier samples */
+    uint32_t sum_gyro[3];
+} motion_entry_t;
+
+static struct {
+    seqlock_t seq;
+    uint32_t count;         /* Samples written since reset */
+    uint32_t epoch;         /* Bumped by every reset */
+    uint32_t sum_accel[3];  /* Writer only */
+    uint32_t sum_gyro[3];
+    motion_entry_t entries[MOTION_HISTORY_SIZE];
+} g_motion CACHE_ALIGNED;
+
+/* ============================================================================
+ * WRITER
+ * ============================================================================ */
+
+void motion_reset(void) {
+    seqlock_write_begin(&g_motion.seq);
+    g_motion.count = 0;
+    g_motion.epoch++;
+    seqlock_write_end(&g_motion.seq);
+}
+
+void motion_push(const controller_state_t* state) {
+    uint32_t count = g_motion.count;
+    
+    /* Ignore samples that don't move forward in time (resync, duplicates) */
+    if (count > 0 &&
+        state->sample_time_ns <= g_motion.entries[(count - 1) & MOTION_MASK].sample.time_ns) {
+        return;
+    }
+    
+    seqlock_write_begin(&g_motion.seq);
+    motion_entry_t* e = &g_motion.entries[count & MOTION_MASK];
+    motion_sample_t* s = &e->sample;
+    s->time_ns = state->sample_time_ns;
+    s->accel[0] = state->accel_x;
+    s->accel[1] = state->accel_y;
+    s->accel[2] = state->accel_z;
+    s->gyro[0] = state->gyro_x;
+    s->gyro[1] = state->gyro_y;
+    s->gyro[2] = state->gyro_z;
+    for (int i = 0; i < 3; i++) {
+        e->sum_accel[i] = g_motion.sum_accel[i];
+        e->sum_gyro[i] = g_motion.sum_gyro[i];
+        g_motion.sum_accel[i] += (uint32_t)(int32_t)s->accel[i];
+        g_motion.sum_gyro[i] += (uint32_t)(int32_t)s->gyro[i];
+    }
+    g_motion.count = count + 1;
+    seqlock_write_end(&g_motion.seq);
+}
+
+/* ============================================================================
+ * READERS
+ * ============================================================================ */
+
+/* Newest sample at or before time_ns, or the oldest one kept.
+ * Inside a read section; count must be non-zero. */
+static uint32_t find_at(uint32_t count, uint64_t time_ns) {
+    uint32_t avail = count < MOTION_HISTORY_SIZE ? count : MOTION_HISTORY_SIZE;
+    uint32_t idx = count - 1;
+    
+    while (idx != count - avail &&
+           g_motion.entries[idx & MOTION_MASK].sample.time_ns > time_ns) {
+        idx--;
+    }
+    return idx;
+}
+
+static inline int16_t lerp16(int16_t a, int16_t b, uint64_t num, uint64_t den) {
+    return (int16_t)(a + (int32_t)(((int64_t)(b - a) * (int64_t)num) / (int64_t)den));
+}
+
+int motion_sample_at(uint64_t time_ns, motion_sample_t* out) {
+    motion_sample_t before = {0}, after = {0};
+    int have_after = 0;
+    uint32_t seq;
+    
+    do {
+        seq = seqlock_read_begin(&g_motion.seq);
+        
+        uint32_t count = g_motion.count;
+        if (count == 0) {
+            if (seqlock_read_retry(&g_motion.seq, seq)) continue;
+            return -1;
+        }
+        
+        /* Walk back from the newest sample to the first one at or before time_ns */
+        uint32_t idx = find_at(count, time_ns);
+        have_after = idx != count - 1;
+        
+        before = g_motion.entries[idx & MOTION_MASK].sample;
+        if (have_after) {
+            after = g_motion.entries[(idx + 1) & MOTION_MASK].sample;
+        }
+    } while (seqlock_read_retry(&g_motion.seq, seq));
+    
+    /* Clamped at either end of the history */
+    if (!have_after || before.time_ns >= time_ns) {
+        *out = before;
+        return 0;
+    }
+    
+    uint64_t num = time_ns - before.time_ns;
+    uint64_t den = after.time_ns - before.time_ns;
+    
+    out->time_ns = time_ns;
+    for (int i = 0; i < 3; i++) {
+        out->accel[i] = lerp16(before.accel[i], after.accel[i], num, den);
+        out->gyro[i] = lerp16(before.gyro[i], after.gyro[i], num, den);
+    }
+    return 0;
+}
+
+static void copy_to_state(const motion_sample_t* sample, controller_state_t* state) {
+    state->accel_x = sample->accel[0];
+    state->accel_y = sample->accel[1];
+    state->accel_z = sample->accel[2];
+    state->gyro_x = sample->gyro[0];
+    state->gyro_y = sample->gyro[1];
+    state->gyro_z = sample->gyro[2];
+}
+
+void motion_align_state(controller_state_t* state, uint64_t now_ns) {
+    motion_sample_t sample;
+    
+    /* Replayed frames carry their own recorded motion */
+    if (state->timing_flags & CONTROLLER_TIMING_REPLAYED) {
+        return;
+    }
+    
+    if (motion_sample_at(now_ns - TIME_US(MOTION_ALIGN_DELAY_US), &sample) != 0) {
+        return;
+    }
+    copy_to_state(&sample, state);
+}
+
+/* ============================================================================
+ * DECIMATION
+ * ============================================================================ */
+
+void motion_decimator_reset(motion_decimator_t* d) {
+    /* Epoch 0 never matches: motion_reset() runs before any sample */
+    memset(d, 0, sizeof(*d));
+}
+
+/* Rounded mean of a window sum, n * recip ~= 2^MOTION_RECIP_SHIFT */
+static inline int16_t window_mean(uint32_t sum, int64_t recip) {
+    int64_t v = (int64_t)(int32_t)sum * recip;
+    return (int16_t)((v + (1LL << (MOTION_RECIP_SHIFT - 1))) >> MOTION_RECIP_SHIFT);
+}
+
+int motion_decimate(motion_decimator_t* d, uint64_t time_ns, motion_sample_t* out) {
+    motion_entry_t first = {0}, last = {0};
+    uint32_t seq, epoch = 0, start = 0, end = 0;
+    
+    do {
+        seq = seqlock_read_begin(&g_motion.seq);
+        
+        uint32_t count = g_motion.count;
+        epoch = g_motion.epoch;
+        if (count == 0) {
+            if (seqlock_read_retry(&g_motion.seq, seq)) continue;
+            return -1;
+        }
+        
+        /* Window: [first sample after the previous call, newest at or before time_ns] */
+        uint32_t oldest = count > MOTION_HISTORY_SIZE ? count - MOTION_HISTORY_SIZE : 0;
+        end = find_at(count, time_ns);
+        start = d->next;
+        if (d->epoch != epoch) start = end + 1;
+        else if ((int32_t)(start - oldest) < 0) start = oldest;
+        
+        first = g_motion.entries[start & MOTION_MASK];
+        last = g_motion.entries[end & MOTION_MASK];
+    } while (seqlock_read_retry(&g_motion.seq, seq));
+    
+    /* Nothing new since the previous call (or no previous call) */
+    if ((int32_t)(end - start) < 0 || last.sample.time_ns > time_ns) {
+        if (d->epoch != epoch) {
+            d->epoch = epoch;
+            d->next = last.sample.time_ns > time_ns ? end : end + 1;
+        }
+        return motion_sample_at(time_ns, out);
+    }
+    d->epoch = epoch;
+    d->next = end + 1;
+    
+    /* Comb: running sum through `end` less the one before `start` */
+    uint32_t n = end - start + 1;
+    int64_t recip = ((1LL << MOTION_RECIP_SHIFT) + n / 2) / n;
+    
+    out->time_ns = last.sample.time_ns;
+    for (int i = 0; i < 3; i++) {
+        out->accel[i] = window_mean(last.sum_accel[i] + (uint32_t)(int32_t)last.sample.accel[i] -
+                                    first.sum_accel[i], recip);
+        out->gyro[i] = window_mean(last.sum_gyro[i] + (uint32_t)(int32_t)last.sample.gyro[i] -
+                                   first.sum_gyro[i], recip);
+    }
+    return 0;
+}
+
+void motion_decimate_state(motion_decimator_t* d, controller_state_t* state, uint64_t now_ns) {
+    motion_sample_t sample;
+    
+    if (state->timing_flags & CONTROLLER_TIMING_REPLAYED) {
+        return;
+    }
+    
+    if (motion_decimate(d, now_ns - TIME_US(MOTION_ALIGN_DELAY_US), &sample) != 0) {
+        return;
+    }
+    copy_to_state(&sample, state);
+}
@@ -0,0 +1,238 @@
+/*
+ * RosettaPad - Event Loop
+ * ========================
+ * 
+ * epoll reactor with generation-tagged slots, plus timerfd/eventfd helpers.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+#include "core/common.h"
+#include "core/reactor.h"
+
+/* ============================================================================
+ * SHUTDOWN
+ * ============================================================================ */
+
+static int g_shutdown_fd = -1;
+static pthread_once_t g_shutdown_once = PTHREAD_ONCE_INIT;
+
+static void shutdown_fd_init(void) {
+    g_shutdown_fd = reactor_event_create();
+    if (g_shutdown_fd < 0) {
+        perror("[Reactor] eventfd");
+    }
+}
+
+void reactor_request_shutdown(void) {
+    g_running = 0;
+    if (g_shutdown_fd >= 0) {
+        reactor_event_signal(g_shutdown_fd);
+    }
+}
+
+/* ============================================================================
+ * LOOP
+ * 
+ * epoll data carries (generation << 32 | slot index) rather than a
+ * pointer, so an event collected before reactor_del() is recognised as
+ * stale and dropped instead of calling a handler for a closed fd.
+ * ============================================================================ */
+
+#define SLOT_SHUTDOWN   0xFFFFFFFFu
+
+static inline uint64_t slot_key(uint32_t index, uint32_t gen) {
+    return ((uint64_t)gen << 32) | index;
+}
+
+int reactor_init(reactor_t* r, const char* name) {
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    pthread_mutex_init(&r->lock, NULL);
+    for (int i = 0; i < REACTOR_MAX_SLOTS; i++) {
+        r->slots[i].fd = -1;
+    }
+    
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r->epfd < 0) {
+        perror("[Reactor] epoll_create1");
+        return -1;
+    }
+    
+    pthread_once(&g_shutdown_once, shutdown_fd_init);
+    if (g_shutdown_fd >= 0) {
+        struct epoll_event ev = {.events = EPOLLIN, .data.u64 = slot_key(SLOT_SHUTDOWN, 0)};
+        epoll_ctl(r->epfd, EPOLL_CTL_ADD, g_shutdown_fd, &ev);
+    }
+    
+    return 0;
+}
+
+void reactor_close(reactor_t* r) {
+    if (r->epfd >= 0) {
+        close(r->epfd);
+        r->epfd = -1;
+    }
+    pthread_mutex_destroy(&r->lock);
+}
+
+static int find_slot(reactor_t* r, int fd) {
+    for (int i = 0; i < REACTOR_MAX_SLOTS; i++) {
+        if (r->slots[i].fd == fd) return i;
+    }
+    return -1;
+}
+
+int reactor_add(reactor_t* r, int fd, uint32_t events, reactor_handler_t handler, void* ctx) {
+    pthread_mutex_lock(&r->lock);
+    
+    int i = find_slot(r, -1);
+    if (i < 0) {
+        pthread_mutex_unlock(&r->lock);
+        fprintf(stderr, "[Reactor] %s: no free slot for fd %d\n", r->name, fd);
+        return -1;
+    }
+    
+    reactor_slot_t* slot = &r->slots[i];
+    slot->gen++;
+    
+    struct epoll_event ev = {.events = events, .data.u64 = slot_key(i, slot->gen)};
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        pthread_mutex_unlock(&r->lock);
+        perror("[Reactor] epoll_ctl add");
+        return -1;
+    }
+    
+    slot->fd = fd;
+    slot->handler = handler;
+    slot->ctx = ctx;
+    
+    pthread_mutex_unlock(&r->lock);
+    return 0;
+}
+
+int reactor_mod(reactor_t* r, int fd, uint32_t events) {
+    pthread_mutex_lock(&r->lock);
+    
+    int i = find_slot(r, fd);
+    int ret = -1;
+    if (i >= 0) {
+        struct epoll_event ev = {.events = events, .data.u64 = slot_key(i, r->slots[i].gen)};
+        ret = epoll_ctl(r->epfd, EPOLL_CTL_MOD, fd, &ev);
+    }
+    
+    pthread_mutex_unlock(&r->lock);
+    return ret;
+}
+
+int reactor_del(reactor_t* r, int fd) {
+    if (fd < 0) return -1;
+    
+    pthread_mutex_lock(&r->lock);
+    
+    int i = find_slot(r, fd);
+    if (i >= 0) {
+        epoll_ctl(r->epfd, EPOLL_CTL_DEL, fd, NULL);
+        r->slots[i].fd = -1;
+        r->slots[i].gen++;      /* Invalidate events already collected */
+        r->slots[i].handler = NULL;
+        r->slots[i].ctx = NULL;
+    }
+    
+    pthread_mutex_unlock(&r->lock);
+    return (i >= 0) ? 0 : -1;
+}
+
+void reactor_run(reactor_t* r) {
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    
+    printf("[Reactor] %s loop started\n", r->name);
+    
+    while (g_running) {
+        int n = epoll_wait(r->epfd, events, REACTOR_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("[Reactor] epoll_wait");
+            break;
+        }
+        
+        r->wakeups++;
+        
+        for (int e = 0; e < n && g_running; e++) {
+            uint32_t index = (uint32_t)events[e].data.u64;
+            uint32_t gen = (uint32_t)(events[e].data.u64 >> 32);
+            
+            if (index == SLOT_SHUTDOWN) break;
+            if (index >= REACTOR_MAX_SLOTS) continue;
+            
+            /* Snapshot the slot - a handler may remove itself or others */
+            pthread_mutex_lock(&r->lock);
+            reactor_slot_t slot = r->slots[index];
+            pthread_mutex_unlock(&r->lock);
+            
+            if (slot.fd < 0 || slot.gen != gen || !slot.handler) continue;
+            
+            slot.handler(slot.fd, events[e].events, slot.ctx);
+        }
+    }
+    
+    printf("[Reactor] %s loop exiting\n", r->name);
+}
+
+/* ============================================================================
+ * TIMERS AND EVENTS
+ * ============================================================================ */
+
+int reactor_timer_create(void) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        perror("[Reactor] timerfd_create");
+    }
+    return fd;
+}
+
+int reactor_timer_set(int tfd, uint64_t first_ns, uint64_t period_ns) {
+    struct itimerspec its = {0};
+    
+    if (first_ns != 0) {
+        its.it_value = time_ns_to_timespec(first_ns);
+        its.it_interval = time_ns_to_timespec(period_ns);
+    }
+    
+    return timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+uint64_t reactor_timer_read(int tfd) {
+    uint64_t expirations = 0;
+    if (read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return 0;
+    }
+    return expirations;
+}
+
+int reactor_event_create(void) {
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        perror("[Reactor] eventfd");
+    }
+    return fd;
+}
+
+void reactor_event_signal(int efd) {
+    uint64_t one = 1;
+    ssize_t ret = write(efd, &one, sizeof(one));
+    (void)ret;
+}
+
+uint64_t reactor_event_read(int efd) {
+    uint64_t count = 0;
+    if (read(efd, &count, sizeof(count)) != sizeof(count)) {
+        return 0;
+    }
+    return count;
+}
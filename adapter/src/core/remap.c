@@ -0,0 +1,351 @@
+/*
+ * RosettaPad - Button / Axis Remapping
+ * =====================================
+ * 
+ * Profile parser, compiler and the per-report apply step.
+ * 
+ * The active table is published through one pointer. The input thread
+ * announces itself in g_remap_readers around each use, so a writer that
+ * swapped the pointer only has to wait for the report in progress (if
+ * any) before freeing the old table - the input thread never blocks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <sched.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include "core/remap.h"
+
+/* ============================================================================
+ * ACTIVE TABLE
+ * ============================================================================ */
+
+/* remap_apply() treats the six axis bytes as an array */
+_Static_assert(offsetof(controller_state_t, right_trigger) -
+               offsetof(controller_state_t, left_stick_x) == REMAP_AXIS_COUNT - 1,
+               "controller_state_t axes must be contiguous");
+
+static remap_table_t* g_remap_active = NULL;
+static int g_remap_readers = 0;
+static pthread_mutex_t g_remap_install_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char g_remap_path[PATH_MAX];
+
+/* ============================================================================
+ * NAMES
+ * ============================================================================ */
+
+static const struct {
+    const char* name;
+    int button;
+} g_button_names[] = {
+    { "cross",    BTN_SOUTH },     { "south",    BTN_SOUTH },
+    { "circle",   BTN_EAST },      { "east",     BTN_EAST },
+    { "square",   BTN_WEST },      { "west",     BTN_WEST },
+    { "triangle", BTN_NORTH },     { "north",    BTN_NORTH },
+    { "l1",       BTN_L1 },        { "r1",       BTN_R1 },
+    { "l2",       BTN_L2 },        { "r2",       BTN_R2 },
+    { "l3",       BTN_L3 },        { "r3",       BTN_R3 },
+    { "select",   BTN_SELECT },    { "start",    BTN_START },
+    { "ps",       BTN_HOME },      { "home",     BTN_HOME },
+    { "touchpad", BTN_TOUCHPAD },  { "mute",     BTN_MUTE },
+    { "up",       BTN_DPAD_UP },   { "down",     BTN_DPAD_DOWN },
+    { "left",     BTN_DPAD_LEFT }, { "right",    BTN_DPAD_RIGHT },
+};
+
+static const char* const g_axis_names[REMAP_AXIS_COUNT] = {
+    [REMAP_AXIS_LX] = "lx", [REMAP_AXIS_LY] = "ly",
+    [REMAP_AXIS_RX] = "rx", [REMAP_AXIS_RY] = "ry",
+    [REMAP_AXIS_LT] = "lt", [REMAP_AXIS_RT] = "rt",
+};
+
+int remap_button_by_name(const char* name) {
+    for (size_t i = 0; i < sizeof(g_button_names) / sizeof(g_button_names[0]); i++) {
+        if (strcasecmp(name, g_button_names[i].name) == 0) return g_button_names[i].button;
+    }
+    return -1;
+}
+
+int remap_axis_by_name(const char* name) {
+    for (int i = 0; i < REMAP_AXIS_COUNT; i++) {
+        if (strcasecmp(name, g_axis_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * PARSER / COMPILER
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t targets[BTN_COUNT];    /* Per source button */
+    uint8_t touched[BTN_COUNT];     /* Identity already dropped */
+} remap_builder_t;
+
+static void drop_identity(remap_builder_t* b, int src) {
+    if (!b->touched[src]) {
+        b->targets[src] = 0;
+        b->touched[src] = 1;
+    }
+}
+
+/* "<button> = <target>" */
+static int parse_button_rule(remap_table_t* t, remap_builder_t* b,
+                             const char* src_name, const char* target, char* err) {
+    int src = remap_button_by_name(src_name);
+    if (src < 0) {
+        snprintf(err, REMAP_MAX_LINE, "unknown button '%s'", src_name);
+        return -1;
+    }
+    
+    if (strcasecmp(target, "none") == 0) {
+        drop_identity(b, src);
+        return 0;
+    }
+    
+    int dst = remap_button_by_name(target);
+    if (dst >= 0) {
+        drop_identity(b, src);
+        b->targets[src] |= 1u << dst;
+        return 0;
+    }
+    
+    /* Axis target: "lx-", "ry+", or a whole trigger "lt" */
+    char axis_name[8];
+    size_t len = strlen(target);
+    uint8_t value = 255;
+    
+    if (len == 0 || len >= sizeof(axis_name)) {
+        snprintf(err, REMAP_MAX_LINE, "bad target '%s'", target);
+        return -1;
+    }
+    memcpy(axis_name, target, len + 1);
+    if (axis_name[len - 1] == '-' || axis_name[len - 1] == '+') {
+        value = (axis_name[len - 1] == '-') ? 0 : 255;
+        axis_name[len - 1] = '\0';
+    }
+    
+    int axis = remap_axis_by_name(axis_name);
+    int is_trigger = (axis == REMAP_AXIS_LT || axis == REMAP_AXIS_RT);
+    if (axis < 0 || is_trigger != (len == strlen(axis_name))) {
+        snprintf(err, REMAP_MAX_LINE, "bad target '%s' (button, none, lx-/lx+ ... ry+, lt or rt)", target);
+        return -1;
+    }
+    if (t->num_button_axes >= REMAP_MAX_BUTTON_AXES) {
+        snprintf(err, REMAP_MAX_LINE, "too many button-to-axis rules");
+        return -1;
+    }
+    
+    drop_identity(b, src);
+    remap_button_axis_t* ba = &t->button_axes[t->num_button_axes++];
+    ba->mask = 1u << src;
+    ba->axis = (uint8_t)axis;
+    ba->value = value;
+    return 0;
+}
+
+static int parse_line(remap_table_t* t, remap_builder_t* b, const char* line, char* err) {
+    char a[32], c[32];
+    int n;
+    
+    if (sscanf(line, "axis %31s = %31s", a, c) == 2) {
+        int out = remap_axis_by_name(a), in = remap_axis_by_name(c);
+        if (out < 0 || in < 0) {
+            snprintf(err, REMAP_MAX_LINE, "unknown axis");
+            return -1;
+        }
+        t->axis_source[out] = (uint8_t)in;
+        return 0;
+    }
+    
+    if (sscanf(line, "invert %31s", a) == 1) {
+        int axis = remap_axis_by_name(a);
+        if (axis < 0) {
+            snprintf(err, REMAP_MAX_LINE, "unknown axis '%s'", a);
+            return -1;
+        }
+        t->axis_invert[axis] = 0xFF;
+        return 0;
+    }
+    
+    if (sscanf(line, "threshold %31s = %d", a, &n) == 2) {
+        int axis = remap_axis_by_name(a);
+        if ((axis != REMAP_AXIS_LT && axis != REMAP_AXIS_RT) || n < 1 || n > 255) {
+            snprintf(err, REMAP_MAX_LINE, "threshold needs lt or rt and a value 1-255");
+            return -1;
+        }
+        t->trigger_threshold[axis - REMAP_AXIS_LT] = (uint8_t)n;
+        return 0;
+    }
+    
+    if (sscanf(line, "%31s = %31s", a, c) == 2) {
+        return parse_button_rule(t, b, a, c, err);
+    }
+    
+    snprintf(err, REMAP_MAX_LINE, "syntax error");
+    return -1;
+}
+
+static void compile_buttons(remap_table_t* t, const remap_builder_t* b) {
+    t->buttons_identity = 1;
+    for (int i = 0; i < BTN_COUNT; i++) {
+        if (b->targets[i] != (1u << i)) t->buttons_identity = 0;
+    }
+    
+    for (int byte = 0; byte < 3; byte++) {
+        for (int v = 0; v < 256; v++) {
+            uint32_t out = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                int btn = byte * 8 + bit;
+                if ((v & (1 << bit)) && btn < BTN_COUNT) out |= b->targets[btn];
+            }
+            t->buttons[byte][v] = out;
+        }
+    }
+}
+
+remap_table_t* remap_compile_file(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror("[Remap] Failed to open profile");
+        return NULL;
+    }
+    
+    remap_table_t* t = calloc(1, sizeof(*t));
+    remap_builder_t b;
+    if (!t) {
+        fclose(f);
+        return NULL;
+    }
+    
+    for (int i = 0; i < BTN_COUNT; i++) {
+        b.targets[i] = 1u << i;
+        b.touched[i] = 0;
+    }
+    for (int i = 0; i < REMAP_AXIS_COUNT; i++) {
+        t->axis_source[i] = (uint8_t)i;
+    }
+    
+    char line[REMAP_MAX_LINE];
+    char err[REMAP_MAX_LINE];
+    int lineno = 0, rules = 0;
+    
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') continue;
+        
+        if (parse_line(t, &b, p, err) < 0) {
+            printf("[Remap] %s:%d: %s\n", path, lineno, err);
+            fclose(f);
+            free(t);
+            return NULL;
+        }
+        rules++;
+    }
+    fclose(f);
+    
+    compile_buttons(t, &b);
+    printf("[Remap] Compiled %s (%d rules)\n", path, rules);
+    return t;
+}
+
+/* ============================================================================
+ * INSTALL
+ * ============================================================================ */
+
+void remap_install(remap_table_t* table) {
+    pthread_mutex_lock(&g_remap_install_mutex);
+    
+    remap_table_t* old = __atomic_exchange_n(&g_remap_active, table, __ATOMIC_SEQ_CST);
+    
+    /* Anyone who picked up `old` is counted; new readers get `table` */
+    while (__atomic_load_n(&g_remap_readers, __ATOMIC_SEQ_CST) != 0) {
+        sched_yield();
+    }
+    free(old);
+    
+    pthread_mutex_unlock(&g_remap_install_mutex);
+}
+
+int remap_load(const char* path) {
+    remap_table_t* t = remap_compile_file(path);
+    if (!t) return -1;
+    
+    if (path != g_remap_path) {
+        snprintf(g_remap_path, sizeof(g_remap_path), "%s", path);
+    }
+    remap_install(t);
+    return 0;
+}
+
+int remap_reload(void) {
+    if (g_remap_path[0] == '\0') return 0;
+    
+    printf("[Remap] Reloading %s\n", g_remap_path);
+    return remap_load(g_remap_path);
+}
+
+/* ============================================================================
+ * APPLY
+ * ============================================================================ */
+
+static void apply_table(const remap_table_t* t, controller_state_t* state) {
+    uint32_t in = state->buttons;
+    
+    /* Digital L2/R2 from the analog triggers */
+    if (t->trigger_threshold[0]) {
+        in &= ~(1u << BTN_L2);
+        if (state->left_trigger >= t->trigger_threshold[0]) in |= 1u << BTN_L2;
+    }
+    if (t->trigger_threshold[1]) {
+        in &= ~(1u << BTN_R2);
+        if (state->right_trigger >= t->trigger_threshold[1]) in |= 1u << BTN_R2;
+    }
+    
+    /* Axes: source lookup + invert, then buttons held down to an axis */
+    uint8_t axes[REMAP_AXIS_COUNT];
+    memcpy(axes, &state->left_stick_x, REMAP_AXIS_COUNT);
+    
+    uint8_t* out_axes = &state->left_stick_x;
+    for (int i = 0; i < REMAP_AXIS_COUNT; i++) {
+        out_axes[i] = axes[t->axis_source[i]] ^ t->axis_invert[i];
+    }
+    for (int i = 0; i < t->num_button_axes; i++) {
+        if (in & t->button_axes[i].mask) {
+            out_axes[t->button_axes[i].axis] = t->button_axes[i].value;
+        }
+    }
+    
+    uint32_t out = in;
+    if (!t->buttons_identity) {
+        out = t->buttons[0][in & 0xFF] |
+              t->buttons[1][(in >> 8) & 0xFF] |
+              t->buttons[2][(in >> 16) & 0xFF];
+    }
+    
+    /* Native button bytes no longer describe the buttons */
+    if (out != state->buttons) {
+        state->native_format = CONTROLLER_NATIVE_NONE;
+    }
+    state->buttons = out;
+}
+
+void remap_apply(controller_state_t* state) {
+    if (!__atomic_load_n(&g_remap_active, __ATOMIC_RELAXED)) return;
+    
+    __atomic_fetch_add(&g_remap_readers, 1, __ATOMIC_SEQ_CST);
+    const remap_table_t* t = __atomic_load_n(&g_remap_active, __ATOMIC_SEQ_CST);
+    if (t) apply_table(t, state);
+    __atomic_fetch_sub(&g_remap_readers, 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,176 @@
+/*
+ * RosettaPad - Real-Time Profile
+ * ===============================
+ * 
+ * Scheduling, affinity and memory locking for the hot threads.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+
+#include "core/common.h"
+#include "core/rt.h"
+#include "console/ps3/ds3_emulation.h"
+
+rt_profile_t g_rt_profile = {
+    .enabled = 0,
+    .priority = RT_DEFAULT_PRIORITY,
+    .cpu = RT_CPU_AUTO,
+    .lock_memory = 1
+};
+
+static const char* thread_names[RT_THREAD_COUNT] = {
+    [RT_THREAD_INPUT] = "input",
+    [RT_THREAD_EP1]   = "ep1",
+};
+
+/* Resolved hot core (-1 = not pinned) */
+static int g_rt_cpu = -1;
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+int rt_mutex_make_pi(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    
+    if (pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT) != 0) {
+        pthread_mutexattr_destroy(&attr);
+        return -1;
+    }
+    
+    pthread_mutex_destroy(mutex);
+    int ret = pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return (ret == 0) ? 0 : -1;
+}
+
+static int resolve_cpu(void) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    if (g_rt_profile.cpu == RT_CPU_NONE) return -1;
+    if (ncpu < 2) return -1;  /* Nothing to dedicate on a single core */
+    if (g_rt_profile.cpu == RT_CPU_AUTO) return (int)(ncpu - 1);
+    if (g_rt_profile.cpu >= ncpu) {
+        printf("[RT] CPU %d not online (have %ld), not pinning\n", g_rt_profile.cpu, ncpu);
+        return -1;
+    }
+    return g_rt_profile.cpu;
+}
+
+/* Touch the stack now so the first deep call doesn't fault */
+static void prefault_stack(void) {
+    volatile unsigned char stack[RT_STACK_PREFAULT];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+/* ============================================================================
+ * PROCESS SETUP
+ * ============================================================================ */
+
+void rt_init(void) {
+    if (!g_rt_profile.enabled) {
+        printf("[RT] Real-time profile disabled\n");
+        return;
+    }
+    
+    printf("[RT] Applying real-time profile...\n");
+    
+    /* Memory locking */
+    if (g_rt_profile.lock_memory) {
+        int flags = MCL_CURRENT | MCL_FUTURE;
+#ifdef MCL_ONFAULT
+        /* Lock pages as they are touched instead of populating every
+         * thread stack up front - hot stacks are prefaulted explicitly */
+        flags |= MCL_ONFAULT;
+#endif
+        if (mlockall(flags) == 0) {
+            printf("[RT] Memory: locked\n");
+        } else {
+            printf("[RT] Memory: mlockall failed (%s) - page faults possible\n", strerror(errno));
+        }
+    }
+    
+    /* Priority inheritance for mutexes shared with normal threads */
+    int pi_ok = (rt_mutex_make_pi(&g_controller_state_mutex) == 0);
+    pi_ok &= (rt_mutex_make_pi(&g_ds3_report_mutex) == 0);
+    printf("[RT] Mutexes: %s\n", pi_ok ? "priority inheritance" : "PI not supported");
+    
+    /* Keep this thread (and everything it spawns) off the hot core */
+    g_rt_cpu = resolve_cpu();
+    if (g_rt_cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        for (int i = 0; i < ncpu; i++) {
+            if (i != g_rt_cpu) CPU_SET(i, &set);
+        }
+        
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+            printf("[RT] CPU %d reserved for input path\n", g_rt_cpu);
+        } else {
+            printf("[RT] Could not set affinity - not pinning\n");
+            g_rt_cpu = -1;
+        }
+    } else {
+        printf("[RT] CPU pinning: off\n");
+    }
+}
+
+/* ============================================================================
+ * THREAD SETUP
+ * ============================================================================ */
+
+void rt_thread_enter(rt_thread_t which) {
+    if (!g_rt_profile.enabled || which >= RT_THREAD_COUNT) return;
+    
+    const char* name = thread_names[which];
+    char sched_str[48];
+    char cpu_str[24];
+    
+    /* Hot threads are ordered: input above ep1 */
+    int priority = g_rt_profile.priority - (int)which;
+    int max = sched_get_priority_max(SCHED_FIFO);
+    int min = sched_get_priority_min(SCHED_FIFO);
+    if (priority > max) priority = max;
+    if (priority < min) priority = min;
+    
+    struct sched_param param = {.sched_priority = priority};
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err == 0) {
+        snprintf(sched_str, sizeof(sched_str), "SCHED_FIFO %d", priority);
+    } else {
+        snprintf(sched_str, sizeof(sched_str), "SCHED_OTHER (FIFO: %s)", strerror(err));
+    }
+    
+    /* Affinity */
+    if (g_rt_cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(g_rt_cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+            snprintf(cpu_str, sizeof(cpu_str), "CPU %d", g_rt_cpu);
+        } else {
+            snprintf(cpu_str, sizeof(cpu_str), "CPU any (pin failed)");
+        }
+    } else {
+        snprintf(cpu_str, sizeof(cpu_str), "CPU any");
+    }
+    
+    /* Timer slack (per thread; RT threads already get none) */
+    int slack_ok = (prctl(PR_SET_TIMERSLACK, RT_TIMER_SLACK_NS, 0, 0, 0) == 0);
+    
+    prefault_stack();
+    
+    printf("[RT] %s thread: %s, %s, timer slack %s\n", name, sched_str, cpu_str,
+           slack_ok ? "1us" : "default");
+}
@@ -0,0 +1,107 @@
+/*
+ * RosettaPad - File Spool
+ * ========================
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "core/common.h"
+#include "core/spool.h"
+
+static void spool_perror(const spool_t* s, const char* what) {
+    fprintf(stderr, "%s %s: %s\n", s->tag, what, strerror(errno));
+}
+
+int spool_open(spool_t* s, const char* path, size_t size,
+               const void* header, size_t header_len, const char* tag) {
+    memset(s, 0, sizeof(*s));
+    s->tag = tag;
+    s->size = size;
+    s->drain_timer_fd = -1;
+    
+    s->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (s->fd < 0) {
+        spool_perror(s, path);
+        return -1;
+    }
+    
+    /* Populated up front so the producer never page-faults */
+    s->ring = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (s->ring == MAP_FAILED) {
+        spool_perror(s, "mmap");
+        s->ring = NULL;
+        close(s->fd);
+        s->fd = -1;
+        return -1;
+    }
+    
+    if (write(s->fd, header, header_len) != (ssize_t)header_len) {
+        spool_perror(s, "write");
+        munmap(s->ring, size);
+        s->ring = NULL;
+        close(s->fd);
+        s->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void spool_drain(spool_t* s) {
+    uint64_t head = __atomic_load_n(&s->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = s->tail;
+    
+    while (tail < head) {
+        size_t off = tail & (s->size - 1);
+        size_t chunk = head - tail;
+        if (chunk > s->size - off) chunk = s->size - off;
+        
+        ssize_t n = write(s->fd, s->ring + off, chunk);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            spool_perror(s, "write");
+            break;
+        }
+        tail += n;
+        s->bytes_written += n;
+    }
+    __atomic_store_n(&s->tail, tail, __ATOMIC_RELEASE);
+    
+    if (s->on_drain) s->on_drain(s->ctx);
+}
+
+static void spool_drain_handler(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    if (reactor_timer_read(fd) == 0) return;
+    spool_drain(ctx);
+}
+
+int spool_attach(spool_t* s, reactor_t* r, uint32_t interval_ms,
+                 void (*on_drain)(void* ctx), void* ctx) {
+    s->on_drain = on_drain;
+    s->ctx = ctx;
+    
+    s->drain_timer_fd = reactor_timer_create();
+    if (s->drain_timer_fd < 0 ||
+        reactor_add(r, s->drain_timer_fd, EPOLLIN, spool_drain_handler, s) < 0) {
+        return -1;
+    }
+    
+    return reactor_timer_set(s->drain_timer_fd, time_now_ns() + TIME_MS(interval_ms),
+                             TIME_MS(interval_ms));
+}
+
+void spool_close(spool_t* s) {
+    if (s->fd < 0) return;
+    
+    spool_drain(s);
+    close(s->fd);
+    s->fd = -1;
+    munmap(s->ring, s->size);
+    s->ring = NULL;
+}
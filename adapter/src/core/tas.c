@@ -0,0 +1,603 @@
+/*
+ * RosettaPad - TAS Recording and Playback
+ * ========================================
+ * 
+ * See core/tas.h for the log format.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "core/common.h"
+#include "core/latency.h"
+#include "core/spool.h"
+#include "core/tas.h"
+
+/* ============================================================================
+ * ENCODING
+ * ============================================================================ */
+
+static const tas_frame_t g_zero_frame;
+
+static size_t put_varint(uint8_t* p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static int get_varint(const uint8_t** p, const uint8_t* end, uint64_t* out) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*p >= end) return -1;
+        uint8_t b = *(*p)++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static inline uint64_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint64_t v) {
+    return (int32_t)((uint32_t)(v >> 1) ^ -(uint32_t)(v & 1));
+}
+
+static int is_keyframe(uint64_t frame) {
+    return (frame % TAS_KEYFRAME_INTERVAL) == 0;
+}
+
+/* Encode `f` against `ref` (the previous frame, or zero for a keyframe) */
+static size_t encode_frame(const tas_frame_t* ref, const tas_frame_t* f, int key, uint8_t* out) {
+    uint32_t mask = key ? TAS_FIELD_ALL : 0;
+    
+    if (!key) {
+        if (f->buttons != ref->buttons) mask |= TAS_FIELD_BUTTONS;
+        for (int i = 0; i < 6; i++) {
+            if (f->axes[i] != ref->axes[i]) mask |= TAS_FIELD_AXIS(i);
+            if (f->motion[i] != ref->motion[i]) mask |= TAS_FIELD_MOTION(i);
+        }
+        if (memcmp(f->battery, ref->battery, sizeof(f->battery)) != 0) mask |= TAS_FIELD_BATTERY;
+    }
+    
+    size_t n = put_varint(out, f->time_ns - ref->time_ns);
+    n += put_varint(out + n, mask);
+    
+    if (mask & TAS_FIELD_BUTTONS) n += put_varint(out + n, f->buttons);
+    for (int i = 0; i < 6; i++) {
+        if (mask & TAS_FIELD_AXIS(i)) out[n++] = f->axes[i];
+    }
+    for (int i = 0; i < 6; i++) {
+        if (mask & TAS_FIELD_MOTION(i)) {
+            n += put_varint(out + n, zigzag((int32_t)f->motion[i] - ref->motion[i]));
+        }
+    }
+    if (mask & TAS_FIELD_BATTERY) {
+        memcpy(out + n, f->battery, sizeof(f->battery));
+        n += sizeof(f->battery);
+    }
+    
+    return n;
+}
+
+static int decode_frame(const uint8_t** p, const uint8_t* end,
+                        const tas_frame_t* ref, tas_frame_t* out) {
+    uint64_t dt, mask, v;
+    
+    if (get_varint(p, end, &dt) < 0 || get_varint(p, end, &mask) < 0) return -1;
+    if (mask & ~(uint64_t)TAS_FIELD_ALL) return -1;
+    
+    *out = *ref;
+    out->time_ns = ref->time_ns + dt;
+    
+    if (mask & TAS_FIELD_BUTTONS) {
+        if (get_varint(p, end, &v) < 0) return -1;
+        out->buttons = (uint32_t)v;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (mask & TAS_FIELD_AXIS(i)) {
+            if (*p >= end) return -1;
+            out->axes[i] = *(*p)++;
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        if (mask & TAS_FIELD_MOTION(i)) {
+            if (get_varint(p, end, &v) < 0) return -1;
+            out->motion[i] = (int16_t)(ref->motion[i] + unzigzag(v));
+        }
+    }
+    if (mask & TAS_FIELD_BATTERY) {
+        if (end - *p < (ptrdiff_t)sizeof(out->battery)) return -1;
+        memcpy(out->battery, *p, sizeof(out->battery));
+        *p += sizeof(out->battery);
+    }
+    
+    return 0;
+}
+
+static void state_to_frame(const controller_state_t* s, tas_frame_t* f) {
+    f->buttons = s->buttons;
+    memcpy(f->axes, &s->left_stick_x, sizeof(f->axes));
+    f->motion[0] = s->accel_x;
+    f->motion[1] = s->accel_y;
+    f->motion[2] = s->accel_z;
+    f->motion[3] = s->gyro_x;
+    f->motion[4] = s->gyro_y;
+    f->motion[5] = s->gyro_z;
+    f->battery[0] = s->battery_level;
+    f->battery[1] = s->battery_charging;
+    f->battery[2] = s->battery_full;
+}
+
+void tas_frame_to_state(const tas_frame_t* f, controller_state_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->buttons = f->buttons;
+    memcpy(&out->left_stick_x, f->axes, sizeof(f->axes));
+    out->accel_x = f->motion[0];
+    out->accel_y = f->motion[1];
+    out->accel_z = f->motion[2];
+    out->gyro_x = f->motion[3];
+    out->gyro_y = f->motion[4];
+    out->gyro_z = f->motion[5];
+    out->battery_level = f->battery[0];
+    out->battery_charging = f->battery[1];
+    out->battery_full = f->battery[2];
+    out->timing_flags = CONTROLLER_TIMING_REPLAYED;
+    out->native_format = CONTROLLER_NATIVE_NONE;
+}
+
+/* ============================================================================
+ * RECORDING
+ * 
+ * Producer: input thread (tas_record). Consumer: control loop (drain).
+ * Frame records go through a spool (core/spool.h); keyframe index entries
+ * through a small ring of their own, collected after each spool drain.
+ * ============================================================================ */
+
+static struct {
+    int active;
+    spool_t spool;                      /* Frame records, TAS_RING_SIZE */
+    
+    tas_index_entry_t index_ring[TAS_INDEX_RING_SIZE];
+    uint64_t index_head;
+    uint64_t index_tail;
+    
+    /* Producer */
+    uint64_t start_time_ns;
+    uint64_t frames;
+    uint64_t dropped;
+    tas_frame_t prev;
+    
+    /* Consumer */
+    tas_index_entry_t* index;
+    uint64_t index_count;
+    uint64_t index_capacity;
+} g_rec;
+
+int tas_record_open(const char* path) {
+    /* Nothing carries over from an earlier recording */
+    memset(&g_rec, 0, sizeof(g_rec));
+    
+    /* Placeholder header; the real one is written on close */
+    tas_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TAS_MAGIC, sizeof(header.magic));
+    header.version = TAS_VERSION;
+    header.keyframe_interval = TAS_KEYFRAME_INTERVAL;
+    
+    if (spool_open(&g_rec.spool, path, TAS_RING_SIZE, &header, sizeof(header), "[TAS]") < 0) {
+        return -1;
+    }
+    
+    g_rec.active = 1;
+    printf("[TAS] Recording to %s\n", path);
+    return 0;
+}
+
+void tas_record(const controller_state_t* state) {
+    if (!g_rec.active) return;
+    
+    tas_frame_t f;
+    if (g_rec.frames == 0) g_rec.start_time_ns = state->publish_time_ns;
+    state_to_frame(state, &f);
+    f.time_ns = state->publish_time_ns - g_rec.start_time_ns;
+    
+    int key = is_keyframe(g_rec.frames);
+    uint8_t buf[TAS_MAX_RECORD];
+    size_t n = encode_frame(key ? &g_zero_frame : &g_rec.prev, &f, key, buf);
+    
+    uint64_t index_tail = __atomic_load_n(&g_rec.index_tail, __ATOMIC_ACQUIRE);
+    
+    if (!spool_room(&g_rec.spool, n) ||
+        (key && g_rec.index_head - index_tail >= TAS_INDEX_RING_SIZE)) {
+        /* Drain fell behind - drop. The delta chain still refers to the
+         * last frame actually written, so the log stays consistent. */
+        g_rec.dropped++;
+        return;
+    }
+    
+    if (key) {
+        tas_index_entry_t* e = &g_rec.index_ring[g_rec.index_head % TAS_INDEX_RING_SIZE];
+        e->frame = g_rec.frames;
+        e->offset = sizeof(tas_header_t) + g_rec.spool.head;
+        e->time_ns = f.time_ns;
+        __atomic_store_n(&g_rec.index_head, g_rec.index_head + 1, __ATOMIC_RELEASE);
+    }
+    
+    spool_put(&g_rec.spool, 0, buf, n);
+    spool_commit(&g_rec.spool, n);
+    
+    g_rec.prev = f;
+    g_rec.frames++;
+}
+
+/* Keyframe index entries, after each drain of the frame records */
+static void tas_drain_index(void* ctx) {
+    (void)ctx;
+    uint64_t index_head = __atomic_load_n(&g_rec.index_head, __ATOMIC_ACQUIRE);
+    while (g_rec.index_tail < index_head) {
+        if (g_rec.index_count == g_rec.index_capacity) {
+            uint64_t cap = g_rec.index_capacity ? g_rec.index_capacity * 2 : 256;
+            tas_index_entry_t* grown = realloc(g_rec.index, cap * sizeof(*grown));
+            if (!grown) break;
+            g_rec.index = grown;
+            g_rec.index_capacity = cap;
+        }
+        g_rec.index[g_rec.index_count++] = g_rec.index_ring[g_rec.index_tail % TAS_INDEX_RING_SIZE];
+        __atomic_store_n(&g_rec.index_tail, g_rec.index_tail + 1, __ATOMIC_RELEASE);
+    }
+}
+
+int tas_record_attach(reactor_t* r) {
+    if (!g_rec.active) return 0;
+    return spool_attach(&g_rec.spool, r, TAS_DRAIN_INTERVAL_MS, tas_drain_index, NULL);
+}
+
+void tas_record_close(void) {
+    if (!g_rec.active) return;
+    g_rec.active = 0;
+    
+    /* The drain timer may never have been attached */
+    g_rec.spool.on_drain = tas_drain_index;
+    spool_drain(&g_rec.spool);
+    
+    tas_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TAS_MAGIC, sizeof(header.magic));
+    header.version = TAS_VERSION;
+    header.keyframe_interval = TAS_KEYFRAME_INTERVAL;
+    header.start_time_ns = g_rec.start_time_ns;
+    header.frame_count = g_rec.frames;
+    header.index_offset = sizeof(tas_header_t) + g_rec.spool.bytes_written;
+    header.index_count = g_rec.index_count;
+    
+    size_t index_size = g_rec.index_count * sizeof(tas_index_entry_t);
+    if ((index_size && write(g_rec.spool.fd, g_rec.index, index_size) != (ssize_t)index_size) ||
+        pwrite(g_rec.spool.fd, &header, sizeof(header), 0) != sizeof(header)) {
+        perror("[TAS] Failed to finish log");
+    }
+    
+    printf("[TAS] Recorded %llu frames (%llu bytes, %llu dropped)\n",
+           (unsigned long long)g_rec.frames, (unsigned long long)g_rec.spool.bytes_written,
+           (unsigned long long)g_rec.dropped);
+    
+    spool_close(&g_rec.spool);
+    free(g_rec.index);
+    g_rec.index = NULL;
+}
+
+/* ============================================================================
+ * READING
+ * ============================================================================ */
+
+/* No index (log wasn't closed) - rebuild it and count frames */
+static int reader_scan(tas_reader_t* r) {
+    tas_frame_t prev = g_zero_frame, f;
+    const uint8_t* p = r->map + sizeof(tas_header_t);
+    uint64_t frame = 0, capacity = 0;
+    
+    while (p < r->data_end) {
+        const uint8_t* start = p;
+        int key = is_keyframe(frame);
+        
+        if (decode_frame(&p, r->data_end, key ? &g_zero_frame : &prev, &f) < 0) {
+            break;  /* Torn last record */
+        }
+        
+        if (key) {
+            if (r->index_count == capacity) {
+                capacity = capacity ? capacity * 2 : 256;
+                tas_index_entry_t* grown = realloc(r->index, capacity * sizeof(*grown));
+                if (!grown) return -1;
+                r->index = grown;
+            }
+            tas_index_entry_t* e = &r->index[r->index_count++];
+            e->frame = frame;
+            e->offset = start - r->map;
+            e->time_ns = f.time_ns;
+        }
+        prev = f;
+        frame++;
+    }
+    
+    r->frame_count = frame;
+    r->data_end = p;
+    return 0;
+}
+
+/* Index from the file - seek trusts it, so every entry must be plausible */
+static int reader_index_valid(const tas_reader_t* r) {
+    uint64_t data_size = r->data_end - r->map;
+    
+    if (r->frame_count > 0 && (r->index_count == 0 || r->index[0].frame != 0)) return 0;
+    for (uint64_t i = 0; i < r->index_count; i++) {
+        const tas_index_entry_t* e = &r->index[i];
+        if (e->offset < sizeof(tas_header_t) || e->offset >= data_size ||
+            !is_keyframe(e->frame) || e->frame >= r->frame_count) {
+            return 0;
+        }
+        if (i > 0 && (e->frame <= e[-1].frame || e->offset <= e[-1].offset)) return 0;
+    }
+    return 1;
+}
+
+int tas_reader_open(tas_reader_t* r, const char* path) {
+    memset(r, 0, sizeof(*r));
+    
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror("[TAS] Failed to open log");
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(tas_header_t)) {
+        printf("[TAS] %s: not a TAS log\n", path);
+        close(fd);
+        return -1;
+    }
+    
+    r->map_size = st.st_size;
+    r->map = mmap(NULL, r->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (r->map == MAP_FAILED) {
+        perror("[TAS] mmap");
+        return -1;
+    }
+    
+    memcpy(&r->header, r->map, sizeof(r->header));
+    if (memcmp(r->header.magic, TAS_MAGIC, sizeof(r->header.magic)) != 0 ||
+        r->header.version != TAS_VERSION ||
+        r->header.keyframe_interval != TAS_KEYFRAME_INTERVAL) {
+        printf("[TAS] %s: not a TAS log (or unsupported version)\n", path);
+        tas_reader_close(r);
+        return -1;
+    }
+    
+    /* Bound the count before multiplying: a crafted one must not wrap */
+    uint64_t index_offset = r->header.index_offset;
+    if (index_offset >= sizeof(tas_header_t) && index_offset <= r->map_size &&
+        r->header.index_count <= (r->map_size - index_offset) / sizeof(tas_index_entry_t)) {
+        r->data_end = r->map + r->header.index_offset;
+        r->frame_count = r->header.frame_count;
+        r->index_count = r->header.index_count;
+        r->index = malloc(r->index_count * sizeof(tas_index_entry_t) + 1);
+        if (!r->index) {
+            tas_reader_close(r);
+            return -1;
+        }
+        memcpy(r->index, r->map + r->header.index_offset,
+               r->index_count * sizeof(tas_index_entry_t));
+        
+        /* Records still end where the index starts */
+        if (!reader_index_valid(r)) {
+            printf("[TAS] %s: corrupt index, scanning\n", path);
+            free(r->index);
+            r->index = NULL;
+            r->index_count = 0;
+        }
+    } else {
+        printf("[TAS] %s: no index (not closed cleanly), scanning\n", path);
+        r->data_end = r->map + r->map_size;
+    }
+    
+    if (!r->index) {
+        if (reader_scan(r) < 0) {
+            tas_reader_close(r);
+            return -1;
+        }
+    }
+    
+    return tas_reader_seek(r, 0) < 0 && r->frame_count > 0 ? -1 : 0;
+}
+
+void tas_reader_close(tas_reader_t* r) {
+    if (r->map && r->map != MAP_FAILED) munmap((void*)r->map, r->map_size);
+    free(r->index);
+    memset(r, 0, sizeof(*r));
+}
+
+int tas_reader_seek(tas_reader_t* r, uint64_t frame) {
+    if (frame >= r->frame_count || r->index_count == 0) return -1;
+    
+    /* Last keyframe at or before `frame` */
+    uint64_t lo = 0, hi = r->index_count;
+    while (hi - lo > 1) {
+        uint64_t mid = (lo + hi) / 2;
+        if (r->index[mid].frame <= frame) lo = mid; else hi = mid;
+    }
+    
+    r->pos = r->map + r->index[lo].offset;
+    r->frame = r->index[lo].frame;
+    r->prev = g_zero_frame;
+    
+    tas_frame_t skip;
+    while (r->frame < frame) {
+        if (tas_reader_next(r, &skip) != 1) return -1;
+    }
+    return 0;
+}
+
+int tas_reader_next(tas_reader_t* r, tas_frame_t* out) {
+    if (r->frame >= r->frame_count || r->pos >= r->data_end) return 0;
+    
+    const tas_frame_t* ref = is_keyframe(r->frame) ? &g_zero_frame : &r->prev;
+    if (decode_frame(&r->pos, r->data_end, ref, out) < 0) return -1;
+    
+    r->prev = *out;
+    r->frame++;
+    return 1;
+}
+
+/* ============================================================================
+ * PLAYBACK (input thread)
+ * ============================================================================ */
+
+typedef enum {
+    TAS_PLAY_OFF = 0,
+    TAS_PLAY_WAITING,       /* For a console */
+    TAS_PLAY_RUNNING,
+    TAS_PLAY_DONE
+} tas_play_state_t;
+
+#define TAS_PLAY_WAIT_POLL_MS   50
+#define TAS_PLAY_START_DELAY_MS 100
+
+static struct {
+    tas_reader_t reader;
+    tas_play_hooks_t hooks;
+    volatile tas_play_state_t state;
+    int timer_fd;
+    
+    tas_frame_t next;
+    uint64_t origin_ns;         /* Host time of the first frame played */
+    uint64_t base_ns;           /* Its recorded time */
+    uint64_t scheduled_ns;      /* When `next` is due */
+    
+    uint64_t start_frame;
+    uint64_t frames_played;
+    uint64_t max_late_ns;
+} g_play = { .timer_fd = -1 };
+
+int tas_play_open(const char* path, uint64_t start_frame) {
+    if (tas_reader_open(&g_play.reader, path) < 0) return -1;
+    
+    if (tas_reader_seek(&g_play.reader, start_frame) < 0 ||
+        tas_reader_next(&g_play.reader, &g_play.next) != 1) {
+        printf("[TAS] %s: frame %llu out of range (%llu frames)\n", path,
+               (unsigned long long)start_frame, (unsigned long long)g_play.reader.frame_count);
+        tas_reader_close(&g_play.reader);
+        return -1;
+    }
+    
+    g_play.start_frame = start_frame;
+    g_play.state = TAS_PLAY_WAITING;
+    printf("[TAS] Playing %s from frame %llu of %llu\n", path,
+           (unsigned long long)start_frame, (unsigned long long)g_play.reader.frame_count);
+    return 0;
+}
+
+static void play_schedule(void) {
+    uint64_t t = g_play.origin_ns + (g_play.next.time_ns - g_play.base_ns);
+    
+    /* Snap to the host poll this frame would have made */
+    if (g_play.hooks.publish_slot) {
+        uint64_t slot = g_play.hooks.publish_slot(t);
+        if (slot) t = slot;
+    }
+    
+    g_play.scheduled_ns = t;
+    reactor_timer_set(g_play.timer_fd, t, 0);
+}
+
+static void tas_play_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    if (reactor_timer_read(fd) == 0) return;
+    
+    if (g_play.state == TAS_PLAY_WAITING) {
+        if (!g_play.hooks.console_ready || !g_play.hooks.console_ready()) return;
+        
+        printf("[TAS] Console connected - starting playback\n");
+        g_play.origin_ns = time_now_ns() + TIME_MS(TAS_PLAY_START_DELAY_MS);
+        g_play.base_ns = g_play.next.time_ns;
+        g_play.state = TAS_PLAY_RUNNING;
+        play_schedule();
+        return;
+    }
+    
+    if (g_play.state != TAS_PLAY_RUNNING) return;
+    
+    controller_state_t state;
+    tas_frame_to_state(&g_play.next, &state);
+    state.timestamp_ns = state.rx_time_ns = time_now_ns();
+    g_play.hooks.publish(&state);
+    
+    uint64_t late = state.publish_time_ns - g_play.scheduled_ns;
+    latency_record(LAT_TAS_FRAME, late);
+    g_play.frames_played++;
+    if (late > g_play.max_late_ns) g_play.max_late_ns = late;
+    
+    int ret = tas_reader_next(&g_play.reader, &g_play.next);
+    if (ret == 1) {
+        play_schedule();
+        return;
+    }
+    
+    if (ret < 0) printf("[TAS] Log corrupt at frame %llu\n",
+                        (unsigned long long)g_play.reader.frame);
+    printf("[TAS] Playback finished (%llu frames) - live input restored\n",
+           (unsigned long long)g_play.frames_played);
+    g_play.state = TAS_PLAY_DONE;
+}
+
+int tas_play_attach(reactor_t* r, const tas_play_hooks_t* hooks) {
+    if (g_play.state != TAS_PLAY_WAITING) return 0;
+    
+    g_play.hooks = *hooks;
+    g_play.timer_fd = reactor_timer_create();
+    if (g_play.timer_fd < 0 ||
+        reactor_add(r, g_play.timer_fd, EPOLLIN, tas_play_handler, NULL) < 0) {
+        return -1;
+    }
+    
+    return reactor_timer_set(g_play.timer_fd, time_now_ns(), TIME_MS(TAS_PLAY_WAIT_POLL_MS));
+}
+
+int tas_playing(void) {
+    return g_play.state == TAS_PLAY_WAITING || g_play.state == TAS_PLAY_RUNNING;
+}
+
+void tas_dump(void) {
+    if (g_rec.active) {
+        printf("=== TAS Recording ===\n");
+        printf("  Frames:  %llu (%llu dropped)\n",
+               (unsigned long long)__atomic_load_n(&g_rec.frames, __ATOMIC_RELAXED),
+               (unsigned long long)__atomic_load_n(&g_rec.dropped, __ATOMIC_RELAXED));
+        printf("  Written: %llu bytes\n", (unsigned long long)g_rec.spool.bytes_written);
+        printf("=====================\n\n");
+    }
+    if (g_play.state != TAS_PLAY_OFF) {
+        printf("=== TAS Playback ===\n");
+        printf("  Frames:   %llu of %llu (from %llu)\n",
+               (unsigned long long)g_play.frames_played,
+               (unsigned long long)g_play.reader.frame_count,
+               (unsigned long long)g_play.start_frame);
+        printf("  Max late: %.1f us (\"tas frame\" histogram)\n", g_play.max_late_ns / 1000.0);
+        printf("====================\n\n");
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,32 @@
+/*
+ * RosettaPad - Timebase
+ * ======================
+ * 
+ * Absolute-deadline sleeping and periodic deadline bookkeeping.
+ */
+
+#include <errno.h>
+
+#include "core/timebase.h"
+
+void time_sleep_until(uint64_t deadline_ns) {
+    struct timespec ts = time_ns_to_timespec(deadline_ns);
+    
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        /* Absolute deadline - just retry after a signal */
+    }
+}
+
+uint32_t time_deadline_advance(uint64_t* deadline_ns, uint64_t period_ns) {
+    if (period_ns == 0) return 0;
+    
+    *deadline_ns += period_ns;
+    
+    uint64_t now = time_now_ns();
+    if (now < *deadline_ns) return 0;
+    
+    /* Fell behind - skip whole periods but keep the original phase */
+    uint64_t behind = (now - *deadline_ns) / period_ns + 1;
+    *deadline_ns += behind * period_ns;
+    return (uint32_t)behind;
+}
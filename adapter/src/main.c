@@ -2,7 +2,7 @@
  * RosettaPad - Universal Controller Adapter
  * ==========================================
  * 
- * Main entry point - thread orchestration and lifecycle management.
+ * Main entry point - event loop / thread orchestration and lifecycle management.
  * 
  * ARCHITECTURE:
  * 
@@ -25,7 +25,7 @@
  * ADDING A NEW CONSOLE:
  * 1. Create console emulation in src/console/your_console/
  * 2. Implement translation from controller_state_t
- * 3. Add threads to main.c
+ * 3. Attach its descriptors to the control loop in main.c
  */
 
 #include <stdio.h>
@@ -35,9 +35,24 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <errno.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <sys/signalfd.h>
 
 #include "core/common.h"
+#include "core/reactor.h"
+#include "core/rt.h"
+#include "core/latency.h"
+#include "core/input_timing.h"
+#include "core/motion.h"
+#include "core/remap.h"
+#include "core/macro.h"
+#include "core/tas.h"
+#include "core/capture.h"
+#include "core/live.h"
+#include "core/control_socket.h"
 #include "controllers/controller_interface.h"
+#include "controllers/hotplug.h"
 #include "controllers/dualsense/dualsense.h"
 #include "console/ps3/ds3_emulation.h"
 #include "console/ps3/usb_gadget.h"
@@ -52,6 +67,8 @@ extern void controller_registry_init(void);
 extern void controller_drivers_init(void);
 extern void controller_drivers_shutdown(void);
 extern int controller_scan_devices(const controller_driver_t** out_driver);
+extern int controller_open_device(const char* devnode, uint16_t vid, uint16_t pid,
+                                  const controller_driver_t** out_driver);
 extern void controller_registry_print(void);
 extern void controller_set_active_driver(const controller_driver_t* driver);
 
@@ -59,16 +76,6 @@ extern void controller_set_active_driver(const controller_driver_t* driver);
 extern void controller_set_active(int fd, const controller_driver_t* driver);
 extern void controller_clear_active(void);
 
-/* ============================================================================
- * SIGNAL HANDLER
- * ============================================================================ */
-
-static void signal_handler(int sig) {
-    (void)sig;
-    printf("\n[Main] Shutdown requested...\n");
-    g_running = 0;
-}
-
 /* ============================================================================
  * BANNER
  * ============================================================================ */
@@ -89,138 +96,533 @@ static void print_banner(void) {
 /* ============================================================================
  * CONTROLLER INPUT THREAD
  * 
- * Generic controller polling - finds controller, reads input, updates state.
+ * Generic controller input - finds controller, reads input, updates state.
  * Works with any registered controller driver.
+ * 
+ * Runs its own event loop so nothing else can delay a report: the hidraw
+ * fd while connected, plus the hotplug socket. A device scan only runs at
+ * startup and after a disconnect (or every second if hotplug is
+ * unavailable); new controllers arrive as hotplug events.
  * ============================================================================ */
 
 static int g_controller_fd = -1;
 static const controller_driver_t* g_active_driver = NULL;
 
+static reactor_t g_input_loop;
+static int g_scan_timer_fd = -1;
+static int g_hotplug_fd = -1;
+
+/* Without hotplug, rescan for a controller this often while disconnected */
+#define CONTROLLER_SCAN_INTERVAL_MS 1000
+
 /* Wake button debouncing */
-static uint64_t g_last_home_press_time = 0;
+static uint64_t g_last_home_press_time = 0;  /* Coarse monotonic ns */
 #define HOME_BUTTON_DEBOUNCE_MS 500
 
-void* controller_input_thread(void* arg) {
-    (void)arg;
-    printf("[Input] Controller input thread started\n");
+static void controller_read_handler(int fd, uint32_t events, void* ctx);
+
+/* Hand a state to the console layers (controller reports, macro steps
+ * and TAS frames) */
+static void input_publish(controller_state_t* state) {
+    state->publish_time_ns = time_now_ns();
+    controller_state_update(state);
+    tas_record(state);
+    
+    /* Run-to-completion: translate and send in this same wakeup */
+    if (g_input_path_mode == INPUT_PATH_RUN_TO_COMPLETION) {
+        ps3_usb_send_input(state);
+    }
+}
+
+static void controller_disconnect(void) {
+    printf("[Input] Controller disconnected\n");
+    if (g_active_driver && g_active_driver->on_disconnect) {
+        g_active_driver->on_disconnect();
+    }
+    reactor_del(&g_input_loop, g_controller_fd);
+    close(g_controller_fd);
+    g_controller_fd = -1;
+    controller_clear_active();
+    input_timing_reset();
+    motion_reset();
+    macro_cancel();
+    controller_set_active_driver(NULL);
+    g_active_driver = NULL;
+    
+    if (g_hotplug_fd >= 0) {
+        /* Another controller may already be plugged in: one scan */
+        reactor_timer_set(g_scan_timer_fd, time_now_ns(), 0);
+    } else {
+        /* Back to scanning */
+        reactor_timer_set(g_scan_timer_fd, time_deadline_in(TIME_MS(CONTROLLER_SCAN_INTERVAL_MS)),
+                          TIME_MS(CONTROLLER_SCAN_INTERVAL_MS));
+    }
+}
+
+/* Start reading a freshly opened controller */
+static int controller_connect(int fd, const controller_driver_t* driver) {
+    printf("[Input] Controller connected: %s\n", driver->info->name);
     
-    uint8_t buf[128];
-    controller_state_t state;
-    int prev_home_pressed = 0;
+    /* Readiness comes from epoll - never block in read() */
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
     
-    while (g_running) {
-        /* Find controller if not connected */
-        while (g_running && g_controller_fd < 0) {
-            g_controller_fd = controller_scan_devices(&g_active_driver);
-            
-            if (g_controller_fd >= 0 && g_active_driver) {
-                printf("[Input] Controller connected: %s\n", g_active_driver->info->name);
-                controller_set_active(g_controller_fd, g_active_driver);
-                controller_set_active_driver(g_active_driver);
-            } else {
-                sleep(1);
-            }
-        }
-        
-        if (g_controller_fd < 0) break;
-        
-        /* Read input */
-        ssize_t n = read(g_controller_fd, buf, sizeof(buf));
-        
-        if (n < 0) {
-            if (errno == EAGAIN) {
-                usleep(1000);
-                continue;
-            }
-            
-            /* Disconnected */
-            printf("[Input] Controller disconnected\n");
-            if (g_active_driver && g_active_driver->on_disconnect) {
-                g_active_driver->on_disconnect();
-            }
-            close(g_controller_fd);
-            g_controller_fd = -1;
-            controller_clear_active();
-            controller_set_active_driver(NULL);
-            g_active_driver = NULL;
-            continue;
-        }
-        
-        if (n == 0) {
-            usleep(1000);
+    if (reactor_add(&g_input_loop, fd, EPOLLIN, controller_read_handler, NULL) < 0) {
+        close(fd);
+        return -1;
+    }
+    
+    g_controller_fd = fd;
+    g_active_driver = driver;
+    controller_set_active(g_controller_fd, g_active_driver);
+    controller_set_active_driver(g_active_driver);
+    reactor_timer_set(g_scan_timer_fd, 0, 0);
+    return 0;
+}
+
+static void controller_scan_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    if (reactor_timer_read(fd) == 0 || g_controller_fd >= 0) return;
+    
+    const controller_driver_t* driver = NULL;
+    int dev_fd = controller_scan_devices(&driver);
+    if (dev_fd >= 0 && driver) {
+        controller_connect(dev_fd, driver);
+    }
+}
+
+/* A hidraw node appeared: open it right away if a driver claims its IDs.
+ * Removal needs no handling here - reads on the node fail and
+ * controller_read_handler disconnects. */
+static void hotplug_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    hotplug_event_t ev;
+    int rc;
+    while ((rc = hotplug_next(fd, &ev)) != 0) {
+        if (rc < 0) {
+            /* Events lost - a scan finds whatever we missed */
+            if (g_controller_fd < 0) reactor_timer_set(g_scan_timer_fd, time_now_ns(), 0);
             continue;
         }
+        if (ev.action != HOTPLUG_ADD || g_controller_fd >= 0 || ev.vendor_id == 0) continue;
         
-        /* Parse input */
-        if (!g_active_driver || !g_active_driver->process_input) {
-            continue;
-        }
+        const controller_driver_t* driver = NULL;
+        int dev_fd = controller_open_device(ev.devnode, ev.vendor_id, ev.product_id, &driver);
+        if (dev_fd < 0) continue;
         
-        if (g_active_driver->process_input(buf, n, &state) != 0) {
-            continue;
+        if (controller_connect(dev_fd, driver) == 0) {
+            printf("[Input] %s opened %.1f ms after its uevent\n", ev.devnode,
+                   (double)(time_now_ns() - ev.event_time_ns) / TIME_NS_PER_MS);
         }
+    }
+}
+
+static void controller_read_handler(int fd, uint32_t events, void* ctx) {
+    (void)ctx;
+    
+    static int prev_home_pressed = 0;
+    uint8_t buf[128];
+    controller_state_t state;
+    
+    /* Read input */
+    ssize_t n = read(fd, buf, sizeof(buf));
+    uint64_t rx_time = time_now_ns();
+    
+    if (n < 0 && errno == EAGAIN) return;
+    
+    if (n < 0 || (n == 0 && (events & (EPOLLERR | EPOLLHUP)))) {
+        /* Disconnected */
+        controller_disconnect();
+        return;
+    }
+    
+    if (n == 0) return;
+    
+    /* Parse input */
+    if (!g_active_driver || !g_active_driver->process_input) {
+        return;
+    }
+    
+    int ret = g_active_driver->process_input(buf, n, &state);
+    uint64_t parsed_time = time_now_ns();
+    
+    /* Raw report for offline replay (no-op without --capture). After
+     * process_input(), so calibration it loaded is recorded first. */
+    capture_report(buf, n, rx_time, g_active_driver->info->vendor_id,
+                   g_active_driver->info->product_id);
+    
+    if (ret != 0) {
+        return;
+    }
+    
+    latency_record(LAT_PARSE, parsed_time - rx_time);
+    state.rx_time_ns = rx_time;
+    
+    /* Device clock, jitter and drop accounting; feed the motion history */
+    input_timing_update(&state);
+    motion_push(&state);
+    
+    /* Handle standby mode - check for wake button with debouncing.
+     * Uses the physical buttons, so no profile can lock the wake out. */
+    if (system_is_standby()) {
+        int home_pressed = CONTROLLER_BTN_PRESSED(&state, BTN_HOME);
         
-        /* Handle standby mode - check for wake button with debouncing */
-        if (system_is_standby()) {
-            int home_pressed = CONTROLLER_BTN_PRESSED(&state, BTN_HOME);
+        /* Detect rising edge (button just pressed) with debounce */
+        if (home_pressed && !prev_home_pressed) {
+            uint64_t now = time_now_coarse_ns();
             
-            /* Detect rising edge (button just pressed) with debounce */
-            if (home_pressed && !prev_home_pressed) {
-                uint64_t now = time_get_ms();
-                
-                if (now - g_last_home_press_time >= HOME_BUTTON_DEBOUNCE_MS) {
-                    printf("[Input] Home button pressed - waking PS3\n");
-                    g_last_home_press_time = now;
-                    system_exit_standby();
-                } else {
-                    printf("[Input] Home button ignored (debounce)\n");
-                }
+            if (now - g_last_home_press_time >= TIME_MS(HOME_BUTTON_DEBOUNCE_MS)) {
+                printf("[Input] Home button pressed - waking PS3\n");
+                g_last_home_press_time = now;
+                system_exit_standby();
+            } else {
+                printf("[Input] Home button ignored (debounce)\n");
             }
-            
-            prev_home_pressed = home_pressed;
-            continue;
         }
         
-        /* Normal operation - update state */
-        prev_home_pressed = CONTROLLER_BTN_PRESSED(&state, BTN_HOME);
-        controller_state_update(&state);
+        prev_home_pressed = home_pressed;
+        return;
+    }
+    
+    /* Normal operation - update state */
+    prev_home_pressed = CONTROLLER_BTN_PRESSED(&state, BTN_HOME);
+    
+    /* Button / axis profile (no-op without --remap) */
+    remap_apply(&state);
+    
+    /* A TAS log owns the console until it finishes */
+    if (tas_playing()) {
+        return;
     }
     
+    /* Macro triggers and the step being played (no-op without --macros) */
+    macro_process(&state);
+    
+    input_publish(&state);
+    latency_record(LAT_PUBLISH, state.publish_time_ns - parsed_time);
+}
+
+/* TAS playback starts once the console is listening */
+static int tas_console_ready(void) {
+    return g_usb_enabled || ps3_bt_is_enabled();
+}
+
+static const tas_play_hooks_t g_tas_hooks = {
+    .publish = input_publish,
+    .console_ready = tas_console_ready,
+    .publish_slot = ps3_usb_publish_slot,
+};
+
+/* Console side of the live state export (sampled on the control loop) */
+static void live_sample_console(live_console_t* out) {
+    out->state = g_ps3_bt_ctx.state;
+    out->usb_enabled = g_usb_enabled;
+    out->packets_sent = g_ps3_bt_ctx.packets_sent;
+    out->packets_dropped = g_ps3_bt_ctx.packets_dropped;
+    out->reconnect_count = g_ps3_bt_ctx.reconnect_count;
+    out->connect_time_ns = g_ps3_bt_ctx.connect_time;
+    out->last_send_time_ns = g_ps3_bt_ctx.last_send_time;
+}
+
+static uint32_t live_sample_report(uint8_t* out, uint32_t max) {
+    if (max < DS3_INPUT_REPORT_SIZE) return 0;
+    ds3_copy_report(out);
+    return DS3_INPUT_REPORT_SIZE;
+}
+
+static const live_export_hooks_t g_live_hooks = {
+    .sample_console = live_sample_console,
+    .sample_report = live_sample_report,
+};
+
+void* controller_input_thread(void* arg) {
+    (void)arg;
+    printf("[Input] Controller input thread started\n");
+    rt_thread_enter(RT_THREAD_INPUT);
+    
+    if (reactor_init(&g_input_loop, "input") < 0) {
+        return NULL;
+    }
+    
+    g_scan_timer_fd = reactor_timer_create();
+    if (g_scan_timer_fd < 0 ||
+        reactor_add(&g_input_loop, g_scan_timer_fd, EPOLLIN, controller_scan_handler, NULL) < 0) {
+        reactor_close(&g_input_loop);
+        return NULL;
+    }
+    
+    if (macro_attach(&g_input_loop, input_publish) < 0) {
+        printf("[Input] Failed to set up macro playback\n");
+    }
+    
+    if (tas_play_attach(&g_input_loop, &g_tas_hooks) < 0) {
+        printf("[Input] Failed to set up TAS playback\n");
+    }
+    
+    g_hotplug_fd = hotplug_open();
+    if (g_hotplug_fd >= 0 &&
+        reactor_add(&g_input_loop, g_hotplug_fd, EPOLLIN, hotplug_handler, NULL) < 0) {
+        close(g_hotplug_fd);
+        g_hotplug_fd = -1;
+    }
+    if (g_hotplug_fd < 0) {
+        printf("[Input] Hotplug unavailable - scanning every %dms\n", CONTROLLER_SCAN_INTERVAL_MS);
+    }
+    
+    /* First scan right away; later ones only without hotplug */
+    reactor_timer_set(g_scan_timer_fd, time_now_ns(),
+                      g_hotplug_fd >= 0 ? 0 : TIME_MS(CONTROLLER_SCAN_INTERVAL_MS));
+    
+    reactor_run(&g_input_loop);
+    
     /* Cleanup */
-    if (g_controller_fd >= 0) {
-        close(g_controller_fd);
-        g_controller_fd = -1;
+    if (g_hotplug_fd >= 0) {
+        reactor_del(&g_input_loop, g_hotplug_fd);
+        close(g_hotplug_fd);
+        g_hotplug_fd = -1;
     }
+    reactor_del(&g_input_loop, g_scan_timer_fd);
+    close(g_scan_timer_fd);
+    g_scan_timer_fd = -1;
+    reactor_close(&g_input_loop);
     
     printf("[Input] Controller input thread exiting\n");
     return NULL;
 }
 
+/* ============================================================================
+ * SIGNALS
+ * 
+ * SIGINT/SIGTERM/SIGUSR1/SIGHUP are blocked in every thread and delivered through
+ * a signalfd on the control loop, so handling them is ordinary code.
+ * ============================================================================ */
+
+static int g_signal_fd = -1;
+
+static void signal_fd_handler(int fd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    
+    struct signalfd_siginfo si;
+    if (read(fd, &si, sizeof(si)) != sizeof(si)) return;
+    
+    if (si.ssi_signo == SIGUSR1) {
+        latency_dump();
+        input_timing_dump();
+        ps3_usb_cadence_dump();
+        macro_dump();
+        tas_dump();
+        return;
+    }
+    
+    if (si.ssi_signo == SIGHUP) {
+        remap_reload();
+        return;
+    }
+    
+    printf("\n[Main] Shutdown requested...\n");
+    reactor_request_shutdown();
+}
+
+static int signals_init(void) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGUSR1);
+    sigaddset(&mask, SIGHUP);
+    
+    /* Block before any thread starts so every thread inherits the mask */
+    if (pthread_sigmask(SIG_BLOCK, &mask, NULL) != 0) {
+        perror("[Main] pthread_sigmask");
+        return -1;
+    }
+    
+    g_signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (g_signal_fd < 0) {
+        perror("[Main] signalfd");
+        return -1;
+    }
+    
+    return 0;
+}
+
+/* ============================================================================
+ * COMMAND LINE
+ * ============================================================================ */
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --input-mode=MODE   decoupled (default) or rtc (run-to-completion)\n");
+    printf("  --usb-io=MODE       aio (default) or sync USB endpoint I/O\n");
+    printf("  --rt                Real-time profile for the input path (SCHED_FIFO,\n");
+    printf("                      CPU pinning, mlockall)\n");
+    printf("  --rt-priority=N     SCHED_FIFO priority of the input thread (default %d)\n",
+           RT_DEFAULT_PRIORITY);
+    printf("  --rt-cpu=N|none     Core for the input path (default: last CPU)\n");
+    printf("  --no-mlock          Don't lock memory in the real-time profile\n");
+    printf("  --remap=FILE        Button/axis remapping profile (see core/remap.h)\n");
+    printf("  --macros=FILE       Macro definitions (see core/macro.h)\n");
+    printf("  --tas-record=FILE   Record published input to a TAS log\n");
+    printf("  --tas-play=FILE     Play a TAS log once a console connects\n");
+    printf("  --tas-start=N       First frame to play (default 0)\n");
+    printf("  --capture=FILE      Capture raw controller reports for tools/replay\n");
+    printf("  --no-live-export    Don't publish live state in %s\n", LIVE_EXPORT_PATH);
+    printf("  -h, --help          Show this help\n");
+    printf("\nSend SIGUSR1 to print input latency histograms.\n");
+    printf("Send SIGHUP to reload the remapping profile.\n");
+}
+
+static const char* g_tas_record_path = NULL;
+static const char* g_tas_play_path = NULL;
+static uint64_t g_tas_start_frame = 0;
+static int g_live_export = 1;
+
+static int parse_args(int argc, char* argv[]) {
+    static const struct option long_opts[] = {
+        {"input-mode",  required_argument, NULL, 'm'},
+        {"usb-io",      required_argument, NULL, 'u'},
+        {"rt",          no_argument,       NULL, 'r'},
+        {"rt-priority", required_argument, NULL, 'p'},
+        {"rt-cpu",      required_argument, NULL, 'c'},
+        {"no-mlock",    no_argument,       NULL, 'L'},
+        {"remap",       required_argument, NULL, 'M'},
+        {"macros",      required_argument, NULL, 'X'},
+        {"tas-record",  required_argument, NULL, 'T'},
+        {"tas-play",    required_argument, NULL, 'P'},
+        {"tas-start",   required_argument, NULL, 'S'},
+        {"capture",     required_argument, NULL, 'C'},
+        {"no-live-export", no_argument,    NULL, 'E'},
+        {"help",        no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                if (strcmp(optarg, "decoupled") == 0) {
+                    g_input_path_mode = INPUT_PATH_DECOUPLED;
+                } else if (strcmp(optarg, "rtc") == 0 ||
+                           strcmp(optarg, "run-to-completion") == 0) {
+                    g_input_path_mode = INPUT_PATH_RUN_TO_COMPLETION;
+                } else {
+                    fprintf(stderr, "[Main] Unknown input mode: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'u':
+                if (strcmp(optarg, "aio") == 0) {
+                    g_usb_io_mode = USB_IO_AIO;
+                } else if (strcmp(optarg, "sync") == 0) {
+                    g_usb_io_mode = USB_IO_SYNC;
+                } else {
+                    fprintf(stderr, "[Main] Unknown USB I/O mode: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'r':
+                g_rt_profile.enabled = 1;
+                break;
+            case 'p':
+                g_rt_profile.priority = atoi(optarg);
+                if (g_rt_profile.priority < 1 || g_rt_profile.priority > 99) {
+                    fprintf(stderr, "[Main] RT priority must be 1-99\n");
+                    return -1;
+                }
+                break;
+            case 'c':
+                if (strcmp(optarg, "none") == 0) {
+                    g_rt_profile.cpu = RT_CPU_NONE;
+                } else {
+                    g_rt_profile.cpu = atoi(optarg);
+                    if (g_rt_profile.cpu < 0) {
+                        fprintf(stderr, "[Main] Invalid CPU: %s\n", optarg);
+                        return -1;
+                    }
+                }
+                break;
+            case 'L':
+                g_rt_profile.lock_memory = 0;
+                break;
+            case 'M':
+                if (remap_load(optarg) < 0) {
+                    return -1;
+                }
+                break;
+            case 'X':
+                if (macro_load(optarg) < 0) {
+                    return -1;
+                }
+                break;
+            case 'T':
+                g_tas_record_path = optarg;
+                break;
+            case 'P':
+                g_tas_play_path = optarg;
+                break;
+            case 'S':
+                g_tas_start_frame = strtoull(optarg, NULL, 10);
+                break;
+            case 'C':
+                if (capture_open(optarg) < 0) {
+                    return -1;
+                }
+                break;
+            case 'E':
+                g_live_export = 0;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                exit(0);
+            default:
+                print_usage(argv[0]);
+                return -1;
+        }
+    }
+    
+    if (g_tas_record_path && g_tas_play_path) {
+        fprintf(stderr, "[Main] --tas-record and --tas-play are exclusive\n");
+        return -1;
+    }
+    if (g_tas_record_path && tas_record_open(g_tas_record_path) < 0) {
+        return -1;
+    }
+    if (g_tas_play_path && tas_play_open(g_tas_play_path, g_tas_start_frame) < 0) {
+        return -1;
+    }
+    
+    return 0;
+}
+
 /* ============================================================================
  * MAIN
  * ============================================================================ */
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    if (parse_args(argc, argv) < 0) {
+        return 1;
+    }
     
     pthread_t input_tid;
-    pthread_t output_tid;
-    pthread_t usb_ctrl_tid;
     pthread_t usb_in_tid;
     pthread_t usb_out_tid;
-    pthread_t bt_tid;
-    pthread_t bt_motion_tid;
+    reactor_t control_loop;
     
     print_banner();
     
-    /* Setup signal handlers */
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    /* Signals are handled on the control loop */
+    if (signals_init() < 0) {
+        return 1;
+    }
     
     /* Create IPC directory */
     system("mkdir -p /tmp/rosettapad");
     
+    /* Live state for the web panel - nice to have, never fatal */
+    if (g_live_export && live_export_open(LIVE_EXPORT_PATH) < 0) {
+        printf("[Main] Warning: live state export disabled\n");
+    }
+    
     /* ========== INITIALIZATION ========== */
     
     printf("[Main] Initializing modules...\n");
@@ -244,6 +646,21 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    /* Endpoint I/O backend */
+    if (g_usb_io_mode == USB_IO_AIO && ps3_usb_aio_init() < 0) {
+        printf("[Main] Warning: USB AIO unavailable - using blocking endpoint I/O\n");
+        g_usb_io_mode = USB_IO_SYNC;
+    }
+    printf("[Main] USB endpoint I/O: %s\n", usb_io_mode_str(g_usb_io_mode));
+    
+    /* A blocking ep1 write() would hold the input thread until the host
+     * polls, on every report */
+    if (g_input_path_mode == INPUT_PATH_RUN_TO_COMPLETION && g_usb_io_mode == USB_IO_SYNC) {
+        printf("[Main] Warning: run-to-completion needs USB AIO - using the decoupled path\n");
+        g_input_path_mode = INPUT_PATH_DECOUPLED;
+    }
+    printf("[Main] Input path: %s\n", input_path_mode_str(g_input_path_mode));
+    
     /* Open ep0 and write descriptors */
     g_ep0_fd = ps3_usb_open_endpoint(0);
     if (g_ep0_fd < 0) {
@@ -257,22 +674,61 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    /* ========== CONTROL LOOP ========== */
+    
+    if (reactor_init(&control_loop, "control") < 0) {
+        return 1;
+    }
+    
+    reactor_add(&control_loop, g_signal_fd, EPOLLIN, signal_fd_handler, NULL);
+    
+    if (controller_output_attach(&control_loop) < 0) {
+        fprintf(stderr, "[Main] Failed to set up controller output\n");
+        return 1;
+    }
+    
+    if (ps3_usb_attach(&control_loop) < 0) {
+        fprintf(stderr, "[Main] Failed to attach USB control endpoint\n");
+        return 1;
+    }
+    
+    if (ps3_bt_attach(&control_loop) < 0) {
+        printf("[Main] Warning: Bluetooth event setup failed\n");
+    }
+    
+    if (tas_record_attach(&control_loop) < 0) {
+        fprintf(stderr, "[Main] Failed to set up TAS recording\n");
+        return 1;
+    }
+    
+    if (capture_attach(&control_loop) < 0) {
+        fprintf(stderr, "[Main] Failed to set up input capture\n");
+        return 1;
+    }
+    
+    if (live_export_attach(&control_loop, &g_live_hooks) < 0) {
+        printf("[Main] Warning: live state export timer failed\n");
+    }
+    
+    if (ctl_attach(&control_loop, CTL_SOCKET_PATH, &g_live_hooks) < 0) {
+        printf("[Main] Warning: control socket unavailable\n");
+    }
+    
+    /* Real-time profile - before any thread exists */
+    rt_init();
+    
     /* ========== START THREADS ========== */
     
     printf("[Main] Starting threads...\n");
     
-    /* Controller threads */
+    /* Controller input loop */
     pthread_create(&input_tid, NULL, controller_input_thread, NULL);
-    pthread_create(&output_tid, NULL, controller_output_thread, NULL);
     
-    /* PS3 USB threads */
-    pthread_create(&usb_ctrl_tid, NULL, ps3_usb_control_thread, NULL);
+    /* PS3 USB data endpoints (not pollable - AIO or blocking I/O) */
     pthread_create(&usb_in_tid, NULL, ps3_usb_input_thread, NULL);
-    pthread_create(&usb_out_tid, NULL, ps3_usb_output_thread, NULL);
-    
-    /* PS3 Bluetooth threads */
-    pthread_create(&bt_tid, NULL, ps3_bt_thread, NULL);
-    pthread_create(&bt_motion_tid, NULL, ps3_bt_motion_thread, NULL);
+    if (g_usb_io_mode == USB_IO_SYNC) {
+        pthread_create(&usb_out_tid, NULL, ps3_usb_output_thread, NULL);
+    }
     
     /* Bind USB gadget */
     printf("[Main] Binding USB gadget...\n");
@@ -292,10 +748,8 @@ int main(int argc, char* argv[]) {
     printf("\n");
     fflush(stdout);
     
-    /* Main loop - just wait for shutdown */
-    while (g_running) {
-        sleep(1);
-    }
+    /* Control loop - USB control, Bluetooth, controller output, signals */
+    reactor_run(&control_loop);
     
     /* ========== SHUTDOWN ========== */
     
@@ -312,8 +766,14 @@ int main(int argc, char* argv[]) {
     /* Unbind USB gadget */
     ps3_usb_unbind();
     
-    /* Wait for threads */
+    /* Wait for threads (ep1/ep2 may stay blocked in FunctionFS) */
+    pthread_join(input_tid, NULL);
+    tas_record_close();
+    capture_close();
+    live_export_close();
+    ctl_close();
     sleep(1);
+    reactor_close(&control_loop);
     
     /* Cleanup drivers */
     controller_drivers_shutdown();
@@ -0,0 +1,283 @@
+/*
+ * RosettaPad - Control Client
+ * ============================
+ *
+ * Sends commands to a running adapter over the control socket
+ * (core/control_socket.h). All commands on one command line go out as a
+ * single batch, so they are applied together or not at all:
+ *
+ *   ctl set deadzone=10 set touchpad_stick=0
+ *   ctl get bt_interval_ms
+ *   ctl remap /etc/rosettapad/fighting.remap      (or "remap none")
+ *   ctl lightbar 0,64,255  rumble 0,0
+ *   ctl stats latency
+ *
+ * Build and run:
+ *   make tools
+ *   ./build/tools/ctl [--socket=PATH] COMMAND...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "core/common.h"
+#include "core/config.h"
+#include "core/control_socket.h"
+#include "core/latency.h"
+
+typedef struct {
+    uint8_t buf[CTL_MAX_PACKET];
+    size_t len;
+    int count;
+} batch_t;
+
+static int batch_add(batch_t* b, uint8_t op, uint16_t arg, const void* payload, size_t len) {
+    if (b->count == 255 || len > 255 || b->len + sizeof(ctl_cmd_t) + len > sizeof(b->buf)) {
+        fprintf(stderr, "Too many commands for one batch\n");
+        return -1;
+    }
+    ctl_cmd_t cmd = { .op = op, .len = (uint8_t)len, .arg = arg };
+    memcpy(b->buf + b->len, &cmd, sizeof(cmd));
+    if (len) memcpy(b->buf + b->len + sizeof(cmd), payload, len);
+    b->len += sizeof(cmd) + len;
+    b->count++;
+    return 0;
+}
+
+static int add_option(batch_t* b, const char* name, int set) {
+    char key[64];
+    const char* eq = strchr(name, '=');
+    size_t key_len = set && eq ? (size_t)(eq - name) : strlen(name);
+    if (key_len >= sizeof(key) || (set && !eq)) {
+        fprintf(stderr, "Expected %s\n", set ? "NAME=VALUE" : "NAME");
+        return -1;
+    }
+    memcpy(key, name, key_len);
+    key[key_len] = '\0';
+    
+    int option = config_option_by_name(key);
+    if (option < 0) {
+        fprintf(stderr, "Unknown option: %s\n", key);
+        return -1;
+    }
+    if (!set) return batch_add(b, CTL_OP_GET_OPTION, option, NULL, 0);
+    
+    int32_t value = atoi(eq + 1);
+    return batch_add(b, CTL_OP_SET_OPTION, option, &value, sizeof(value));
+}
+
+static int add_output(batch_t* b, uint16_t field, const char* values) {
+    ctl_output_t o;
+    unsigned v[3] = { 0, 0, 0 };
+    int want = field == CTL_OUT_LIGHTBAR ? 3 : 2;
+    if (sscanf(values, "%u,%u,%u", &v[0], &v[1], &v[2]) != want) {
+        fprintf(stderr, "Expected %s\n", want == 3 ? "R,G,B" : "LEFT,RIGHT");
+        return -1;
+    }
+    memset(&o, 0, sizeof(o));
+    if (field == CTL_OUT_LIGHTBAR) {
+        o.led_r = v[0];
+        o.led_g = v[1];
+        o.led_b = v[2];
+    } else {
+        o.rumble_left = v[0];
+        o.rumble_right = v[1];
+    }
+    return batch_add(b, CTL_OP_SET_OUTPUT, field, &o, sizeof(o));
+}
+
+/* The adapter has its own working directory, so send an absolute path */
+static int add_remap(batch_t* b, const char* arg) {
+    char path[PATH_MAX];
+    if (strcmp(arg, "none") == 0) return batch_add(b, CTL_OP_LOAD_REMAP, 0, NULL, 0);
+    
+    if (!realpath(arg, path)) {
+        fprintf(stderr, "%s: %s\n", arg, strerror(errno));
+        return -1;
+    }
+    return batch_add(b, CTL_OP_LOAD_REMAP, 0, path, strlen(path));
+}
+
+static int build_batch(batch_t* b, int argc, char* argv[]) {
+    for (int i = 0; i < argc; i++) {
+        const char* cmd = argv[i];
+        const char* arg = i + 1 < argc ? argv[i + 1] : NULL;
+        int rc;
+        
+        if (strcmp(cmd, "ping") == 0) {
+            rc = batch_add(b, CTL_OP_PING, 0, "ping", 4);
+        } else if (strcmp(cmd, "stats") == 0) {
+            rc = batch_add(b, CTL_OP_GET_STATS, 0, NULL, 0);
+        } else if (strcmp(cmd, "latency") == 0) {
+            rc = 0;
+            for (int s = 0; s < LAT_STAGE_COUNT && rc == 0; s++) {
+                rc = batch_add(b, CTL_OP_GET_LATENCY, s, NULL, 0);
+            }
+        } else if (!arg) {
+            fprintf(stderr, "Missing argument for %s\n", cmd);
+            return -1;
+        } else {
+            i++;
+            if (strcmp(cmd, "get") == 0) {
+                rc = add_option(b, arg, 0);
+            } else if (strcmp(cmd, "set") == 0) {
+                rc = add_option(b, arg, 1);
+            } else if (strcmp(cmd, "remap") == 0) {
+                rc = add_remap(b, arg);
+            } else if (strcmp(cmd, "lightbar") == 0) {
+                rc = add_output(b, CTL_OUT_LIGHTBAR, arg);
+            } else if (strcmp(cmd, "rumble") == 0) {
+                rc = add_output(b, CTL_OUT_RUMBLE, arg);
+            } else {
+                fprintf(stderr, "Unknown command: %s\n", cmd);
+                return -1;
+            }
+        }
+        if (rc < 0) return -1;
+    }
+    return 0;
+}
+
+static const char* status_str(int status) {
+    switch (status) {
+        case CTL_OK:        return "ok";
+        case CTL_EBADOP:    return "bad command";
+        case CTL_EINVAL:    return "invalid value";
+        case CTL_ELOAD:     return "load failed (see adapter log)";
+        case CTL_EABORTED:  return "not applied";
+        default:            return "error";
+    }
+}
+
+/* Print the replies, in request order. @return number of failed commands */
+static int print_replies(const batch_t* req, const uint8_t* buf, size_t len) {
+    size_t req_pos = sizeof(ctl_batch_t), pos = sizeof(ctl_batch_t);
+    int failed = 0;
+    
+    for (int i = 0; i < req->count && pos + sizeof(ctl_reply_t) <= len; i++) {
+        ctl_cmd_t cmd;
+        ctl_reply_t r;
+        memcpy(&cmd, req->buf + req_pos, sizeof(cmd));
+        memcpy(&r, buf + pos, sizeof(r));
+        req_pos += sizeof(cmd) + cmd.len;
+        pos += sizeof(r);
+        const uint8_t* p = buf + pos;
+        pos += r.len;
+        
+        if (r.status != CTL_OK) {
+            printf("%-20s %s\n", cmd.op == CTL_OP_SET_OPTION || cmd.op == CTL_OP_GET_OPTION ?
+                   config_option_name(cmd.arg) : "command", status_str(r.status));
+            failed++;
+            continue;
+        }
+        
+        switch (r.op) {
+            case CTL_OP_GET_OPTION: {
+                int32_t v;
+                memcpy(&v, p, sizeof(v));
+                printf("%-20s %d\n", config_option_name(cmd.arg), v);
+                break;
+            }
+            case CTL_OP_GET_STATS: {
+                ctl_stats_t s;
+                memcpy(&s, p, sizeof(s));
+                printf("system state         %u\n", s.system_state);
+                printf("controller           %s\n", s.controller_connected ? "connected" : "none");
+                printf("usb                  %s\n", s.console.usb_enabled ? "enabled" : "off");
+                printf("bt state             %u (sent %u, dropped %u, reconnects %u)\n",
+                       s.console.state, s.console.packets_sent, s.console.packets_dropped,
+                       s.console.reconnect_count);
+                printf("control batches      %llu (%llu commands, %llu rejected)\n",
+                       (unsigned long long)s.batches, (unsigned long long)s.commands,
+                       (unsigned long long)s.rejected);
+                break;
+            }
+            case CTL_OP_GET_LATENCY: {
+                ctl_latency_t l;
+                memcpy(&l, p, sizeof(l));
+                printf("%-20s p50 %8.1f us  p90 %8.1f us  p99 %8.1f us\n",
+                       latency_stage_str(cmd.arg), l.p50_ns / 1000.0, l.p90_ns / 1000.0,
+                       l.p99_ns / 1000.0);
+                break;
+            }
+            case CTL_OP_PING:
+                printf("pong\n");
+                break;
+            default:
+                printf("%-20s ok\n", cmd.op == CTL_OP_SET_OPTION ? config_option_name(cmd.arg) :
+                       cmd.op == CTL_OP_LOAD_REMAP ? "remap" : "output");
+                break;
+        }
+    }
+    return failed;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [--socket=PATH] COMMAND...\n", prog);
+    printf("Commands (all sent as one batch, applied together):\n");
+    printf("  get NAME          Read an option\n");
+    printf("  set NAME=VALUE    Change an option\n");
+    printf("  remap FILE|none   Load a remap profile, or disable remapping\n");
+    printf("  lightbar R,G,B    Set the lightbar color\n");
+    printf("  rumble L,R        Set the rumble motors\n");
+    printf("  stats             Connection and control socket stats\n");
+    printf("  latency           Per-stage latency percentiles\n");
+    printf("  ping\n");
+    printf("Options:");
+    for (int i = 1; i < CONFIG_OPTION_COUNT; i++) printf(" %s", config_option_name(i));
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    static const struct option long_opts[] = {
+        {"socket", required_argument, NULL, 's'},
+        {"help",   no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    const char* path = CTL_SOCKET_PATH;
+    int opt;
+    
+    while ((opt = getopt_long(argc, argv, "+h", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'h': print_usage(argv[0]); return 0;
+            default:  print_usage(argv[0]); return 1;
+        }
+    }
+    if (optind == argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    batch_t req = { .len = sizeof(ctl_batch_t) };
+    if (build_batch(&req, argc - optind, argv + optind) < 0) return 1;
+    ctl_batch_t header = { .version = CTL_VERSION, .count = (uint8_t)req.count, .tag = 1 };
+    memcpy(req.buf, &header, sizeof(header));
+    
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("[Ctl] connect (is rosettapad running?)");
+        return 1;
+    }
+    
+    uint8_t reply[CTL_MAX_PACKET];
+    ssize_t n;
+    if (send(fd, req.buf, req.len, 0) != (ssize_t)req.len ||
+        (n = recv(fd, reply, sizeof(reply), 0)) < (ssize_t)sizeof(ctl_batch_t)) {
+        perror("[Ctl] request");
+        close(fd);
+        return 1;
+    }
+    close(fd);
+    
+    return print_replies(&req, reply, (size_t)n) ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * RosettaPad - Live State Viewer
+ * ===============================
+ *
+ * Reads the live state segment a running adapter exports (core/live.h)
+ * and prints it, either once or continuously. Also a reference reader for
+ * other tools: map the file read-only and use live_snapshot_read().
+ *
+ * Build and run:
+ *   make tools
+ *   ./build/tools/live [--watch[=HZ]] [--path=FILE]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "core/common.h"
+#include "core/live.h"
+
+static const char* system_state_str(uint32_t state) {
+    switch (state) {
+        case SYSTEM_STATE_ACTIVE:   return "active";
+        case SYSTEM_STATE_STANDBY:  return "standby";
+        case SYSTEM_STATE_WAKING:   return "waking";
+        default:                    return "unknown";
+    }
+}
+
+static void print_snapshot(const live_snapshot_t* s, uint32_t seq) {
+    const controller_state_t* c = &s->controller;
+    uint64_t now = time_now_ns();
+    
+    printf("seq %u  age %.1f ms  system %s  controller %s\n", seq,
+           s->update_time_ns ? (double)(now - s->update_time_ns) / TIME_NS_PER_MS : 0.0,
+           system_state_str(s->system_state), s->controller_connected ? "connected" : "none");
+    printf("  buttons %08x  L %3u,%3u  R %3u,%3u  L2 %3u  R2 %3u\n",
+           c->buttons, c->left_stick_x, c->left_stick_y, c->right_stick_x, c->right_stick_y,
+           c->left_trigger, c->right_trigger);
+    printf("  accel %6d %6d %6d  gyro %6d %6d %6d  battery %u%%\n",
+           c->accel_x, c->accel_y, c->accel_z, c->gyro_x, c->gyro_y, c->gyro_z,
+           c->battery_level);
+    printf("  console: bt state %u  usb %s  sent %u  dropped %u  reconnects %u\n",
+           s->console.state, s->console.usb_enabled ? "enabled" : "off",
+           s->console.packets_sent, s->console.packets_dropped, s->console.reconnect_count);
+    printf("  report:");
+    for (uint32_t i = 0; i < s->report_len && i < LIVE_REPORT_MAX; i++) {
+        printf("%s%02x", (i % 25) == 0 && i ? "\n          " : " ", s->report[i]);
+    }
+    printf("\n");
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --watch[=HZ]  Keep printing new snapshots (default 10Hz)\n");
+    printf("  --path=FILE   Segment to read (default %s)\n", LIVE_EXPORT_PATH);
+    printf("  -h, --help    Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    static const struct option long_opts[] = {
+        {"watch", optional_argument, NULL, 'w'},
+        {"path",  required_argument, NULL, 'p'},
+        {"help",  no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    const char* path = LIVE_EXPORT_PATH;
+    int watch_hz = 0, opt;
+    
+    while ((opt = getopt_long(argc, argv, "h", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'w': watch_hz = optarg ? atoi(optarg) : 10; break;
+            case 'p': path = optarg; break;
+            case 'h': print_usage(argv[0]); return 0;
+            default:  print_usage(argv[0]); return 1;
+        }
+    }
+    if (optind != argc || watch_hz < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror("[Live] open (is rosettapad running?)");
+        return 1;
+    }
+    const live_shm_t* shm = mmap(NULL, sizeof(live_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        perror("[Live] mmap");
+        return 1;
+    }
+    
+    live_snapshot_t snap;
+    uint32_t seq, last_seq = 0;
+    if (live_snapshot_read(shm, &snap, &seq) < 0) {
+        printf("[Live] %s: adapter not running or built with a different layout\n", path);
+        return 1;
+    }
+    print_snapshot(&snap, seq);
+    
+    while (watch_hz > 0) {
+        last_seq = seq;
+        struct timespec ts = time_ns_to_timespec(TIME_NS_PER_SEC / watch_hz);
+        nanosleep(&ts, NULL);
+        
+        if (live_snapshot_read(shm, &snap, &seq) < 0) {
+            printf("[Live] Adapter exited\n");
+            break;
+        }
+        if (seq != last_seq) {
+            print_snapshot(&snap, seq);
+        }
+    }
+    
+    munmap((void*)shm, sizeof(live_shm_t));
+    return 0;
+}
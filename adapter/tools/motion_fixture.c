@@ -0,0 +1,173 @@
+/*
+ * RosettaPad - Motion Check Fixture
+ * ==================================
+ *
+ * Writes the synthetic DualSense capture behind `make motion-check`
+ * (tools/fixtures/motion_rest.cap), whose physical answers are known:
+ *
+ *   1. A factory calibration record (g_calibration).
+ *   2. FIXTURE_REST_FRAMES of the controller lying flat and still: accel
+ *      reads +1 g on the DualSense Y axis, and every gyro axis is off by
+ *      FIXTURE_GYRO_DRIFT raw counts on top of its factory bias.
+ *   3. FIXTURE_MOVE_FRAMES of a yaw swing, so the fixed-point check also
+ *      sees large rates.
+ *
+ * replay --motion --flat must then find accel at (0, 0, -1 g) and the
+ * drift gone from the gyro once the online bias has settled.
+ *
+ * The noise comes from a fixed xorshift seed, so rerunning this rewrites
+ * the committed fixture byte for byte.
+ *
+ * Build and run:
+ *   make tools
+ *   ./build/tools/motion_fixture tools/fixtures/motion_rest.cap
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "core/common.h"
+#include "core/capture.h"
+#include "core/crc32.h"
+#include "controllers/dualsense/dualsense.h"
+
+#define FIXTURE_INTERVAL_US     4000    /* 250Hz, as over Bluetooth */
+#define FIXTURE_REST_FRAMES     650     /* Rest detection + settling + measuring */
+#define FIXTURE_MOVE_FRAMES     100
+#define FIXTURE_GYRO_DRIFT      20      /* Raw counts, ~1.2 deg/s */
+#define FIXTURE_GYRO_NOISE      3       /* +- raw counts */
+#define FIXTURE_ACCEL_NOISE     20
+#define FIXTURE_YAW_SWING       3200    /* Peak raw yaw rate, ~200 deg/s */
+
+/* Feature report 0x05 fields, in report order (see dualsense_parse_calibration) */
+enum {
+    CAL_GYRO_BIAS = 0,          /* pitch, yaw, roll */
+    CAL_GYRO_PLUS = 3,
+    CAL_GYRO_MINUS = 6,
+    CAL_GYRO_SPEED = 9,         /* plus, minus */
+    CAL_ACCEL = 11,             /* x+, x-, y+, y-, z+, z- */
+    CAL_FIELDS = 17
+};
+
+static const int16_t g_calibration[CAL_FIELDS] = {
+    3, 2, 1,
+    8850, 8860, 8870,
+    -8800, -8810, -8790,
+    540, 540,
+    8200, -8150, 8230, -8170, 8190, -8180,
+};
+
+static uint32_t g_noise_state = 0x2545F491;
+
+/* Uniform in [-range, range] */
+static int noise(int range) {
+    g_noise_state ^= g_noise_state << 13;
+    g_noise_state ^= g_noise_state >> 17;
+    g_noise_state ^= g_noise_state << 5;
+    return (int)(g_noise_state % (uint32_t)(2 * range + 1)) - range;
+}
+
+static void put_le16(uint8_t* p, int v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static int write_record(FILE* f, uint8_t type, uint64_t time_ns, const uint8_t* buf, size_t len) {
+    capture_record_t rec = {
+        .rx_time_ns = time_ns,
+        .vendor_id = DUALSENSE_VID,
+        .product_id = DUALSENSE_PID,
+        .len = (uint16_t)len,
+        .type = type,
+    };
+    return fwrite(&rec, sizeof(rec), 1, f) == 1 && fwrite(buf, len, 1, f) == 1 ? 0 : -1;
+}
+
+/* Raw value of an axis at rest: the middle of its factory +-1 g range */
+static int accel_center(int axis) {
+    int plus = g_calibration[CAL_ACCEL + 2 * axis];
+    int minus = g_calibration[CAL_ACCEL + 2 * axis + 1];
+    return plus - (plus - minus) / 2;
+}
+
+static int write_fixture(FILE* f) {
+    capture_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    if (fwrite(&header, sizeof(header), 1, f) != 1) return -1;
+    
+    uint8_t calibration[DS_FEATURE_REPORT_CALIBRATION_SIZE + 1] = { DS_FEATURE_REPORT_CALIBRATION };
+    for (int i = 0; i < CAL_FIELDS; i++) {
+        put_le16(&calibration[1 + 2 * i], g_calibration[i]);
+    }
+    if (write_record(f, CAPTURE_RECORD_CALIBRATION, 0, calibration, sizeof(calibration)) < 0) {
+        return -1;
+    }
+    
+    uint8_t crc_header = DS_BT_INPUT_CRC_HEADER;
+    uint32_t crc_seed = crc32_compute(&crc_header, 1);
+    
+    for (int n = 0; n < FIXTURE_REST_FRAMES + FIXTURE_MOVE_FRAMES; n++) {
+        uint8_t report[DS_BT_INPUT_SIZE] = { DS_BT_REPORT_ID };
+        report[DS_OFF_LX] = report[DS_OFF_LY] = 128;
+        report[DS_OFF_RX] = report[DS_OFF_RY] = 128;
+        report[DS_OFF_SEQUENCE] = (uint8_t)n;
+        report[DS_OFF_BUTTONS1] = 0x08;             /* D-pad released */
+        report[DS_OFF_TOUCHPAD] = DS_TOUCH_INACTIVE;
+        report[DS_OFF_TOUCHPAD + 4] = DS_TOUCH_INACTIVE;
+        
+        /* Flat: DualSense Y is up */
+        for (int i = 0; i < 3; i++) {
+            int accel = i == 1 ? g_calibration[CAL_ACCEL + 2] : accel_center(i);
+            int gyro = g_calibration[CAL_GYRO_BIAS + i] + FIXTURE_GYRO_DRIFT;
+            put_le16(&report[DS_OFF_ACCEL_X + 2 * i], accel + noise(FIXTURE_ACCEL_NOISE));
+            put_le16(&report[DS_OFF_GYRO_X + 2 * i], gyro + noise(FIXTURE_GYRO_NOISE));
+        }
+        
+        /* Yaw swing: triangle wave, one period over the move */
+        if (n >= FIXTURE_REST_FRAMES) {
+            int phase = (n - FIXTURE_REST_FRAMES) * 4 * FIXTURE_YAW_SWING / FIXTURE_MOVE_FRAMES;
+            int rate = phase <= FIXTURE_YAW_SWING ? phase :
+                       phase <= 3 * FIXTURE_YAW_SWING ? 2 * FIXTURE_YAW_SWING - phase :
+                       phase - 4 * FIXTURE_YAW_SWING;
+            int yaw = g_calibration[CAL_GYRO_BIAS + 1] + FIXTURE_GYRO_DRIFT + rate;
+            put_le16(&report[DS_OFF_GYRO_Y], yaw + noise(FIXTURE_GYRO_NOISE));
+        }
+        
+        uint32_t ticks = (uint32_t)n * FIXTURE_INTERVAL_US * DS_SENSOR_TICKS_PER_US;
+        memcpy(&report[DS_OFF_SENSOR_TIMESTAMP], &ticks, sizeof(ticks));
+        uint32_t crc = crc32_extend(crc_seed, report, DS_BT_INPUT_SIZE - DS_BT_CRC_SIZE);
+        memcpy(&report[DS_BT_INPUT_SIZE - DS_BT_CRC_SIZE], &crc, sizeof(crc));
+        
+        uint64_t time_ns = TIME_MS(1) + (uint64_t)n * TIME_US(FIXTURE_INTERVAL_US);
+        if (write_record(f, CAPTURE_RECORD_INPUT, time_ns, report, sizeof(report)) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        printf("Usage: %s OUTPUT\n", argv[0]);
+        return 1;
+    }
+    
+    FILE* f = fopen(argv[1], "wb");
+    if (!f) {
+        perror("[Fixture] fopen");
+        return 1;
+    }
+    crc32_init();
+    
+    int ret = write_fixture(f);
+    if (fclose(f) != 0) ret = -1;
+    if (ret < 0) {
+        perror("[Fixture] write");
+        return 1;
+    }
+    
+    printf("[Fixture] Wrote %d frames to %s\n", FIXTURE_REST_FRAMES + FIXTURE_MOVE_FRAMES, argv[1]);
+    return 0;
+}
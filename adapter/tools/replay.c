@@ -0,0 +1,370 @@
+/*
+ * RosettaPad - Capture Replay
+ * ============================
+ *
+ * Pushes a raw input capture (rosettapad --capture=FILE) through the
+ * registered controller driver's process_input() and the DS3 report
+ * builder, without a controller or a PS3.
+ *
+ * Reports throughput, per-frame cost of each stage, and a digest of every
+ * DS3 report produced. The digest only depends on the capture and the
+ * translation code, so it is the same at any replay speed: compare it
+ * before and after a change to catch output regressions byte-for-byte.
+ *
+ * --motion checks the driver's fixed-point motion calibration
+ * (controllers/motion_calib.h) against an exact double precision
+ * computation on every frame, and fails if any axis is off by more than
+ * MOTION_MAX_ERROR output units. Captures carry the calibration the
+ * driver loaded (CAPTURE_RECORD_CALIBRATION records, passed to its
+ * load_calibration() hook), so this runs with the real factory calibration.
+ * It also checks the physics while the controller lies still with the
+ * online gyro bias settled: the accel vector must be 1 g long and the
+ * gyro must read zero, i.e. any drift must have been tracked out.
+ * --flat adds that the controller lies flat then (accel_z at -1 g), and
+ * fails captures without such a rest; `make motion-check` runs both on
+ * a synthetic capture with a known answer (tools/motion_fixture.c).
+ *
+ * Build and run:
+ *   make tools
+ *   ./build/tools/replay [--realtime] [--loops=N] [--motion [--flat]] capture.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "core/common.h"
+#include "core/capture.h"
+#include "core/latency.h"
+#include "controllers/controller_interface.h"
+#include "controllers/motion_calib.h"
+#include "console/ps3/ds3_emulation.h"
+
+/* Controller registry (controller_registry.c) */
+extern void controller_registry_init(void);
+extern void controller_drivers_init(void);
+
+/* 64-bit FNV-1a over every produced report */
+#define DIGEST_INIT     0xCBF29CE484222325ULL
+#define DIGEST_PRIME    0x100000001B3ULL
+
+static uint64_t digest_update(uint64_t h, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= DIGEST_PRIME;
+    }
+    return h;
+}
+
+/* Largest fixed-point error --motion accepts, in output units */
+#define MOTION_MAX_ERROR    1.0
+
+/* At rest: frames of bias tracking before the physical checks start
+ * (3 time constants, under 5% of any drift left), and their limits */
+#define MOTION_SETTLE_SAMPLES   (3 << MOTION_BIAS_SHIFT)
+#define MOTION_REST_MAX_G       0.05
+#define MOTION_REST_MAX_DEG_S   0.25
+
+typedef struct {
+    uint64_t frames;
+    double max_error[MOTION_SENSOR_COUNT][3];
+    double sum_sq[MOTION_SENSOR_COUNT][3];
+    const motion_calib_t* calib;    /* Last seen, for the bias summary */
+    
+    /* Still with the online bias settled */
+    uint64_t last_rest_samples;
+    uint32_t tracking;              /* Consecutive frames that updated the bias */
+    uint64_t settled;
+    double sum_settled[MOTION_SENSOR_COUNT][3];
+} motion_check_t;
+
+typedef struct {
+    uint64_t reports;
+    uint64_t calibrations;      /* CAPTURE_RECORD_CALIBRATION records loaded */
+    uint64_t parse_errors;
+    uint64_t unknown_device;
+    uint64_t frames;            /* DS3 reports built */
+    uint64_t digest;
+    uint64_t busy_ns;           /* Time spent in process_input + build */
+    motion_check_t motion;
+} replay_stats_t;
+
+/* ============================================================================
+ * MOTION ACCURACY
+ * ============================================================================ */
+
+static void motion_check(motion_check_t* m, const motion_calib_t* calib,
+                         const controller_state_t* state) {
+    const int16_t got[MOTION_SENSOR_COUNT][3] = {
+        { state->accel_x, state->accel_y, state->accel_z },
+        { state->gyro_x, state->gyro_y, state->gyro_z },
+    };
+    double exact[MOTION_SENSOR_COUNT][3];
+    motion_calib_reference(calib, exact);
+    
+    for (int s = 0; s < MOTION_SENSOR_COUNT; s++) {
+        for (int i = 0; i < 3; i++) {
+            double err = fabs(got[s][i] - exact[s][i]);
+            if (err > m->max_error[s][i]) m->max_error[s][i] = err;
+            m->sum_sq[s][i] += err * err;
+        }
+    }
+    m->frames++;
+    m->calib = calib;
+    
+    m->tracking = calib->rest_samples != m->last_rest_samples ? m->tracking + 1 : 0;
+    m->last_rest_samples = calib->rest_samples;
+    if (m->tracking >= MOTION_SETTLE_SAMPLES) {
+        for (int s = 0; s < MOTION_SENSOR_COUNT; s++) {
+            for (int i = 0; i < 3; i++) m->sum_settled[s][i] += got[s][i];
+        }
+        m->settled++;
+    }
+}
+
+/* @return 0 if the controller at rest looks like one on Earth */
+static int motion_rest_report(const motion_check_t* m, int flat) {
+    double g[3], rate[3];
+    int failed = 0;
+    
+    if (!m->settled) {
+        printf("    at rest    no still period of %d+%d frames, not checked\n",
+               MOTION_REST_SAMPLES, MOTION_SETTLE_SAMPLES);
+        return flat;
+    }
+    for (int i = 0; i < 3; i++) {
+        g[i] = m->sum_settled[MOTION_ACCEL][i] / m->settled / CONTROLLER_ACCEL_RES_PER_G;
+        rate[i] = m->sum_settled[MOTION_GYRO][i] / m->settled / CONTROLLER_GYRO_RES_PER_DEG_S;
+        if (fabs(rate[i]) > MOTION_REST_MAX_DEG_S) failed = 1;
+    }
+    double magnitude = sqrt(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+    if (fabs(magnitude - 1.0) > MOTION_REST_MAX_G) failed = 1;
+    if (flat && (fabs(g[0]) > MOTION_REST_MAX_G || fabs(g[1]) > MOTION_REST_MAX_G ||
+                 fabs(g[2] + 1.0) > MOTION_REST_MAX_G)) {
+        failed = 1;
+    }
+    
+    printf("    at rest    accel %.3f %.3f %.3f g (|a| %.3f), gyro %.3f %.3f %.3f deg/s"
+           " over %llu frames\n", g[0], g[1], g[2], magnitude, rate[0], rate[1], rate[2],
+           (unsigned long long)m->settled);
+    return failed;
+}
+
+/* @return 0 if every axis is within MOTION_MAX_ERROR and the rest checks pass */
+static int motion_report(const motion_check_t* m, int flat) {
+    static const char* const names[MOTION_SENSOR_COUNT] = { "accel", "gyro" };
+    int failed = 0;
+    
+    if (!m->frames) {
+        printf("  motion:      no calibrated frames (driver has no motion_calib hook?)\n");
+        return 1;
+    }
+    printf("  motion:      fixed point vs exact over %llu frames (output units)\n",
+           (unsigned long long)m->frames);
+    for (int s = 0; s < MOTION_SENSOR_COUNT; s++) {
+        printf("    %-5s      max err", names[s]);
+        for (int i = 0; i < 3; i++) {
+            printf(" %.3f", m->max_error[s][i]);
+            if (m->max_error[s][i] > MOTION_MAX_ERROR) failed = 1;
+        }
+        printf("   rms");
+        for (int i = 0; i < 3; i++) printf(" %.3f", sqrt(m->sum_sq[s][i] / m->frames));
+        printf("\n");
+    }
+    printf("    gyro bias  %.3f %.3f %.3f deg/s (raw axes), tracked on %llu samples at rest\n",
+           motion_calib_gyro_bias(m->calib, 0) / CONTROLLER_GYRO_RES_PER_DEG_S,
+           motion_calib_gyro_bias(m->calib, 1) / CONTROLLER_GYRO_RES_PER_DEG_S,
+           motion_calib_gyro_bias(m->calib, 2) / CONTROLLER_GYRO_RES_PER_DEG_S,
+           (unsigned long long)m->calib->rest_samples);
+    printf("    factory    %d axes rejected, nominal used\n", m->calib->fallback_axes);
+    if (motion_rest_report(m, flat)) failed = 1;
+    printf("  motion:      %s (limit %.1f, at rest %.2f g / %.2f deg/s)\n", failed ? "FAIL" : "pass",
+           MOTION_MAX_ERROR, MOTION_REST_MAX_G, MOTION_REST_MAX_DEG_S);
+    return failed;
+}
+
+/* ============================================================================
+ * REPLAY
+ * ============================================================================ */
+
+static int replay_pass(const uint8_t* data, size_t size, int realtime, int check_motion,
+                       replay_stats_t* st) {
+    const uint8_t* p = data + sizeof(capture_header_t);
+    const uint8_t* end = data + size;
+    const controller_driver_t* driver = NULL;
+    uint16_t vid = 0, pid = 0;
+    uint64_t first_rx = 0, origin = time_now_ns();
+    uint8_t report[DS3_INPUT_REPORT_SIZE];
+    
+    while ((size_t)(end - p) >= sizeof(capture_record_t)) {
+        capture_record_t rec;
+        memcpy(&rec, p, sizeof(rec));
+        p += sizeof(rec);
+        if (rec.len > end - p) {
+            printf("  truncated record at offset %zu\n", (size_t)(p - data));
+            break;
+        }
+        const uint8_t* buf = p;
+        p += rec.len;
+        
+        if (!driver || rec.vendor_id != vid || rec.product_id != pid) {
+            vid = rec.vendor_id;
+            pid = rec.product_id;
+            driver = controller_find_driver(vid, pid);
+        }
+        
+        /* Calibration the driver loaded live, ahead of the reports it applies to */
+        if (rec.type == CAPTURE_RECORD_CALIBRATION) {
+            if (driver && driver->load_calibration &&
+                driver->load_calibration(buf, rec.len) == 0) {
+                st->calibrations++;
+            }
+            continue;
+        }
+        if (rec.type != CAPTURE_RECORD_INPUT) {
+            continue;
+        }
+        
+        st->reports++;
+        if (!driver || !driver->process_input) {
+            st->unknown_device++;
+            continue;
+        }
+        
+        /* Real time: keep the captured spacing between reports */
+        if (realtime) {
+            if (first_rx == 0) first_rx = rec.rx_time_ns;
+            uint64_t due = origin + (rec.rx_time_ns - first_rx);
+            struct timespec ts = time_ns_to_timespec(due);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+        
+        controller_state_t state;
+        uint64_t t0 = time_now_ns();
+        if (driver->process_input(buf, rec.len, &state) != 0) {
+            st->parse_errors++;
+            continue;
+        }
+        uint64_t t1 = time_now_ns();
+        ds3_build_input_report(&state, report);
+        uint64_t t2 = time_now_ns();
+        
+        latency_record(LAT_PARSE, t1 - t0);
+        latency_record(LAT_USB_BUILD, t2 - t1);
+        st->busy_ns += t2 - t0;
+        st->frames++;
+        st->digest = digest_update(st->digest, report, sizeof(report));
+        
+        if (check_motion && driver->motion_calib) {
+            motion_check(&st->motion, driver->motion_calib(), &state);
+        }
+    }
+    
+    return 0;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [options] CAPTURE\n", prog);
+    printf("  --realtime    Replay with the captured report spacing (default: max speed)\n");
+    printf("  --loops=N     Replay the capture N times (default 1)\n");
+    printf("  --motion      Check motion calibration accuracy (exit 1 on failure)\n");
+    printf("  --flat        With --motion: the capture has the controller flat and still\n");
+    printf("  -h, --help    Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    static const struct option long_opts[] = {
+        {"realtime", no_argument,       NULL, 'r'},
+        {"loops",    required_argument, NULL, 'l'},
+        {"motion",   no_argument,       NULL, 'm'},
+        {"flat",     no_argument,       NULL, 'f'},
+        {"help",     no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    int realtime = 0, loops = 1, check_motion = 0, flat = 0, opt;
+    
+    while ((opt = getopt_long(argc, argv, "h", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'r': realtime = 1; break;
+            case 'l': loops = atoi(optarg); break;
+            case 'm': check_motion = 1; break;
+            case 'f': flat = 1; break;
+            case 'h': print_usage(argv[0]); return 0;
+            default:  print_usage(argv[0]); return 1;
+        }
+    }
+    if (optind != argc - 1 || loops < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char* path = argv[optind];
+    
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st_file;
+    if (fd < 0 || fstat(fd, &st_file) < 0) {
+        perror("[Replay] open");
+        return 1;
+    }
+    if ((size_t)st_file.st_size < sizeof(capture_header_t)) {
+        printf("[Replay] %s: not a capture\n", path);
+        return 1;
+    }
+    const uint8_t* data = mmap(NULL, st_file.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("[Replay] mmap");
+        return 1;
+    }
+    
+    capture_header_t header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CAPTURE_VERSION) {
+        printf("[Replay] %s: not a capture (or unsupported version)\n", path);
+        return 1;
+    }
+    
+    /* Same setup as rosettapad, minus the hardware */
+    controller_registry_init();
+    controller_drivers_init();
+    ds3_init();
+    
+    replay_stats_t st = { .digest = DIGEST_INIT };
+    uint64_t start = time_now_ns();
+    for (int i = 0; i < loops; i++) {
+        replay_pass(data, st_file.st_size, realtime, check_motion, &st);
+    }
+    double elapsed_s = (double)(time_now_ns() - start) / TIME_NS_PER_SEC;
+    
+    printf("\nReplay of %s (%s, %d loop%s)\n", path, realtime ? "real time" : "max speed",
+           loops, loops == 1 ? "" : "s");
+    printf("  reports:     %llu (%llu parse errors, %llu unknown device)\n",
+           (unsigned long long)st.reports, (unsigned long long)st.parse_errors,
+           (unsigned long long)st.unknown_device);
+    printf("  calibration: %llu loaded\n", (unsigned long long)st.calibrations);
+    printf("  elapsed:     %.3f s\n", elapsed_s);
+    printf("  throughput:  %.0f frames/s\n", elapsed_s > 0 ? st.frames / elapsed_s : 0.0);
+    if (st.frames) {
+        printf("  per frame:   %.1f ns total\n", (double)st.busy_ns / st.frames);
+        printf("    parse      p50=%llu ns  p99=%llu ns\n",
+               (unsigned long long)latency_percentile(LAT_PARSE, 50),
+               (unsigned long long)latency_percentile(LAT_PARSE, 99));
+        printf("    ds3 build  p50=%llu ns  p99=%llu ns\n",
+               (unsigned long long)latency_percentile(LAT_USB_BUILD, 50),
+               (unsigned long long)latency_percentile(LAT_USB_BUILD, 99));
+    }
+    printf("  digest:      %016llx (%llu DS3 reports)\n",
+           (unsigned long long)st.digest, (unsigned long long)st.frames);
+    
+    int failed = check_motion ? motion_report(&st.motion, flat) : 0;
+    
+    munmap((void*)data, st_file.st_size);
+    return failed;
+}